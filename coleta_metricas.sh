@@ -5,6 +5,8 @@ set -euo pipefail
 BIN="./bin/ordenacao-externa"
 ARQ="$1"        # ex: misturado-1234.vet ou grande.vet
 MAXB="$2"       # ex: 10, 50, 50000 etc.
+shift 2
+EXTRA=("$@")    # opções adicionais repassadas ao programa (ex.: --pipeline)
 
 LOG="exec_$(basename "$ARQ")_${MAXB}.log"
 
@@ -12,11 +14,11 @@ LOG="exec_$(basename "$ARQ")_${MAXB}.log"
 rm -f run_*.bin runInter_*.bin 2>/dev/null
 
 ### 2) Inicia o programa, redirecionando stdout+stderr para o terminal E para o ficheiro de log
-echo "Executando: $BIN $ARQ $MAXB"
+echo "Executando: $BIN $ARQ $MAXB ${EXTRA[*]+"${EXTRA[*]}"}"
 echo "----------------------------------------------------------------------"
 # A saída do 'time' (que vai para stderr) e a saída do programa (stdout e stderr)
 # são todas enviadas para o 'tee', que as mostra no terminal e grava no ficheiro LOG.
-{ LC_ALL=C /usr/bin/time --verbose "$BIN" "$ARQ" "$MAXB"; } 2>&1 | tee "$LOG"
+{ LC_ALL=C /usr/bin/time --verbose "$BIN" "$ARQ" "$MAXB" ${EXTRA[@]+"${EXTRA[@]}"}; } 2>&1 | tee "$LOG"
 
 #-------------------------- Fim da execução ----------------------------#
 echo "----------------------------------------------------------------------"
@@ -26,13 +28,17 @@ echo
 
 ### 3) Extrair métricas do log principal ($LOG) ###
 
-# 3.1. Número de runs geradas na Fase 1
-RUNS=$(
-  grep "Fase 1 concluída:" "$LOG" \
-    | head -n1 \
-    | sed -E 's/.*: *([0-9]+) .*/\1/' \
-    || echo "0"
-)
+# 3.1. Número de runs geradas na Fase 1 (“N runs simples geradas[ + último
+#      bloco ...]”, “N baldes” no --distribuicao; entrada inteira em memória
+#      ou chaves densas: nenhuma run)
+FASE1=$(grep "Fase 1 concluída:" "$LOG" | head -n1 || true)
+if [[ "$FASE1" =~ ([0-9]+)\ runs\ simples ]]; then
+  RUNS="${BASH_REMATCH[1]}"
+elif [[ "$FASE1" =~ ([0-9]+)\ baldes ]]; then
+  RUNS="${BASH_REMATCH[1]} (baldes)"
+else
+  RUNS="0"
+fi
 
 # 3.2. Tempo de cada fase
 if grep -q "METRICA_TEMPO_FASE1" "$LOG"; then
@@ -53,6 +59,13 @@ else
   TEMPO3="N/A"
 fi
 
+# 3.2.1. Sobreposição dos estágios da Fase 1 (leitura/ordenação/escrita)
+if grep -q "METRICA_SOBREPOSICAO_FASE1" "$LOG"; then
+  SOBREP1=$(grep "METRICA_SOBREPOSICAO_FASE1" "$LOG" | cut -d':' -f2 | tr -d ' ')
+else
+  SOBREP1="N/A"
+fi
+
 # 3.3. I/O do 'time --verbose'
 FS_IN_TIME=$(grep -i "File system inputs" "$LOG" | awk '{print $4}' || echo "0")
 FS_OUT_TIME=$(grep -i "File system outputs" "$LOG" | awk '{print $4}' || echo "0")
@@ -84,6 +97,7 @@ TMP_COUNT=$(find . -maxdepth 1 \( -name "run_*.bin" -o -name "runInter_*.bin" \)
 echo "=== Métricas para $(basename "$ARQ") (max_blocos=$MAXB) ==="
 echo "Número de runs (Fase 1)         : $RUNS"
 echo "Tempo Fase 1 (s)                : $TEMPO1"
+echo "Sobreposição Fase 1             : $SOBREP1"
 echo "Tempo Fase 2 (s)                : $TEMPO2"
 echo "Tempo Fase 3 (s)                : $TEMPO3"
 echo "I/O Leitura (time, bytes)       : $FS_IN_TIME"
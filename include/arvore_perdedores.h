@@ -0,0 +1,71 @@
+#ifndef ARVORE_PERDEDORES_H
+#define ARVORE_PERDEDORES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * ▪ EntradaArvore:
+ *   • chave (uint64_t): chave do registro atual da run
+ *   • id (size_t):      índice da run; ≥ k quando a run está esgotada
+ *
+ *   Entradas compactas (16 bytes): o payload do registro continua no
+ *   buffer do LeitorRun e nunca é copiado pela árvore.
+ */
+typedef struct {
+    uint64_t chave;  // ➔ chave de ordenação
+    size_t   id;     // ➔ run de origem (desempate) ou marca de esgotada
+} EntradaArvore;
+
+/**
+ * ▪ ArvorePerdedores:
+ *   Árvore de torneio (loser tree) sobre k runs. nos[0] guarda o vencedor
+ *   (menor (chave, id)); nos[1..k-1] guardam o perdedor de cada confronto.
+ *   As folhas ficam implícitas nas posições k..2k-1, então trocar a chave
+ *   do vencedor custa uma única subida folha → raiz (⌈log2 k⌉ comparações).
+ */
+typedef struct {
+    size_t         k;    // ➔ número de runs (folhas)
+    EntradaArvore *nos;  // ➔ vencedor + perdedores (k posições)
+} ArvorePerdedores;
+
+/**
+ * ➔ arvore_inicializar:
+ *     Monta o torneio inicial com a primeira chave de cada run.
+ *
+ * param a       Árvore a inicializar
+ * param chaves  chaves[i] = chave atual da run i (ignorada se !ativas[i])
+ * param ativas  ativas[i] = true se a run i ainda tem registro
+ * param k       Quantidade de runs (≥ 1)
+ * return        0 em sucesso, -1 em falha de alocação
+ */
+int arvore_inicializar(ArvorePerdedores *a, const uint64_t *chaves, const bool *ativas, size_t k);
+
+/**
+ * ➔ arvore_vencedor:
+ *     Índice da run com a menor chave (desempate pela menor run).
+ *     Retorna um valor ≥ k quando todas as runs estão esgotadas.
+ */
+static inline size_t arvore_vencedor(const ArvorePerdedores *a) {
+    return a->nos[0].id;
+}
+
+/**
+ * ➔ arvore_substituir:
+ *     Troca a chave da run vencedora pela próxima chave dela (ou a marca
+ *     como esgotada) e refaz os confrontos da folha até a raiz.
+ *
+ * param a            Árvore já inicializada
+ * param nova_chave   Próxima chave da run vencedora
+ * param ativa        false se a run vencedora acabou
+ */
+void arvore_substituir(ArvorePerdedores *a, uint64_t nova_chave, bool ativa);
+
+/**
+ * ➔ arvore_destruir:
+ *     Libera a memória da árvore.
+ */
+void arvore_destruir(ArvorePerdedores *a);
+
+#endif // ARVORE_PERDEDORES_H
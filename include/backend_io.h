@@ -0,0 +1,74 @@
+#ifndef BACKEND_IO_H
+#define BACKEND_IO_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Interface interna entre monitor.c e as implementações de I/O.
+ * Nenhum outro módulo deve usar este cabeçalho: o acesso a arquivos é
+ * sempre feito por mon_fopen/mon_fread/mon_fwrite/mon_fclose.
+ */
+
+/**
+ * ▪ OperacoesIO: tabela de funções de um backend
+ *   • abrir:    abre o arquivo para leitura ou escrita (truncando) e
+ *               retorna o estado privado do backend (NULL em falha); na
+ *               leitura, “inicio” é o offset do primeiro byte a ler (na
+ *               escrita é sempre 0)
+ *   • ler:      lê até “bytes” bytes; retorna menos apenas no EOF ou erro
+ *   • escrever: grava “bytes” bytes; retorna menos apenas em erro
+ *   • escrever_em: grava “bytes” bytes na posição absoluta “offset”, sem
+ *               mover a posição sequencial (as escritas sequenciais
+ *               pendentes são concluídas antes); pode ser chamada por
+ *               várias threads ao mesmo tempo, desde que nenhuma use
+ *               “escrever” no mesmo arquivo. NULL se não suportada
+ *   • erro_leitura: errno da leitura que falhou (0 se nenhuma); separa o
+ *               erro do EOF depois de uma leitura curta
+ *   • fechar:   conclui escritas pendentes, fecha e libera o estado;
+ *               retorna 0 em sucesso
+ *   • buffer_leitura / buffer_escrita: bytes de buffer próprios que o
+ *               backend mantém por arquivo aberto para leitura / escrita
+ *               (além dos blocos de quem chama), descontados do orçamento
+ *               de memória pelo planejador e pela Fase 1
+ */
+typedef struct {
+    const char *nome;
+    void  *(*abrir)(const char *caminho, bool escrita, uint64_t inicio);
+    size_t (*ler)(void *estado, void *destino, size_t bytes);
+    size_t (*escrever)(void *estado, const void *origem, size_t bytes);
+    size_t (*escrever_em)(void *estado, const void *origem, size_t bytes, uint64_t offset);
+    int    (*erro_leitura)(void *estado);
+    int    (*fechar)(void *estado);
+    size_t buffer_leitura;
+    size_t buffer_escrita;
+} OperacoesIO;
+
+extern const OperacoesIO OPERACOES_STDIO;  // ➔ backend_stdio.c
+extern const OperacoesIO OPERACOES_POSIX;  // ➔ backend_posix.c
+extern const OperacoesIO OPERACOES_URING;  // ➔ backend_uring.c
+extern const OperacoesIO OPERACOES_DIRETO; // ➔ backend_direto.c (temporários)
+extern const OperacoesIO OPERACOES_FLUXO;  // ➔ backend_stdio.c (stdin/stdout, “-”)
+
+/**
+ * ➔ fluxo_definir_saida:
+ *     Descritor em que OPERACOES_FLUXO grava (padrão: STDOUT_FILENO).
+ */
+void fluxo_definir_saida(int fd);
+
+/**
+ * ➔ uring_inicializar:
+ *     Cria o anel io_uring compartilhado (uma única vez).
+ *     return  0 se o io_uring está disponível, -1 caso contrário
+ */
+int uring_inicializar(void);
+
+/**
+ * ➔ direto_bytes_pool:
+ *     return  Bytes alocados pelo pool de blocos alinhados do backend
+ *             direto (o pico, já que o pool nunca encolhe)
+ */
+size_t direto_bytes_pool(void);
+
+#endif // BACKEND_IO_H
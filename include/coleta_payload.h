@@ -0,0 +1,67 @@
+#ifndef COLETA_PAYLOAD_H
+#define COLETA_PAYLOAD_H
+
+#include <stddef.h>
+#include "registro.h"
+#include "monitor.h"
+#include "tar_saida.h"
+#include "indice_esparso.h"
+
+/**
+ * ▪ ColetaPayload:
+ *   Fase 3 do modo --somente-chaves: recebe as EntradaChave em ordem (do
+ *   merge final) e busca cada RegistroDisco no .vet de entrada, mapeado
+ *   com mmap, entregando-os ao gravador do .tar (e ao “grande_sorted.bin”,
+ *   se pedido).
+ *   • mapa / tamanho_mapa: arquivo de entrada mapeado (somente leitura)
+ *   • tar: gravador do .tar de saída
+ *   • ordenado: “grande_sorted.bin” com os registros completos (ou NULL)
+ *   • indice: índice do “grande_sorted.bin” (ou NULL), preenchido por quem
+ *     chama depois de coleta_abrir
+ *   • lote: registros buscados e ainda não entregues
+ *   • erro: offset inválido ou falha de escrita
+ */
+typedef struct {
+    const unsigned char *mapa;          // ➔ .vet mapeado
+    size_t               tamanho_mapa;  // ➔ bytes mapeados
+    SaidaTar            *tar;           // ➔ destino do payload
+    ArquivoMon          *ordenado;      // ➔ registros completos (ou NULL)
+    IndiceEsparso       *indice;        // ➔ índice do ordenado (ou NULL)
+    RegistroDisco       *lote;          // ➔ registros buscados
+    bool                 erro;
+} ColetaPayload;
+
+/**
+ * ➔ coleta_abrir:
+ *     Mapeia o arquivo de entrada e, se nome_ordenado não for NULL, cria o
+ *     arquivo ordenado de registros completos.
+ *
+ * param c              Coleta a inicializar
+ * param nome_entrada   Arquivo .vet de onde os payloads serão lidos
+ * param tar            Gravador do .tar já aberto
+ * param nome_ordenado  “grande_sorted.bin” ou NULL
+ * return               0 em sucesso, -1 em falha (nada fica aberto)
+ */
+int coleta_abrir(ColetaPayload *c, const char *nome_entrada, SaidaTar *tar,
+                 const char *nome_ordenado);
+
+/**
+ * ➔ coleta_consumir:
+ *     ConsumidorMerge do merge final: busca os registros das n entradas
+ *     (vetor de EntradaChave) na ordem recebida e os entrega ao .tar.
+ *
+ * return  0 em sucesso, -1 se algum offset estiver fora da entrada ou
+ *         alguma escrita falhar
+ */
+int coleta_consumir(void *contexto, const void *entradas, size_t n);
+
+/**
+ * ➔ coleta_fechar:
+ *     Desfaz o mapeamento e fecha o arquivo ordenado (o .tar continua
+ *     aberto, para tar_fechar).
+ *
+ * return  0 em sucesso, -1 se houve erro em algum momento
+ */
+int coleta_fechar(ColetaPayload *c);
+
+#endif // COLETA_PAYLOAD_H
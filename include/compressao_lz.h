@@ -0,0 +1,53 @@
+#ifndef COMPRESSAO_LZ_H
+#define COMPRESSAO_LZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Compressor LZ77 rápido, no estilo do formato de blocos do LZ4, usado
+ * nos blocos das runs comprimidas (formato_run.c). Cada bloco é uma
+ * sequência de trechos:
+ *
+ *   token (1 byte) → 4 bits altos: literais; 4 bits baixos: cópia − 4
+ *   [extensão dos literais] [literais] [distância, 2 bytes LE] [extensão da cópia]
+ *
+ * Um campo de 4 bits igual a 15 continua em bytes de extensão (soma até o
+ * primeiro byte < 255). O último trecho só tem literais e termina o bloco.
+ * A busca usa uma tabela de hash de 4 bytes, sem cadeias: troca um pouco
+ * de taxa de compressão por velocidade.
+ */
+
+// ► Entradas da tabela de hash do compressor (potência de 2)
+#define TAM_TABELA_LZ 4096
+
+/**
+ * ➔ lz_comprimir:
+ *     Comprime “origem” em “destino”.
+ *
+ * param origem      Bytes a comprimir (menos de 64 KB)
+ * param n           Quantidade de bytes
+ * param destino     Saída
+ * param capacidade  Bytes disponíveis em destino
+ * param tabela      Tabela de TAM_TABELA_LZ posições (só de trabalho)
+ * return            Bytes gravados, ou 0 se a saída não coube em capacidade
+ *                   (quem chama guarda o bloco sem compressão)
+ */
+size_t lz_comprimir(const unsigned char *origem, size_t n, unsigned char *destino,
+                    size_t capacidade, uint16_t *tabela);
+
+/**
+ * ➔ lz_descomprimir:
+ *     Descomprime um bloco gravado por lz_comprimir, conferindo os limites
+ *     de cada trecho.
+ *
+ * param origem   Bloco comprimido
+ * param n        Bytes do bloco
+ * param destino  Saída
+ * param tam      Bytes esperados na saída
+ * return         0 em sucesso, -1 se o bloco estiver corrompido ou não
+ *                produzir exatamente tam bytes
+ */
+int lz_descomprimir(const unsigned char *origem, size_t n, unsigned char *destino, size_t tam);
+
+#endif // COMPRESSAO_LZ_H
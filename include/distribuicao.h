@@ -0,0 +1,78 @@
+#ifndef DISTRIBUICAO_H
+#define DISTRIBUICAO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "opcoes.h"
+#include "monitor.h"
+#include "tar_saida.h"
+#include "indice_esparso.h"
+
+/**
+ * ▪ Distribuicao:
+ *   Resultado da Fase 1 do modo --distribuicao (sample sort): a entrada
+ *   foi espalhada em baldes balde_00000.bin, balde_00001.bin, … por faixa
+ *   de chave, e todas as chaves do balde i são ≤ as do balde i+1.
+ *   • n_baldes: quantidade de baldes (P)
+ *   • contagens: registros gravados em cada balde
+ *   • n_registros: registros da entrada
+ *   • n_amostras: chaves sorteadas para escolher os divisores
+ *   • capacidade: registros que um balde pode ter para ser ordenado em
+ *     memória (orçamento de max_blocos dividido entre as threads)
+ *   • n_criados: baldes 0..n_criados-1 já criados em disco por este
+ *     processo; liberar_distribuicao apaga os que ainda existirem
+ */
+typedef struct {
+    size_t    n_baldes;     // ➔ P
+    uint64_t *contagens;    // ➔ registros por balde
+    uint64_t  n_registros;  // ➔ total da entrada
+    size_t    n_amostras;   // ➔ tamanho da amostra
+    size_t    capacidade;   // ➔ maior balde ordenável em memória
+    size_t    n_criados;    // ➔ arquivos de balde criados (a apagar no fim)
+} Distribuicao;
+
+/**
+ * ➔ distribuir_em_baldes:
+ *     Fase 1 do modo --distribuicao:
+ *     1) sorteia chaves da entrada (mapeada com mmap) e escolhe P − 1
+ *        divisores nos quantis da amostra, com P calculado para que cada
+ *        balde caiba em memória (limitado pelos descritores e por um
+ *        buffer de escrita de ao menos uma página por balde);
+ *     2) lê a entrada uma vez e grava cada registro no balde da sua faixa.
+ *     Chaves iguais a um divisor repetido (chave muito frequente) são
+ *     repartidas entre os baldes desse divisor pela posição na entrada,
+ *     o que mantém a ordem estável.
+ *
+ * param op    Opções (entrada, max_blocos, threads)
+ * param dist  Saída (liberar com liberar_distribuicao)
+ * return      0 em sucesso, -1 em falha (mensagem já impressa)
+ */
+int distribuir_em_baldes(const Opcoes *op, Distribuicao *dist);
+
+/**
+ * ➔ ordenar_baldes:
+ *     Fase 2 do modo --distribuicao: cada balde é lido inteiro, ordenado em
+ *     memória (--ordenacao) e acrescentado ao .tar (e ao arquivo ordenado,
+ *     se houver), na ordem dos baldes. Com op->threads > 1, os baldes são
+ *     lidos e ordenados em paralelo e cada thread grava o seu quando chega
+ *     a vez dele. Um balde maior que dist->capacidade é ordenado por runs
+ *     + merge com a mesma fatia do orçamento. Cada balde é apagado depois
+ *     de gravado.
+ *
+ * param op        Opções (ordenacao, bits_radix, threads)
+ * param dist      Resultado de distribuir_em_baldes
+ * param tar       Gravador do .tar já aberto
+ * param ordenado  “grande_sorted.bin” aberto para escrita, ou NULL
+ * param indice    Índice do ordenado, ou NULL
+ * return          0 em sucesso, -1 em falha (mensagem já impressa)
+ */
+int ordenar_baldes(const Opcoes *op, const Distribuicao *dist, SaidaTar *tar,
+                   ArquivoMon *ordenado, IndiceEsparso *indice);
+
+/**
+ * ➔ liberar_distribuicao:
+ *     Libera os vetores de uma Distribuicao.
+ */
+void liberar_distribuicao(Distribuicao *dist);
+
+#endif // DISTRIBUICAO_H
@@ -0,0 +1,57 @@
+#ifndef FILA_H
+#define FILA_H
+
+#include <stddef.h>
+#include <pthread.h>
+
+/**
+ * ▪ Fila:
+ *   Fila circular limitada de ponteiros, protegida por mutex, usada para
+ *   passar blocos de trabalho entre as threads da ordenação.
+ *   • itens (void**):    vetor circular de ponteiros
+ *   • capacidade:        número máximo de itens na fila
+ *   • inicio, qtd:       posição do primeiro item e quantidade atual
+ *   • trava / nao_vazia / nao_cheia: sincronização produtor-consumidor
+ */
+typedef struct {
+    void          **itens;       // ➔ armazenamento circular
+    size_t          capacidade;  // ➔ limite de itens simultâneos
+    size_t          inicio;      // ➔ índice do próximo item a remover
+    size_t          qtd;         // ➔ itens presentes
+    pthread_mutex_t trava;
+    pthread_cond_t  nao_vazia;
+    pthread_cond_t  nao_cheia;
+} Fila;
+
+/**
+ * ➔ fila_inicializar:
+ *     Inicializa mutex/condições e aloca o vetor circular. Mesmo em caso
+ *     de falha a fila pode (e deve) ser passada a fila_destruir.
+ *
+ * param f           Fila a inicializar
+ * param capacidade  Número máximo de itens (≥ 1)
+ * return            0 em sucesso, -1 em falha de alocação
+ */
+int fila_inicializar(Fila *f, size_t capacidade);
+
+/**
+ * ➔ fila_inserir:
+ *     Insere um item no fim da fila, bloqueando enquanto ela estiver cheia.
+ *     NULL é um item válido (usado como sinal de término pelas threads).
+ */
+void fila_inserir(Fila *f, void *item);
+
+/**
+ * ➔ fila_remover:
+ *     Remove e retorna o item do início, bloqueando enquanto a fila
+ *     estiver vazia.
+ */
+void *fila_remover(Fila *f);
+
+/**
+ * ➔ fila_destruir:
+ *     Libera o vetor circular e destrói mutex/condições.
+ */
+void fila_destruir(Fila *f);
+
+#endif // FILA_H
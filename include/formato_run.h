@@ -0,0 +1,159 @@
+#ifndef FORMATO_RUN_H
+#define FORMATO_RUN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "monitor.h"
+
+/*
+ * Formato dos arquivos de run (run_xxxxx.bin e runInter_xxxxx.bin). Sem
+ * compressão, uma run é o vetor de registros de tam_registro bytes. Com
+ * --compressao, é uma sequência de blocos independentes:
+ *
+ *   CabecalhoBloco { n_registros, bytes_corpo, bytes_gravados, codec } + corpo
+ *   …
+ *   rodapé: CabecalhoBloco zerado + total de registros (uint64_t)
+ *
+ * O corpo de um bloco (até 16 KB) guarda, para cada registro, a diferença
+ * da chave para a anterior do bloco em varint e, nos RegistroDisco, o
+ * tamanho em varint e só os “tamanho” bytes válidos do pacote (o resto do
+ * pacote e o preenchimento voltam zerados); nas EntradaChave, o offset
+ * inteiro. Com COMPRESSAO_LZ, o corpo ainda passa pelo compressor de
+ * compressao_lz.c (e é guardado como está se não encolher). O
+ * “grande_sorted.bin” e os baldes nunca são comprimidos.
+ */
+
+/**
+ * ▪ CompressaoRun: formato das runs (--compressao)
+ *   • COMPRESSAO_NENHUMA: registros inteiros, como na memória (padrão)
+ *   • COMPRESSAO_DELTA:   blocos com chaves em delta/varint e pacotes aparados
+ *   • COMPRESSAO_LZ:      como DELTA, com cada bloco comprimido por LZ
+ */
+typedef enum {
+    COMPRESSAO_NENHUMA,
+    COMPRESSAO_DELTA,
+    COMPRESSAO_LZ
+} CompressaoRun;
+
+/**
+ * ➔ formato_run_definir:
+ *     Escolhe o formato das runs gravadas e lidas daqui em diante. Deve
+ *     ser chamada antes da Fase 1, como mon_definir_direto.
+ */
+void formato_run_definir(CompressaoRun compressao);
+
+/**
+ * ➔ formato_run_compressao:
+ *     return  Formato escolhido em formato_run_definir (padrão: nenhum)
+ */
+CompressaoRun formato_run_compressao(void);
+
+/**
+ * ➔ formato_run_nome:
+ *     return  “nenhuma”, “delta” ou “lz”
+ */
+const char *formato_run_nome(CompressaoRun compressao);
+
+/**
+ * ➔ bytes_codec_por_run:
+ *     Buffers do codec que cada run aberta segura, além dos blocos de quem
+ *     lê ou grava: o bloco do arquivo e, com LZ, o corpo descomprimido (e
+ *     a tabela de hash, na escrita). 0 sem compressão. Entram no orçamento
+ *     de memória junto com os buffers do backend de I/O.
+ *
+ * param escrita  true para runs abertas para escrita
+ */
+size_t bytes_codec_por_run(bool escrita);
+
+/**
+ * ▪ EscritorRun:
+ *   Run aberta para escrita no formato escolhido. Opaca: a definição fica
+ *   em formato_run.c.
+ */
+typedef struct EscritorRun EscritorRun;
+
+/**
+ * ➔ escritor_run_abrir:
+ *     Cria o temporário “nome” (mon_fopen_temporario) para gravar
+ *     registros de tam_registro bytes.
+ *
+ * param nome          Caminho do arquivo
+ * param tam_registro  sizeof(RegistroDisco) ou sizeof(EntradaChave)
+ * param compressao    Formato (COMPRESSAO_NENHUMA para arquivos que não
+ *                     são runs, como o “grande_sorted.bin”)
+ * return              Escritor, ou NULL em falha (errno preenchido)
+ */
+EscritorRun *escritor_run_abrir(const char *nome, size_t tam_registro, CompressaoRun compressao);
+
+/**
+ * ➔ escritor_run_gravar:
+ *     Acrescenta n registros (já em ordem) à run.
+ *     return  0 em sucesso, -1 em falha de escrita
+ */
+int escritor_run_gravar(EscritorRun *e, const void *registros, size_t n);
+
+/**
+ * ➔ escritor_run_gravar_em:
+ *     Grava n registros a partir do registro de número “posicao” com
+ *     mon_pwrite (merge paralelo). Só sem compressão: os blocos
+ *     comprimidos não têm posição fixa.
+ *     return  0 em sucesso, -1 em falha (ENOTSUP com compressão)
+ */
+int escritor_run_gravar_em(EscritorRun *e, const void *registros, size_t n, uint64_t posicao);
+
+/**
+ * ➔ escritor_run_fechar:
+ *     Grava o bloco pendente e o rodapé, fecha o arquivo e libera o
+ *     escritor.
+ *     return  0 em sucesso, -1 se alguma escrita falhou
+ */
+int escritor_run_fechar(EscritorRun *e);
+
+/**
+ * ▪ DecodificadorRun:
+ *   Estado da leitura de uma run comprimida (bloco atual e posição nele),
+ *   usado por LeitorRun. Opaco.
+ */
+typedef struct DecodificadorRun DecodificadorRun;
+
+/**
+ * ➔ decodificador_run_criar:
+ *     return  Decodificador para o formato escolhido, ou NULL sem memória
+ */
+DecodificadorRun *decodificador_run_criar(void);
+
+/**
+ * ➔ decodificador_run_ler:
+ *     Decodifica até n registros de tam_registro bytes da run, lendo os
+ *     blocos de “arquivo” conforme precisar.
+ *
+ * param erro  Recebe o errno de uma leitura que falhou, ou EIO se a run
+ *             estiver corrompida ou truncada (0 se nada falhou)
+ * return      Registros decodificados (menos que n só no fim da run ou em
+ *             erro)
+ */
+size_t decodificador_run_ler(DecodificadorRun *d, ArquivoMon *arquivo, void *destino,
+                             size_t tam_registro, size_t n, int *erro);
+
+/**
+ * ➔ decodificador_run_destruir:
+ *     Libera o decodificador (NULL é aceito).
+ */
+void decodificador_run_destruir(DecodificadorRun *d);
+
+/**
+ * ➔ formato_run_log:
+ *     Com compressão, imprime em stderr METRICA_COMPRESSAO_RUNS: o volume
+ *     das runs gravadas como registros inteiros e o que foi de fato gravado.
+ */
+void formato_run_log(void);
+
+/**
+ * ➔ registros_na_run:
+ *     Registros de uma run no formato escolhido: pelo tamanho do arquivo,
+ *     sem compressão, ou pelo rodapé (0 se não existir ou não tiver rodapé).
+ */
+uint64_t registros_na_run(const char *nome, size_t tam_registro);
+
+#endif // FORMATO_RUN_H
@@ -0,0 +1,85 @@
+#ifndef GERA_RUNS_H
+#define GERA_RUNS_H
+
+#include <stddef.h>
+#include "opcoes.h"
+#include "registro.h"
+
+/**
+ * ▪ RunMemoria:
+ *   Bloco da Fase 1 que ficou ordenado em memória em vez de virar um
+ *   run_xxxxx.bin: a entrada inteira, quando cabe em max_blocos, ou o
+ *   último bloco, que o merge final lê como uma run virtual.
+ *   • registros: registros já em ordem (liberar com liberar_run_memoria)
+ *   • n: quantidade de registros (0 → nada ficou em memória)
+ */
+typedef struct {
+    RegistroDisco *registros;  // ➔ bloco ordenado
+    size_t         n;          // ➔ registros no bloco
+} RunMemoria;
+
+/**
+ * ➔ gerar_runs:
+ *     Fase 1 da ordenação externa: lê o arquivo de entrada em blocos,
+ *     ordena cada bloco em memória e grava run_00000.bin, run_00001.bin, …
+ *
+ *   • Com op->threads == 1, um único buffer de max_blocos registros é
+ *     lido, ordenado e gravado em sequência.
+ *   • Com op->threads == N > 1, o orçamento de max_blocos registros é
+ *     dividido em N buffers; a thread principal lê os blocos e N threads
+ *     trabalhadoras ordenam e gravam as runs em paralelo. O número de cada
+ *     run é atribuído na ordem de leitura, então a numeração continua
+ *     determinística.
+ *   • Com op->pipeline, a gravação ganha uma thread própria e o orçamento
+ *     é dividido em N + 2 buffers em rotação: enquanto o bloco i é
+ *     ordenado, o bloco i+1 é lido e o bloco i-1 é gravado. Os tempos de
+ *     cada estágio são registrados no monitor, que relata a sobreposição
+ *     obtida em mon_timer_stop_and_log(1).
+ *   • Com op->geracao == GERACAO_SELECAO, a entrada passa por um min-heap
+ *     de max_blocos registros (seleção por substituição) e as runs têm
+ *     tamanho variável: ~2·max_blocos em dados aleatórios, uma única run
+ *     em dados quase ordenados.
+ *   • Com op->somente_chaves, as runs guardam apenas EntradaChave
+ *     (chave, offset no .vet), 16 bytes por registro; o payload é buscado
+ *     na entrada só na Fase 3.
+ *   • Com op->entrada_mmap, a entrada é mapeada (mon_mmap) e os blocos
+ *     apontam para o mapeamento em vez de um buffer próprio; as páginas
+ *     de cada bloco são devolvidas depois de gravada a run.
+ *   • Com op->filtrar_chaves (--intervalo), os registros com chave fora
+ *     da faixa são descartados na leitura, antes de qualquer ordenação, e
+ *     os blocos se enchem só com os da faixa.
+ *   • Com op->limite_registros = K (--limite), cada run guarda só os K
+ *     primeiros registros; se um heap de K registros couber no orçamento
+ *     (e “ultima” != NULL), os K primeiros da ordem são escolhidos numa
+ *     única passagem e ficam em “ultima”, sem nenhuma run gravada.
+ *   • Com “ultima” != NULL, a entrada que cabe inteira em max_blocos é
+ *     só lida e ordenada em memória (nenhuma run gravada) e, nos modos
+ *     por blocos, o último bloco fica em memória se tiver até metade de
+ *     max_blocos — a outra metade fica para o merge. O bloco em memória
+ *     não entra em contagem_runs.
+ *
+ * param op             Opções de linha de comando (entrada, memória, método)
+ * param contagem_runs  Recebe a quantidade de runs gravadas
+ * param ultima         Recebe o bloco mantido em memória (n == 0 se
+ *                      nenhum), ou NULL para gravar todos os blocos
+ * return               •  0 em sucesso
+ *                       • -1 em falha (mensagem já impressa em stderr)
+ */
+int gerar_runs(const Opcoes *op, size_t *contagem_runs, RunMemoria *ultima);
+
+/**
+ * ➔ gravar_run_memoria:
+ *     Grava um bloco mantido em memória como run_<id>.bin (quando o plano
+ *     de merge não consegue levá-lo direto ao merge final).
+ *
+ * return  0 em sucesso, -1 em falha (mensagem já impressa)
+ */
+int gravar_run_memoria(const RunMemoria *run, size_t id);
+
+/**
+ * ➔ liberar_run_memoria:
+ *     Libera os registros de uma RunMemoria (n volta a 0).
+ */
+void liberar_run_memoria(RunMemoria *run);
+
+#endif // GERA_RUNS_H
@@ -0,0 +1,159 @@
+#ifndef INDICE_ESPARSO_H
+#define INDICE_ESPARSO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "registro.h"
+
+/*
+ * Índice esparso do “grande_sorted.bin”: a cada PASSO_INDICE registros, a
+ * chave e o offset (em bytes) do registro, num arquivo ao lado do
+ * ordenado (“grande_sorted.idx”):
+ *
+ *   CabecalhoIndice { magico, n_registros, tam_registro, passo, n_entradas }
+ *   EntradaIndice[n_entradas]   → chave e offset do registro i × passo
+ *
+ * As entradas são colhidas dos blocos que as fases gravam no arquivo
+ * ordenado, sem reler nada. Uma consulta mapeia os dois arquivos, acha no
+ * índice a janela de PASSO_INDICE registros onde a chave pode estar e faz a
+ * busca binária só nela: O(log n) páginas tocadas, em vez de ler o
+ * arquivo ordenado inteiro.
+ */
+
+// ► Registros entre duas entradas do índice (≈ 264 KB do ordenado por entrada)
+#define PASSO_INDICE 1024
+// ► Identifica (e versiona) o arquivo de índice
+#define MAGICO_INDICE "ORDIDX01"
+
+/**
+ * ▪ CabecalhoIndice: início do arquivo de índice
+ */
+typedef struct {
+    char     magico[8];     // ➔ MAGICO_INDICE, sem o '\0'
+    uint64_t n_registros;   // ➔ registros do arquivo ordenado
+    uint64_t tam_registro;  // ➔ sizeof(RegistroDisco)
+    uint64_t passo;         // ➔ registros entre duas entradas
+    uint64_t n_entradas;    // ➔ ⌈n_registros / passo⌉
+} CabecalhoIndice;
+
+/**
+ * ▪ EntradaIndice: chave e posição de um registro indexado
+ */
+typedef struct {
+    uint64_t chave;   // ➔ chave do registro i × passo
+    uint64_t offset;  // ➔ offset dele no arquivo ordenado, em bytes
+} EntradaIndice;
+
+/**
+ * ▪ IndiceEsparso:
+ *   Entradas em montagem, uma para cada posição múltipla de “passo”.
+ *   Alocadas de uma vez para todos os registros previstos, para que as
+ *   faixas do merge paralelo as preencham sem trava (cada faixa grava só
+ *   as posições dela).
+ */
+typedef struct {
+    EntradaIndice *entradas;
+    uint64_t       n_entradas;
+    uint64_t       n_registros;  // ➔ registros previstos no arquivo ordenado
+    size_t         tam_registro;
+    size_t         passo;
+    uint64_t       proximo;      // ➔ posição do próximo indice_acrescentar
+} IndiceEsparso;
+
+/**
+ * ➔ indice_nome:
+ *     Nome do índice de um arquivo ordenado: o nome dele com “.bin”
+ *     trocado por “.idx” (ou com “.idx” acrescentado).
+ */
+void indice_nome(const char *nome_ordenado, char *buf, size_t tam);
+
+/**
+ * ➔ indice_criar:
+ *     Prepara o índice de um arquivo ordenado de n_registros registros.
+ *     As entradas (16 bytes a cada PASSO_INDICE registros) ficam fora do
+ *     orçamento max_blocos: são ~0,006% do volume ordenado.
+ *
+ * return  0 em sucesso, -1 sem memória
+ */
+int indice_criar(IndiceEsparso *ix, uint64_t n_registros, size_t tam_registro);
+
+/**
+ * ➔ indice_registrar:
+ *     Anota as entradas de n registros gravados a partir do registro de
+ *     número “posicao” do arquivo ordenado. Seguro entre threads que
+ *     registram faixas disjuntas.
+ */
+void indice_registrar(IndiceEsparso *ix, const void *registros, size_t n, uint64_t posicao);
+
+/**
+ * ➔ indice_acrescentar:
+ *     Como indice_registrar, para quem grava o arquivo ordenado em
+ *     sequência: os registros seguem os do acréscimo anterior.
+ */
+void indice_acrescentar(IndiceEsparso *ix, const void *registros, size_t n);
+
+/**
+ * ➔ indice_gravar:
+ *     Grava o índice de “nome_ordenado” (em indice_nome) e confere que
+ *     todas as entradas foram registradas.
+ *
+ * return  0 em sucesso, -1 em falha (errno preenchido; EINVAL se faltou
+ *         registrar alguma parte do arquivo)
+ */
+int indice_gravar(const IndiceEsparso *ix, const char *nome_ordenado);
+
+/**
+ * ➔ indice_liberar:
+ *     Libera as entradas.
+ */
+void indice_liberar(IndiceEsparso *ix);
+
+/**
+ * ▪ ConsultaIndice:
+ *   Arquivo ordenado e índice mapeados (mon_mmap, acesso aleatório) para
+ *   consultas por chave.
+ */
+typedef struct {
+    const RegistroDisco   *registros;    // ➔ arquivo ordenado mapeado (NULL se vazio)
+    size_t                 bytes_dados;
+    uint64_t               n_registros;
+    const CabecalhoIndice *cabecalho;    // ➔ índice mapeado
+    const EntradaIndice   *entradas;
+    size_t                 bytes_indice;
+} ConsultaIndice;
+
+/**
+ * ➔ consulta_abrir:
+ *     Mapeia o arquivo ordenado e o índice dele, conferindo que o índice
+ *     é deste arquivo (cabeçalho, tamanho e número de entradas).
+ *
+ * return  0 em sucesso, -1 em falha (errno preenchido; EINVAL se o índice
+ *         for inválido ou de outro arquivo)
+ */
+int consulta_abrir(ConsultaIndice *c, const char *nome_ordenado);
+
+/**
+ * ➔ consulta_limite_inferior:
+ *     return  Posição do primeiro registro com chave ≥ “chave” (n_registros
+ *             se não houver)
+ */
+uint64_t consulta_limite_inferior(const ConsultaIndice *c, uint64_t chave);
+
+/**
+ * ➔ consulta_intervalo:
+ *     Registros com chave em [chave_inicial, chave_final], que são
+ *     consecutivos no arquivo ordenado.
+ *
+ * param inicio  Recebe a posição do primeiro
+ * return        Quantos são (0 se nenhum)
+ */
+uint64_t consulta_intervalo(const ConsultaIndice *c, uint64_t chave_inicial,
+                            uint64_t chave_final, uint64_t *inicio);
+
+/**
+ * ➔ consulta_fechar:
+ *     Desfaz os mapeamentos.
+ */
+void consulta_fechar(ConsultaIndice *c);
+
+#endif // INDICE_ESPARSO_H
@@ -1,37 +1,167 @@
 #ifndef LEITOR_RUN_H
 #define LEITOR_RUN_H
 
+#include <string.h>
 #include "registro.h"
+#include "monitor.h"
+#include "formato_run.h"
+
+/**
+ * ▪ LeituraAntecipada:
+ *   Thread de leitura antecipada (read-ahead) compartilhada pelos leitores
+ *   de um merge. Recebe pedidos de recarga dos blocos reserva e os atende
+ *   em ordem de chegada com leituras grandes e sequenciais. Opaca: a
+ *   definição fica em leitor_run.c.
+ */
+typedef struct LeituraAntecipada LeituraAntecipada;
 
 /**
  * ▪ LeitorRun:
- *   • arquivo (FILE*): ponteiro para o arquivo binário da run
- *   • registro (RegistroDisco): conteúdo do registro lido atualmente
+ *   • arquivo (ArquivoMon*): handle do arquivo binário da run
+ *   • registro (const unsigned char*): registro atual, dentro do bloco
+ *     ativo; começa sempre pela chave (uint64_t), ver leitor_chave
+ *   • tam_registro (size_t): bytes por registro da run (sizeof(RegistroDisco)
+ *     ou sizeof(EntradaChave) no modo --somente-chaves)
  *   • tem_reg (bool): indica se ainda há registro disponível (true/false)
+ *   • blocos[2], qtd[2], capacidade: bloco ativo e bloco reserva, com
+ *     quantos registros cada um contém e quantos cabem
+ *   • pos, ativo: posição do registro atual e índice do bloco ativo
+ *   • reserva (int): estado do bloco reserva (vazio, pedido ou pronto)
+ *   • fim_arquivo (bool): a última leitura já chegou ao EOF (ou ao fim
+ *     da faixa)
+ *   • restantes (uint64_t): registros da faixa ainda não lidos do arquivo
+ *   • erro (int): errno da leitura que falhou (0 se nenhuma); o leitor
+ *     fecha como no fim da run e quem mescla confere depois
+ *   • emprestado (bool): blocos[0] aponta para uma run em memória, que
+ *     não é liberada por fechar_leitor
+ *   • codec: decodificador das runs comprimidas (--compressao), que
+ *     preenche os blocos com registros inteiros; NULL sem compressão
+ *   • antecipada: thread de read-ahead (NULL → recarga síncrona, um bloco)
  */
 typedef struct {
-    FILE           *arquivo;   // ➔ handle do arquivo de run
-    RegistroDisco   registro;  // ➔ registro que está sendo processado
-    bool            tem_reg;   // ➔ true se ainda há algo para ler
+    ArquivoMon          *arquivo;      // ➔ handle do arquivo de run
+    const unsigned char *registro;     // ➔ registro que está sendo processado
+    size_t               tam_registro; // ➔ bytes por registro
+    bool                 tem_reg;      // ➔ true se ainda há algo para ler
+    unsigned char       *blocos[2];    // ➔ bloco ativo e bloco reserva
+    size_t               qtd[2];       // ➔ registros válidos em cada bloco
+    size_t               capacidade;   // ➔ registros por bloco
+    size_t               pos;          // ➔ índice do registro atual no bloco ativo
+    int                  ativo;        // ➔ 0 ou 1
+    int                  reserva;      // ➔ RESERVA_VAZIA / _PEDIDA / _PRONTA
+    bool                 fim_arquivo;  // ➔ EOF já atingido pelas leituras
+    uint64_t             restantes;    // ➔ registros da faixa ainda por ler
+    int                  erro;         // ➔ errno de leitura (0 = ok)
+    bool                 emprestado;   // ➔ run em memória (sem arquivo)
+    DecodificadorRun    *codec;        // ➔ runs comprimidas (ou NULL)
+    LeituraAntecipada   *antecipada;   // ➔ read-ahead (ou NULL)
 } LeitorRun;
 
+/**
+ * ➔ leitor_chave:
+ *     Chave do registro atual (os dois formatos de run guardam a chave
+ *     nos primeiros 8 bytes). Só vale com tem_reg == true.
+ */
+static inline uint64_t leitor_chave(const LeitorRun *lr) {
+    uint64_t chave;
+    memcpy(&chave, lr->registro, sizeof(chave));
+    return chave;
+}
+
+/**
+ * ➔ leitor_disponiveis:
+ *     Registros do bloco ativo a partir do atual (inclusive), que estão
+ *     em sequência na memória. Só vale com tem_reg == true.
+ */
+static inline size_t leitor_disponiveis(const LeitorRun *lr) {
+    return lr->qtd[lr->ativo] - lr->pos;
+}
+
+/**
+ * ➔ leitura_antecipada_criar:
+ *     Inicia a thread de leitura antecipada de um merge.
+ *
+ * param max_leitores  Quantidade de leitores que vão usá-la (cada leitor
+ *                     tem no máximo um pedido pendente)
+ * return              Ponteiro para o estado da thread, ou NULL em falha
+ */
+LeituraAntecipada *leitura_antecipada_criar(size_t max_leitores);
+
+/**
+ * ➔ leitura_antecipada_destruir:
+ *     Encerra a thread e libera o estado. Todos os leitores que a usam
+ *     devem ter sido fechados antes (fechar_leitor).
+ */
+void leitura_antecipada_destruir(LeituraAntecipada *la);
+
 /**
  * ➔ inicializa_leitor:
- *     Abre o arquivo “run” (run_xxxxx.bin) para leitura e já lê
- *     o primeiro registro (se existir), sinalizando tem_reg = true.
+ *     Abre o arquivo “run” (run_xxxxx.bin) para leitura, aloca o bloco de
+ *     registros_por_bloco registros (dois, se houver read-ahead) e já lê o
+ *     primeiro bloco, sinalizando tem_reg = true se houver registro. Com
+ *     read-ahead, a recarga do bloco reserva é pedida imediatamente.
+ *
+ * param lr                   Ponteiro para a struct LeitorRun a ser inicializada
+ * param nome_run             Caminho/nome do arquivo de run (ex.: “run_00012.bin”)
+ * param tam_registro         Bytes por registro da run
+ * param registros_por_bloco  Tamanho de cada bloco, em registros (≥ 1)
+ * param la                   Thread de read-ahead, ou NULL
+ * return                     0 em sucesso, -1 se não abrir, faltar memória
+ *                            ou a primeira leitura falhar (errno)
+ */
+int inicializa_leitor(LeitorRun *lr, const char *nome_run, size_t tam_registro,
+                      size_t registros_por_bloco, LeituraAntecipada *la);
+
+/**
+ * ➔ inicializa_leitor_faixa:
+ *     Como inicializa_leitor, mas lê apenas os registros [primeiro,
+ *     primeiro + quantidade) da run, como se ela terminasse ali. Usada
+ *     pelo merge paralelo, em que cada thread mescla uma faixa de chaves.
+ *     Runs comprimidas só podem ser lidas do início (primeiro == 0).
  *
- * param lr        Ponteiro para a struct LeitorRun a ser inicializada
- * param nome_run  Caminho/nome do arquivo de run (ex.: “run_00012.bin”)
+ * param primeiro    Índice do primeiro registro a ler
+ * param quantidade  Registros a ler (UINT64_MAX → até o fim da run)
  */
-void inicializa_leitor(LeitorRun *lr, const char *nome_run);
+int inicializa_leitor_faixa(LeitorRun *lr, const char *nome_run, size_t tam_registro,
+                            size_t registros_por_bloco, LeituraAntecipada *la,
+                            uint64_t primeiro, uint64_t quantidade);
+
+/**
+ * ➔ inicializa_leitor_memoria:
+ *     Leitor sobre n registros já ordenados em memória (a run virtual do
+ *     último bloco da Fase 1): um único bloco, sem arquivo nem cópia.
+ *
+ * param registros     Primeiro registro da faixa a ler
+ * param n             Registros na faixa
+ * param tam_registro  Bytes por registro
+ */
+void inicializa_leitor_memoria(LeitorRun *lr, const void *registros, size_t n,
+                               size_t tam_registro);
 
 /**
  * ➔ avancar_leitor:
- *     Avança para o próximo registro dentro da run. Se chegar ao EOF,
- *     fecha o FILE e seta tem_reg = false.
+ *     Avança para o próximo registro dentro da run. Ao esgotar o bloco
+ *     ativo, troca pelo reserva (esperando o read-ahead, se preciso) ou o
+ *     recarrega; no EOF fecha o arquivo, libera os blocos e seta
+ *     tem_reg = false.
  *
  * param lr  Ponteiro para LeitorRun já inicializado
  */
 void avancar_leitor(LeitorRun *lr);
 
+/**
+ * ➔ avancar_leitor_varios:
+ *     Pula n registros (1 ≤ n ≤ leitor_disponiveis), como n chamadas de
+ *     avancar_leitor: só o último pode trocar de bloco.
+ */
+void avancar_leitor_varios(LeitorRun *lr, size_t n);
+
+/**
+ * ➔ fechar_leitor:
+ *     Espera um eventual pedido de read-ahead pendente, fecha o arquivo e
+ *     libera os blocos. Pode ser chamado a qualquer momento (inclusive
+ *     depois do EOF).
+ */
+void fechar_leitor(LeitorRun *lr);
+
 #endif // LEITOR_RUN_H
@@ -0,0 +1,75 @@
+#ifndef MEMORIA_AUTO_H
+#define MEMORIA_AUTO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * ▪ MedidaMemoria:
+ *   Memória que o processo ainda pode ocupar, segundo o cgroup em que
+ *   ele roda e o /proc/meminfo do sistema (usada por max_blocos “auto”).
+ *   • limite_cgroup / uso_cgroup: memory.max e memory.current do cgroup
+ *     mais restritivo da hierarquia (v2; no v1, memory.limit_in_bytes e
+ *     memory.usage_in_bytes); UINT64_MAX no limite se não houver limite
+ *   • disponivel_sistema: MemAvailable do /proc/meminfo
+ *   • disponivel: o menor entre a folga do cgroup e a do sistema
+ */
+typedef struct {
+    uint64_t limite_cgroup;       // ➔ bytes (UINT64_MAX = sem limite)
+    uint64_t uso_cgroup;          // ➔ bytes já em uso no cgroup
+    uint64_t disponivel_sistema;  // ➔ bytes disponíveis no sistema
+    uint64_t disponivel;          // ➔ bytes que o processo ainda pode usar
+} MedidaMemoria;
+
+/**
+ * ➔ medir_memoria:
+ *     Lê o cgroup do processo (/proc/self/cgroup) e percorre a hierarquia
+ *     até a raiz, guardando a menor folga (limite − uso); combina com o
+ *     MemAvailable do /proc/meminfo (ou, sem ele, com as páginas livres
+ *     de sysconf).
+ *
+ * param m  Saída
+ * return   •  0 em sucesso
+ *          • -1 se nenhuma das fontes pôde ser lida
+ */
+int medir_memoria(MedidaMemoria *m);
+
+/**
+ * ➔ max_blocos_para:
+ *     Converte a memória disponível em registros do orçamento max_blocos,
+ *     deixando uma folga (um quarto do disponível, no mínimo 64 MB) para
+ *     o resto do processo, o cache de páginas e a variação do cgroup.
+ *     Cada registro do orçamento custa o RegistroDisco e os dois vetores
+ *     de pares (chave, índice) da ordenação da Fase 1.
+ *
+ * param disponivel  Bytes disponíveis (MedidaMemoria.disponivel)
+ * return            Registros (ao menos 1024)
+ */
+size_t max_blocos_para(uint64_t disponivel);
+
+/**
+ * ➔ calcular_max_blocos_auto:
+ *     Mede a memória e escolhe max_blocos, imprimindo a origem do valor.
+ *     Se nada puder ser medido, avisa e usa 50000 registros.
+ *
+ * return  Registros do orçamento max_blocos
+ */
+size_t calcular_max_blocos_auto(void);
+
+/**
+ * ➔ reavaliar_max_blocos:
+ *     Mede de novo a memória entre as fases e, se o limite tiver baixado
+ *     (ex.: o limite do contêiner foi reduzido durante a execução), reduz
+ *     o orçamento. Nunca o aumenta: as estruturas já dimensionadas por
+ *     ele continuam valendo.
+ *
+ * param atual       Orçamento em vigor, em registros
+ * param em_uso      RegistroDisco que o processo ainda ocupa (o último
+ *                   bloco da Fase 1, já contado no uso do cgroup)
+ * param fase        Fase que vai usar o orçamento (para a mensagem)
+ * return            Novo orçamento (≤ atual)
+ */
+size_t reavaliar_max_blocos(size_t atual, size_t em_uso, int fase);
+
+#endif // MEMORIA_AUTO_H
@@ -2,6 +2,8 @@
 #define MERGE_RUNS_H
 
 #include "registro.h"
+#include "planejador.h"
+#include "indice_esparso.h"
 
 /**
  * ➔ comparar_registros:
@@ -16,28 +18,149 @@
  */
 int comparar_registros(const void *a, const void *b);
 
+/**
+ * ▪ ConsumidorMerge:
+ *   Callback que recebe a saída do merge em blocos de n registros já
+ *   ordenados, no formato das runs (RegistroDisco ou EntradaChave; ex.:
+ *   tar_gravar_registros). Retorna 0 ou -1 para abortar.
+ */
+typedef int (*ConsumidorMerge)(void *contexto, const void *registros, size_t n);
+
+/**
+ * ▪ ParametrosMerge:
+ *   • memoria_registros (size_t): orçamento de memória do merge, em
+ *     registros de tam_registro bytes; é repartido igualmente entre os
+ *     blocos dos leitores e o bloco de saída
+ *   • tam_registro (size_t): bytes por registro das runs —
+ *     sizeof(RegistroDisco) ou sizeof(EntradaChave) (--somente-chaves)
+ *   • leitura_antecipada (bool): cada leitor ganha um segundo bloco, que é
+ *     recarregado por uma thread de read-ahead enquanto o primeiro é
+ *     consumido
+ *   • consumidor, contexto: se consumidor != NULL, cada bloco de saída
+ *     também é entregue a ele (usado no merge final para gravar o .tar
+ *     sem passar pelo “grande_sorted.bin”)
+ *   • threads (size_t): com mais de 1, um merge sem consumidor é repartido
+ *     em faixas de chave mescladas em paralelo (0 ou 1 → serial)
+ *   • run_memoria, n_run_memoria: run virtual já ordenada em memória (o
+ *     último bloco da Fase 1), mesclada depois das runs em arquivo, como
+ *     se fosse a de maior número; NULL se não houver
+ *   • saida_run (bool): a saída é uma run (runInter_) e é gravada no
+ *     formato de --compressao; senão (“grande_sorted.bin”), sem compressão
+ *   • indice (IndiceEsparso*): índice do “grande_sorted.bin”, que recebe
+ *     cada bloco gravado no arquivo de saída (só no merge final; NULL nos
+ *     outros)
+ *   • limite (uint64_t): o merge para assim que entrega esse número de
+ *     registros (--limite: nenhuma run precisa ser lida até o fim); 0 →
+ *     todos
+ */
+typedef struct {
+    size_t           memoria_registros;   // ➔ orçamento total em registros
+    size_t           tam_registro;        // ➔ bytes por registro das runs
+    bool             leitura_antecipada;  // ➔ double-buffering com read-ahead
+    ConsumidorMerge  consumidor;          // ➔ destino extra da saída (ou NULL)
+    void            *contexto;            // ➔ repassado ao consumidor
+    size_t           threads;             // ➔ merge paralelo por faixas
+    const void      *run_memoria;         // ➔ run virtual (ou NULL)
+    size_t           n_run_memoria;       // ➔ registros da run virtual
+    bool             saida_run;           // ➔ saída no formato das runs
+    IndiceEsparso   *indice;              // ➔ índice do arquivo de saída (ou NULL)
+    uint64_t         limite;              // ➔ registros a entregar (0 = todos)
+} ParametrosMerge;
+
+/**
+ * ➔ threads_merge_paralelo:
+ *     Quantas faixas mesclar_runs_bloco usaria num merge sem consumidor de
+ *     n_runs runs (contando a virtual) e total_registros registros: até
+ *     params->threads, limitado pelo fan-in (cada thread abre todas as
+ *     runs e recebe 1/T do orçamento), por um mínimo de registros por
+ *     faixa e pela falta de mon_pwrite nos temporários com O_DIRECT; com
+ *     runs comprimidas, que só se leem do início, é sempre 1. Quem
+ *     precisa decidir antes do merge (o plano da Fase 2, o caminho do
+ *     merge final) usa esta mesma conta.
+ *
+ * param n_runs           Runs do merge, incluindo a virtual
+ * param total_registros  Registros somados das runs
+ * param params           Orçamento e threads pedidas
+ * return                 Threads (1 → o merge é serial)
+ */
+size_t threads_merge_paralelo(size_t n_runs, uint64_t total_registros,
+                              const ParametrosMerge *params);
+
 /**
  * ➔ mesclar_runs_bloco:
- *     Faz o “k-way merge” de até MAX_RUNS_ABERTAS arquivos de run
+ *     Faz o “k-way merge” de até fan-in arquivos de run
  *     em um único arquivo de saída ordenado.  
  *
  *   Passos principais:
- *   1) Aloca n_runs leitores (LeitorRun) e abre cada run para leitura.  
- *   2) Cria um min-heap (array de NoHeap) e insere o primeiro registro
- *      de cada run, junto do índice da run.  
- *   3) Enquanto o heap não estiver vazio:
- *        a) remove_raiz_heap → nó com menor chave  
- *        b) grava registro no arquivo de saída  
- *        c) avança o leitor correspondente (id_run) e, se ele ainda
- *           tiver registro, insere novo nó no heap  
+ *   1) Aloca n_runs leitores (LeitorRun), cada um com um bloco de
+ *      memoria_registros / (n_runs + 1) registros (metade disso por bloco
+ *      com read-ahead), e abre cada run para leitura.
+ *   2) Monta uma árvore de perdedores (ArvorePerdedores) com a chave do
+ *      primeiro registro de cada run; os nós guardam só (chave, run). Com
+ *      até FANIN_VETORIAL runs, usa o torneio vetorial (merge_vetorial.h),
+ *      que copia de uma vez os registros seguidos da run vencedora que
+ *      saem antes da segunda colocada.
+ *   3) Enquanto houver run vencedora não esgotada:
+ *        a) copia o registro atual do leitor vencedor para o bloco de
+ *           saída, gravado com um único escritor_run_gravar quando enche
+ *        b) avança esse leitor e substitui a chave dele na árvore, com
+ *           uma única subida folha → raiz (empates: a menor run vence)
+ *      e para mais cedo, com params->limite, depois do registro de número
+ *      limite.
  *   4) Fecha o arquivo de saída e libera memória.  
  *
+ *   Com params->consumidor, cada bloco de saída é também entregue ao
+ *   consumidor; nome_saida pode então ser NULL (nenhum arquivo gravado).
+ *
+ *   Sem consumidor e com params->threads > 1, o merge é repartido em até
+ *   params->threads faixas de chave com o mesmo número de registros: os
+ *   limites de cada run são achados por busca binária (uma chave lida
+ *   com pread por consulta, sem mapear as runs) e são exatos, inclusive
+ *   entre chaves repetidas, e cada thread mescla a sua faixa de todas as
+ *   runs com 1/T da memória e grava-a na sua região do arquivo de saída
+ *   (mon_pwrite). A saída é idêntica à do merge serial. Com
+ *   params->limite, a última faixa termina no registro de número limite,
+ *   achado pela mesma busca. Recorre ao serial quando
+ *   threads_merge_paralelo dá 1.
+ *
  * param runs_entrada  Vetor de strings (nomes dos arquivos run_xxxxx.bin)
- * param n_runs        Quantidade de runs a mesclar (≤ MAX_RUNS_ABERTAS)
+ * param n_runs        Quantidade de runs a mesclar (≤ fan-in do plano)
  * param nome_saida    Nome do arquivo de saída (ex.: “runInter_00001.bin”)
+ *                     ou NULL, se houver consumidor
+ * param params        Orçamento de memória e modo de leitura
  * return              •  0 em sucesso  
  *                      • -1 em caso de falha (malloc, fopen, fwrite etc.)
  */
-int mesclar_runs_bloco(char **runs_entrada, size_t n_runs, const char *nome_saida);
+int mesclar_runs_bloco(char **runs_entrada, size_t n_runs, const char *nome_saida,
+                       const ParametrosMerge *params);
+
+/**
+ * ➔ executar_merges_intermediarios:
+ *     Executa, na ordem do plano, os merges intermediários (runInter_…),
+ *     apagando as runs de entrada de cada merge assim que ele termina.
+ *
+ * param plano   Plano montado por planejar_merge
+ * param params  Orçamento de memória e modo de leitura (o consumidor e a
+ *               run virtual, se houver, são ignorados: são só do merge final)
+ * return        0 em sucesso, -1 em falha (mensagem já impressa)
+ */
+int executar_merges_intermediarios(const PlanoMerge *plano, const ParametrosMerge *params);
+
+/**
+ * ➔ executar_merge_final:
+ *     Mescla as runs que restam depois dos merges intermediários
+ *     (plano->final) em nome_saida e/ou no consumidor de params e, em
+ *     sucesso, apaga-as.
+ *
+ *     Com params->run_memoria, o último id de plano->final é a run virtual
+ *     (não tem arquivo).
+ *
+ * param plano       Plano montado por planejar_merge
+ * param nome_saida  Arquivo ordenado a gravar, ou NULL se houver consumidor
+ * param params      Orçamento, modo de leitura e consumidor
+ * return            0 em sucesso, -1 em falha
+ */
+int executar_merge_final(const PlanoMerge *plano, const char *nome_saida,
+                         const ParametrosMerge *params);
 
 #endif // MERGE_RUNS_H
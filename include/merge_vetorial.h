@@ -0,0 +1,114 @@
+#ifndef MERGE_VETORIAL_H
+#define MERGE_VETORIAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Núcleos vetoriais do merge com fan-in pequeno (o merge final costuma
+ * ter de 2 a 16 runs). Em vez da árvore de perdedores, as chaves atuais
+ * das runs ficam num vetor contíguo de FANIN_VETORIAL posições e uma
+ * redução SIMD dá o vencedor e o segundo colocado; todos os registros
+ * seguidos da run vencedora que ainda saem antes do segundo colocado
+ * formam um lote, contado por um segundo núcleo sobre as chaves do bloco
+ * do leitor e copiado com um único memcpy. O resultado é o mesmo da
+ * árvore: menor (chave, run).
+ *
+ * O conjunto de instruções é escolhido em tempo de execução (AVX2,
+ * SSE4.2 ou a versão escalar, que roda em qualquer CPU).
+ */
+
+// ► Maior fan-in em que o merge usa o torneio vetorial no lugar da árvore
+#define FANIN_VETORIAL 16
+
+/**
+ * ▪ NivelSimd: núcleos usados pelo torneio vetorial (--simd)
+ *   • SIMD_AUTO:    o melhor que a CPU suporta (padrão)
+ *   • SIMD_AVX2:    4 chaves por instrução
+ *   • SIMD_SSE42:   2 chaves por instrução (pcmpgtq)
+ *   • SIMD_ESCALAR: laços comuns, sem intrínsecos
+ */
+typedef enum {
+    SIMD_AUTO,
+    SIMD_AVX2,
+    SIMD_SSE42,
+    SIMD_ESCALAR
+} NivelSimd;
+
+/**
+ * ➔ merge_vetorial_definir:
+ *     Escolhe os núcleos do torneio vetorial. Deve ser chamada antes da
+ *     Fase 2, como formato_run_definir.
+ *
+ * return  0 em sucesso, -1 se a CPU não suporta o nível pedido (nesse
+ *         caso fica o melhor disponível)
+ */
+int merge_vetorial_definir(NivelSimd nivel);
+
+/**
+ * ➔ merge_vetorial_nome:
+ *     return  “avx2”, “sse4.2” ou “escalar”: os núcleos em uso
+ */
+const char *merge_vetorial_nome(void);
+
+/**
+ * ▪ TorneioVetorial:
+ *   Chave atual de cada uma das k ≤ FANIN_VETORIAL runs, guardada com o bit
+ *   de sinal invertido: a ordem sem sinal das chaves vira a ordem com sinal
+ *   que o SSE4.2 e o AVX2 comparam, sem conversão a cada torneio. As
+ *   posições de runs esgotadas e as de preenchimento (k..FANIN_VETORIAL-1)
+ *   guardam a maior chave (UINT64_MAX) e ficam fora de “ativas”, que
+ *   desempata uma run ativa com essa chave.
+ */
+typedef struct {
+    _Alignas(32) int64_t chaves[FANIN_VETORIAL]; // ➔ chave atual de cada run (sinal invertido)
+    uint32_t ativas;                  // ➔ bit i = run i ainda tem registro
+    size_t   k;                       // ➔ número de runs
+} TorneioVetorial;
+
+/**
+ * ➔ torneio_inicializar:
+ *     Monta o torneio com a primeira chave de cada run (mesmos parâmetros
+ *     de arvore_inicializar, com k ≤ FANIN_VETORIAL).
+ */
+void torneio_inicializar(TorneioVetorial *t, const uint64_t *chaves, const bool *ativas,
+                         size_t k);
+
+/**
+ * ➔ torneio_vencedor:
+ *     Run com a menor (chave, run), como arvore_vencedor, e a segunda
+ *     colocada.
+ *
+ * param segundo  Recebe a segunda colocada (≥ k se só há uma run ativa)
+ * return         Run vencedora, ou um valor ≥ k se todas estão esgotadas
+ */
+size_t torneio_vencedor(const TorneioVetorial *t, size_t *segundo);
+
+/**
+ * ➔ torneio_substituir:
+ *     Troca a chave da run (ou a marca como esgotada). A chave é gravada
+ *     com a largura do núcleo em uso: uma escrita de 8 bytes seguida da
+ *     leitura vetorial de torneio_vencedor não é repassada pelo store
+ *     buffer e custaria mais que o próprio torneio.
+ */
+void torneio_substituir(TorneioVetorial *t, size_t run, uint64_t chave, bool ativa);
+
+/**
+ * ➔ torneio_chave:
+ *     return  Chave atual da run (UINT64_MAX se esgotada)
+ */
+static inline uint64_t torneio_chave(const TorneioVetorial *t, size_t run) {
+    return (uint64_t) t->chaves[run] ^ (UINT64_C(1) << 63);
+}
+
+/**
+ * ➔ contar_abaixo:
+ *     Quantos dos n registros seguidos (de tam_registro bytes, chave nos
+ *     primeiros 8) têm chave menor que “limite”, até o primeiro que não
+ *     tem.
+ */
+size_t contar_abaixo(const unsigned char *registros, size_t tam_registro, size_t n,
+                     uint64_t limite);
+
+#endif // MERGE_VETORIAL_H
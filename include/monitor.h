@@ -1,26 +1,100 @@
 #ifndef MONITOR_H
 #define MONITOR_H
 
-#include <stdio.h> // Necessário para a declaração de FILE
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 /*
  * Interface da biblioteca de monitoramento para o projeto de ordenação externa.
  * Mede o tempo de execução de fases e o pico de uso de descritores de arquivo.
+ * Todo acesso a arquivos passa por aqui, através de um backend de I/O
+ * escolhido em tempo de execução; os contadores valem para qualquer backend.
  */
 
+// --- Backends de I/O ---
+
+/**
+ * brief Handle opaco de arquivo aberto por mon_fopen().
+ */
+typedef struct ArquivoMon ArquivoMon;
+
+/**
+ * brief Implementações de I/O disponíveis:
+ *   • MON_IO_STDIO: fopen/fread/fwrite (padrão)
+ *   • MON_IO_POSIX: open/pread/pwrite, sem buffer do stdio
+ *   • MON_IO_URING: io_uring com leituras antecipadas e escritas em lote,
+ *                   compartilhando um único anel entre todos os arquivos
+ */
+typedef enum {
+    MON_IO_STDIO,
+    MON_IO_POSIX,
+    MON_IO_URING
+} BackendIO;
+
+/**
+ * brief Escolhe o backend usado pelos próximos mon_fopen().
+ * Deve ser chamada antes de abrir qualquer arquivo.
+ * return 0 em sucesso; -1 se o backend não estiver disponível neste
+ *        sistema (nesse caso, MON_IO_POSIX passa a ser usado).
+ */
+int mon_definir_backend(BackendIO backend);
+
+/**
+ * brief Nome do backend em uso (“stdio”, “posix” ou “io_uring”).
+ */
+const char *mon_nome_backend(void);
+
+/**
+ * brief Liga o I/O direto (O_DIRECT) nos arquivos abertos por
+ * mon_fopen_temporario(), que deixam de passar pelo cache de páginas.
+ * Os buffers alinhados vêm de um pool compartilhado entre todas as fases.
+ */
+void mon_definir_direto(bool ligado);
+
 // --- Funções de Monitoramento de Arquivos ---
 
+// ► Nome que mon_fopen() entende como stdin (“rb”) ou stdout (“wb”)
+#define MON_FLUXO "-"
+
 /**
  * brief Um invólucro para fopen() que monitora o número de arquivos abertos.
  * Use esta função em vez de fopen() para contar os descritores.
+ * Modos aceitos: “rb” (leitura) e “wb” (escrita, truncando).
+ * O nome MON_FLUXO abre o stdin ou o stdout, que podem ser pipes: o
+ * arquivo só aceita leitura e escrita sequenciais (sem mon_pwrite), com
+ * o stdio, qualquer que seja o backend escolhido.
  */
-FILE *mon_fopen(const char *pathname, const char *mode);
+ArquivoMon *mon_fopen(const char *pathname, const char *mode);
+
+/**
+ * brief Reserva o stdout para mon_fopen(MON_FLUXO, "wb") e passa o
+ * stdout do processo (as mensagens de progresso dos printf) para o
+ * stderr. Deve ser chamada antes de qualquer printf.
+ * return 0 em sucesso, -1 em falha de dup/dup2 (errno preenchido).
+ */
+int mon_reservar_stdout(void);
+
+/**
+ * brief Como mon_fopen(), para arquivos temporários (runs e arquivo
+ * ordenado), gravados e lidos uma única vez. Com mon_definir_direto(true)
+ * usa O_DIRECT; se o sistema de arquivos não suportar, avisa uma vez e
+ * recorre ao backend normal.
+ */
+ArquivoMon *mon_fopen_temporario(const char *pathname, const char *mode);
+
+/**
+ * brief Como mon_fopen_temporario(), mas a leitura (modo “rb”) começa no
+ * byte “inicio” do arquivo. Usada para ler só uma faixa de uma run.
+ */
+ArquivoMon *mon_fopen_temporario_em(const char *pathname, const char *mode, uint64_t inicio);
 
 /**
  * brief Um invólucro para fclose() que monitora o número de arquivos abertos.
- * Use esta função em vez de fclose().
+ * Use esta função em vez de fclose(). Escritas pendentes são concluídas
+ * aqui; retorna diferente de 0 se alguma delas falhou.
  */
-int mon_fclose(FILE *stream);
+int mon_fclose(ArquivoMon *stream);
 
 /**
  * brief Imprime a métrica do pico de descritores de arquivo abertos.
@@ -42,9 +116,109 @@ void mon_timer_start(void);
  */
 void mon_timer_stop_and_log(int phase_num);
 
+/**
+ * brief Retorna o instante atual (CLOCK_MONOTONIC) em segundos.
+ * Usado para medir o tempo ocupado de cada estágio de uma fase.
+ */
+double mon_agora(void);
+
+/**
+ * brief Registra o tempo ocupado (em segundos) dos estágios de leitura,
+ * ordenação e escrita da fase em andamento. O próximo
+ * mon_timer_stop_and_log() imprime esses tempos e a sobreposição obtida:
+ * 0% quando a fase durou a soma dos estágios e 100% quando durou apenas
+ * o estágio mais lento.
+ */
+void mon_registrar_estagios(double leitura, double ordenacao, double escrita);
 
-size_t mon_fread(void *ptr, size_t size, size_t nmemb, FILE *stream);
-size_t mon_fwrite(const void *ptr, size_t size, size_t nmemb, FILE *stream);
+
+size_t mon_fread(void *ptr, size_t size, size_t nmemb, ArquivoMon *stream);
+size_t mon_fwrite(const void *ptr, size_t size, size_t nmemb, ArquivoMon *stream);
 void mon_log_io_stats(void);
 
+/**
+ * brief Grava “bytes” bytes na posição absoluta “offset” de um arquivo
+ * aberto com mon_fopen(…, "wb"), sem mover a posição de mon_fwrite.
+ * Várias threads podem chamá-la no mesmo arquivo ao mesmo tempo, desde
+ * que nenhuma use mon_fwrite nele. Não disponível nos temporários com
+ * O_DIRECT.
+ * return Bytes gravados (menos que “bytes” apenas em erro).
+ */
+size_t mon_pwrite(const void *ptr, size_t bytes, uint64_t offset, ArquivoMon *stream);
+
+/**
+ * brief Diz se mon_pwrite() está disponível para o arquivo (não está nos
+ * temporários abertos com O_DIRECT).
+ */
+bool mon_suporta_pwrite(const ArquivoMon *stream);
+
+/**
+ * brief Diz se os temporários abertos com mon_fopen_temporario() terão
+ * mon_pwrite(), antes de abri-los (não com --direto).
+ */
+bool mon_temporarios_com_pwrite(void);
+
+/**
+ * brief errno da leitura que falhou no arquivo, ou 0 se nenhuma falhou.
+ * Uma leitura curta de mon_fread() é EOF quando isto retorna 0 e erro de
+ * I/O caso contrário (quem lê deve abortar, não tratar como fim).
+ */
+int mon_erro_leitura(const ArquivoMon *stream);
+
+/**
+ * brief Bytes de buffer que o backend mantém por arquivo aberto, além dos
+ * blocos de quem lê/grava (ex.: blocos em voo do io_uring). Entram no
+ * orçamento de memória do planejador e da Fase 1.
+ * param escrita     true para arquivos de escrita, false para leitura
+ * param temporario  true para os abertos por mon_fopen_temporario()
+ */
+size_t mon_buffer_por_arquivo(bool escrita, bool temporario);
+
+/**
+ * brief Soma bytes lidos sem passar por mon_fread (ex.: de um arquivo
+ * mapeado com mmap) à métrica METRICA_IO_LIDO_MB.
+ */
+void mon_contar_bytes_lidos(size_t bytes);
+
+// --- Arquivos Mapeados ---
+
+/**
+ * brief Padrão de acesso de um arquivo mapeado por mon_mmap():
+ *   • MON_MAPA_SEQUENCIAL: lido em ordem (read-ahead agressivo do kernel)
+ *   • MON_MAPA_ALEATORIO:  saltos pelo arquivo (sem read-ahead)
+ */
+typedef enum {
+    MON_MAPA_SEQUENCIAL,
+    MON_MAPA_ALEATORIO
+} AcessoMapa;
+
+/**
+ * brief Mapeia o arquivo inteiro, somente leitura, com o conselho de
+ * acesso dado, e soma o mapeamento às métricas METRICA_MMAP_MB (bytes
+ * mapeados no total) e METRICA_MMAP_PICO_MB (mapeados ao mesmo tempo).
+ * Os bytes só entram em METRICA_IO_LIDO_MB quando quem lê chama
+ * mon_contar_bytes_lidos().
+ * return O mapeamento (bytes em *tamanho), ou NULL em falha ou arquivo
+ *        vazio (errno preenchido).
+ */
+const void *mon_mmap(const char *pathname, size_t *tamanho, AcessoMapa acesso);
+
+/**
+ * brief Pede ao kernel que carregue já os bytes [inicio, inicio + bytes)
+ * do mapeamento (MADV_WILLNEED), que serão lidos em breve.
+ */
+void mon_mmap_antecipar(const void *mapa, size_t tamanho, size_t inicio, size_t bytes);
+
+/**
+ * brief Tira do processo as páginas inteiras de [inicio, inicio + bytes)
+ * que já foram consumidas (MADV_DONTNEED): deixam de contar no RSS e,
+ * se tocadas de novo, voltam do cache de páginas.
+ */
+void mon_mmap_descartar(const void *mapa, size_t tamanho, size_t inicio, size_t bytes);
+
+/**
+ * brief Desfaz um mapeamento de mon_mmap().
+ */
+void mon_munmap(const void *mapa, size_t tamanho);
+
 #endif // MONITOR_H
\ No newline at end of file
@@ -0,0 +1,148 @@
+#ifndef OPCOES_H
+#define OPCOES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "ordena_chaves.h"
+#include "monitor.h"
+#include "temporarios.h"
+#include "formato_run.h"
+#include "merge_vetorial.h"
+
+/**
+ * ▪ GeracaoRuns: como a Fase 1 corta as runs
+ *   • GERACAO_BLOCOS:  blocos de max_blocos registros ordenados em memória
+ *   • GERACAO_SELECAO: seleção por substituição com min-heap (runs maiores)
+ */
+typedef enum {
+    GERACAO_BLOCOS,
+    GERACAO_SELECAO
+} GeracaoRuns;
+
+/**
+ * ▪ Opcoes: parâmetros de linha de comando do programa
+ *   • nome_entrada (const char*):  arquivo .vet de entrada (“-” = stdin)
+ *   • nome_saida (const char*):    arquivo .tar gerado (--saida; “-” =
+ *                                  stdout; padrão: reconstruido.tar)
+ *   • dirs_temporarios / n_dirs_temporarios: diretórios das runs, dos
+ *                                  baldes e do arquivo ordenado temporário
+ *                                  (--tmpdir, repetível; nenhum = diretório
+ *                                  atual)
+ *   • tmpdir_por_espaco (bool):    reparte os temporários pelo espaço livre
+ *                                  de cada diretório, e não em rodízio
+ *                                  (--tmpdir-politica espaco)
+ *   • max_blocos (size_t):         registros que cabem em RAM simultaneamente
+ *   • max_blocos_auto (bool):      max_blocos “auto”: medido em main pela
+ *                                  memória disponível (memoria_auto.h)
+ *   • ordenacao (MetodoOrdenacao): algoritmo da Fase 1 (--ordenacao)
+ *   • bits_radix (unsigned):       largura do dígito do radix sort (--bits-radix)
+ *   • threads (size_t):            threads de ordenação da Fase 1 (--threads)
+ *   • pipeline (bool):             leitura/ordenação/escrita sobrepostas (--pipeline)
+ *   • geracao (GeracaoRuns):       estratégia de geração de runs (--geracao)
+ *   • leitura_antecipada (bool):   read-ahead com blocos duplos no merge
+ *                                  (--leitura-antecipada)
+ *   • backend_io (BackendIO):      implementação de I/O dos arquivos (--io)
+ *   • io_direto (bool):            O_DIRECT nos arquivos temporários (--direto)
+ *   • manter_ordenado (bool):      grava também o “grande_sorted.bin”
+ *                                  (--manter-ordenado)
+ *   • somente_chaves (bool):       runs só com (chave, offset); payload
+ *                                  buscado no .vet ao final (--somente-chaves)
+ *   • chaves_densas (bool):        tenta o posicionamento direto de chaves
+ *                                  0..N-1 antes das fases normais
+ *                                  (--chaves-densas)
+ *   • distribuicao (bool):         sample sort em baldes no lugar de
+ *                                  runs + merge (--distribuicao)
+ *   • compressao (CompressaoRun):  formato das runs: registros inteiros,
+ *                                  blocos delta/varint ou delta + LZ
+ *                                  (--compressao)
+ *   • entrada_mmap (bool):         Fase 1 lê a entrada mapeada, sem copiá-la
+ *                                  para os blocos (--mmap)
+ *   • simd (NivelSimd):            núcleos do torneio vetorial do merge com
+ *                                  fan-in pequeno (--simd)
+ *   • filtrar_chaves (bool):       só os registros com chave em
+ *                                  [chave_inicial, chave_final] são
+ *                                  ordenados; os demais são descartados na
+ *                                  Fase 1 (--intervalo)
+ *   • limite_registros (size_t):   só os primeiros N registros da ordem
+ *                                  final são gravados (--limite; 0 = todos)
+ */
+typedef struct {
+    const char      *nome_entrada;  // ➔ arquivo de entrada (.vet) ou “-”
+    const char      *nome_saida;    // ➔ arquivo .tar ou “-”
+    const char      *dirs_temporarios[MAX_DIRETORIOS_TEMPORARIOS]; // ➔ --tmpdir
+    size_t           n_dirs_temporarios;
+    bool             tmpdir_por_espaco; // ➔ pesos pelo espaço livre (senão, rodízio)
+    size_t           max_blocos;    // ➔ orçamento de memória em registros
+    bool             max_blocos_auto; // ➔ orçamento medido e reavaliado entre as fases
+    MetodoOrdenacao  ordenacao;     // ➔ introsort (padrão), radix ou quicksort
+    unsigned         bits_radix;    // ➔ 8 ou 11 bits por passagem do radix
+    size_t           threads;       // ➔ 1 = Fase 1 serial
+    bool             pipeline;      // ➔ estágios da Fase 1 em threads próprias
+    GeracaoRuns      geracao;       // ➔ blocos (padrão) ou seleção por substituição
+    bool             leitura_antecipada; // ➔ read-ahead dos leitores da Fase 2
+    BackendIO        backend_io;    // ➔ stdio (padrão), posix ou io_uring
+    bool             io_direto;     // ➔ runs e ordenado fora do cache de páginas
+    bool             manter_ordenado; // ➔ merge final grava também o .bin ordenado
+    bool             somente_chaves;  // ➔ ordena só chaves e busca o payload no fim
+    bool             chaves_densas;   // ➔ permutação direta se as chaves forem 0..N-1
+    bool             distribuicao;    // ➔ baldes por faixa de chave, ordenados em RAM
+    CompressaoRun    compressao;      // ➔ formato das runs (nenhuma, delta ou lz)
+    bool             entrada_mmap;    // ➔ blocos da Fase 1 apontam para a entrada mapeada
+    NivelSimd        simd;            // ➔ auto (padrão), avx2, sse4.2 ou escalar
+    bool             filtrar_chaves;  // ➔ --intervalo informado
+    uint64_t         chave_inicial;   // ➔ faixa de --intervalo (inclusiva)
+    uint64_t         chave_final;
+    size_t           limite_registros; // ➔ top-K: registros gravados (0 = todos)
+} Opcoes;
+
+/**
+ * ➔ imprimir_uso:
+ *     Mostra em stderr a sintaxe do programa e as opções disponíveis.
+ *
+ * param prog  Nome do executável (argv[0])
+ */
+void imprimir_uso(const char *prog);
+
+/**
+ * ➔ analisar_opcoes:
+ *     Lê os dois argumentos posicionais (<arquivo_entrada> e
+ *     <max_blocos_em_memoria>), as opções “--nome valor” e as opções sem
+ *     valor (“--nome”), em qualquer ordem, preenchendo op com os valores padrão onde nada foi informado.
+ *
+ * param argc  Quantidade de argumentos (de main)
+ * param argv  Vetor de argumentos (de main)
+ * param op    Estrutura de saída
+ * return      •  0 em sucesso
+ *              • -1 se algum argumento for inválido (mensagem já impressa)
+ */
+int analisar_opcoes(int argc, char *argv[], Opcoes *op);
+
+/**
+ * ▪ OpcoesConsulta: argumentos do subcomando “consultar”
+ *   • nome_ordenado:  “grande_sorted.bin” (o índice fica ao lado)
+ *   • chave_inicial, chave_final: faixa de chaves pedida (inclusiva)
+ *   • nome_saida:     grava os registros encontrados nesse arquivo (ou “-”,
+ *                     stdout) em vez de listá-los; NULL para listar
+ */
+typedef struct {
+    const char *nome_ordenado;
+    uint64_t    chave_inicial;
+    uint64_t    chave_final;
+    const char *nome_saida;
+} OpcoesConsulta;
+
+/**
+ * ➔ analisar_consulta:
+ *     Lê “consultar <grande_sorted.bin> <chave>[:<chave_final>]
+ *     [--saida ARQUIVO|-]”.
+ *
+ * param argc  Quantidade de argumentos (de main, sem o nome do programa)
+ * param argv  Vetor de argumentos, a partir de “consultar”
+ * param op    Estrutura de saída
+ * return      •  0 em sucesso
+ *              • -1 se algum argumento for inválido (mensagem já impressa)
+ */
+int analisar_consulta(int argc, char *argv[], OpcoesConsulta *op);
+
+#endif // OPCOES_H
@@ -0,0 +1,136 @@
+#ifndef ORDENA_CHAVES_H
+#define ORDENA_CHAVES_H
+
+#include <stddef.h>
+#include "registro.h"
+#include "formato_run.h"
+
+/**
+ * ▪ MetodoOrdenacao: algoritmo usado na Fase 1 para ordenar cada bloco
+ *   • ORDENACAO_INTROSORT: introsort sobre pares (chave, índice) — padrão
+ *   • ORDENACAO_RADIX:     radix sort LSD sobre pares (chave, índice)
+ *   • ORDENACAO_QUICKSORT: quicksort original, movendo os registros inteiros
+ */
+typedef enum {
+    ORDENACAO_INTROSORT,
+    ORDENACAO_RADIX,
+    ORDENACAO_QUICKSORT
+} MetodoOrdenacao;
+
+/**
+ * ▪ ParChave:
+ *   • chave (uint64_t): cópia da chave do registro (critério de ordenação)
+ *   • indice (size_t):  posição do registro no buffer original
+ *
+ *   Ordenar pares de 16 bytes em vez de registros de 264 bytes evita mover
+ *   o payload a cada troca; os registros são copiados uma única vez, na
+ *   gravação da run (ver gravar_registros_ordenados).
+ */
+typedef struct {
+    uint64_t chave;   // ➔ chave de ordenação
+    size_t   indice;  // ➔ índice do registro no buffer
+} ParChave;
+
+/**
+ * ➔ extrair_pares:
+ *     Preenche pares[i] = { vetor[i].chave, i } para i em [0, n).
+ *
+ * param vetor  Buffer de registros lido do arquivo de entrada
+ * param n      Quantidade de registros válidos no buffer
+ * param pares  Vetor de saída com pelo menos n posições
+ */
+void extrair_pares(const RegistroDisco *vetor, size_t n, ParChave *pares);
+
+/**
+ * ➔ introsort_pares:
+ *     Ordena os pares por (chave, indice) usando introsort: quicksort com
+ *     pivô mediana-de-três (ou ninther em trechos grandes), recursão apenas
+ *     no lado menor, heapsort quando a profundidade passa de 2·log2(n) e
+ *     insertion sort nos trechos pequenos. O desempate por índice torna a
+ *     ordenação estável e o resultado determinístico.
+ *
+ * param pares  Vetor de pares a ordenar
+ * param n      Quantidade de pares
+ */
+void introsort_pares(ParChave *pares, size_t n);
+
+/**
+ * ➔ radix_pares:
+ *     Radix sort LSD dos pares pela chave de 64 bits, com dígitos de
+ *     bits_digito bits (8 → 8 passagens, 11 → 6 passagens). Os histogramas
+ *     de todos os dígitos são montados numa única leitura do vetor e as
+ *     passagens cujo dígito é igual em todos os pares são puladas. Por ser
+ *     estável, o resultado é idêntico ao do introsort_pares.
+ *
+ * param pares        Vetor de pares a ordenar (recebe o resultado)
+ * param aux          Vetor auxiliar com pelo menos n posições
+ * param n            Quantidade de pares
+ * param bits_digito  Largura do dígito em bits (entre 1 e 16)
+ */
+void radix_pares(ParChave *pares, ParChave *aux, size_t n, unsigned bits_digito);
+
+/**
+ * ➔ ordenar_bloco:
+ *     Preenche e ordena os pares de um bloco com o método escolhido. No
+ *     modo ORDENACAO_QUICKSORT o próprio vetor é ordenado e os pares saem
+ *     na ordem identidade.
+ *
+ * param vetor        Buffer de registros do bloco
+ * param n            Quantidade de registros válidos
+ * param pares        Vetor de pares com pelo menos n posições
+ * param aux          Vetor auxiliar (obrigatório apenas para ORDENACAO_RADIX)
+ * param metodo       Algoritmo de ordenação
+ * param bits_digito  Largura do dígito do radix sort
+ */
+void ordenar_bloco(RegistroDisco *vetor, size_t n, ParChave *pares, ParChave *aux,
+                   MetodoOrdenacao metodo, unsigned bits_digito);
+
+/**
+ * ➔ ordenar_pares_bloco:
+ *     Como ordenar_bloco, só para os métodos sobre pares (introsort e
+ *     radix; outro método vale como introsort), que não alteram o vetor:
+ *     serve aos blocos que apontam para a entrada mapeada, somente leitura.
+ */
+void ordenar_pares_bloco(const RegistroDisco *vetor, size_t n, ParChave *pares, ParChave *aux,
+                         MetodoOrdenacao metodo, unsigned bits_digito);
+
+/**
+ * ➔ permutar_registros:
+ *     Põe o próprio vetor na ordem dos pares (vetor[i] passa a ser o antigo
+ *     vetor[pares[i].indice]), seguindo os ciclos da permutação com um
+ *     único registro temporário: cada registro é movido uma vez.
+ *
+ * param vetor  Buffer de registros, reordenado no lugar
+ * param pares  Pares já ordenados (os índices são alterados)
+ * param n      Quantidade de registros
+ */
+void permutar_registros(RegistroDisco *vetor, ParChave *pares, size_t n);
+
+/**
+ * ➔ gravar_registros_ordenados:
+ *     Grava os registros vetor[pares[0].indice], vetor[pares[1].indice], …
+ *     na run, juntando-os em blocos antes de cada escritor_run_gravar.
+ *
+ * param vetor  Buffer de registros (não é modificado)
+ * param pares  Pares já ordenados
+ * param n      Quantidade de pares/registros a gravar
+ * param saida  Run aberta para escrita (escritor_run_abrir)
+ * return       Quantidade de registros efetivamente gravados (n em sucesso)
+ */
+size_t gravar_registros_ordenados(const RegistroDisco *vetor, const ParChave *pares,
+                                  size_t n, EscritorRun *saida);
+
+/**
+ * ➔ gravar_chaves_ordenadas:
+ *     Grava, para cada par, a EntradaChave { chave, indice · 264 } — o
+ *     índice dos pares é a posição global do registro na entrada — juntando
+ *     as entradas em blocos antes de cada escritor_run_gravar.
+ *
+ * param pares  Pares já ordenados (indice = número do registro no .vet)
+ * param n      Quantidade de pares a gravar
+ * param saida  Run aberta para escrita (escritor_run_abrir)
+ * return       Quantidade de entradas efetivamente gravadas (n em sucesso)
+ */
+size_t gravar_chaves_ordenadas(const ParChave *pares, size_t n, EscritorRun *saida);
+
+#endif // ORDENA_CHAVES_H
@@ -0,0 +1,147 @@
+#ifndef PLANEJADOR_H
+#define PLANEJADOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * ▪ PassoMerge: um merge intermediário do plano
+ *   • primeira (size_t): posição, em PlanoMerge.entradas, da 1ª run de entrada
+ *   • qtd (size_t):      quantidade de runs de entrada
+ *   • saida (size_t):    id da run produzida (≥ n_iniciais)
+ *   • registros:         registros gravados por este merge
+ */
+typedef struct {
+    size_t   primeira;   // ➔ início das entradas em PlanoMerge.entradas
+    size_t   qtd;        // ➔ runs de entrada
+    size_t   saida;      // ➔ id da runInter gerada
+    uint64_t registros;  // ➔ tamanho da saída
+} PassoMerge;
+
+/**
+ * ▪ PlanoMerge:
+ *   Sequência de merges da Fase 2. As runs são identificadas por ids:
+ *   0 … n_iniciais-1 são as runs da Fase 1 (run_xxxxx.bin) e cada passo
+ *   intermediário produz o id seguinte (runInter_xxxxx.bin, numeradas
+ *   em sequência a partir de 0, sem colisões qualquer que seja o total).
+ *   • fan_in: máximo de runs por merge, derivado da memória e dos descritores
+ *   • limitado_por_memoria: true se a memória (e não RLIMIT_NOFILE) limitou
+ *   • passos / n_passos: merges intermediários, na ordem de execução
+ *   • entradas: ids de entrada de todos os passos, concatenados
+ *   • final / n_final: ids mesclados no merge final
+ *   • registros_totais / registros_regravados: volume do conjunto e volume
+ *     gravado pelos merges intermediários
+ */
+typedef struct {
+    size_t      n_iniciais;           // ➔ runs geradas pela Fase 1
+    size_t      fan_in;               // ➔ k escolhido
+    bool        limitado_por_memoria; // ➔ o que limitou k
+    PassoMerge *passos;               // ➔ merges intermediários
+    size_t      n_passos;
+    size_t     *entradas;             // ➔ ids de entrada dos passos
+    size_t     *final;                // ➔ ids do merge final
+    size_t      n_final;
+    uint64_t    registros_totais;     // ➔ soma das runs iniciais
+    uint64_t    registros_regravados; // ➔ soma das saídas intermediárias
+} PlanoMerge;
+
+/**
+ * ➔ registros_de_buffers_io:
+ *     Buffers próprios do backend de I/O (mon_buffer_por_arquivo) e, com
+ *     runs comprimidas, do codec (bytes_codec_por_run) para arquivos
+ *     temporários abertos ao mesmo tempo, em registros de
+ *     tam_registro bytes (arredondado para cima): parte do orçamento que
+ *     os blocos do merge não podem usar.
+ *
+ * param escritores    Arquivos abertos para escrita
+ * param leitores      Arquivos abertos para leitura
+ * param tam_registro  Bytes por registro
+ * return              Registros equivalentes (0 com stdio e sem compressão)
+ */
+size_t registros_de_buffers_io(size_t escritores, size_t leitores, size_t tam_registro);
+
+/**
+ * ➔ calcular_fan_in:
+ *     Maior k tal que k leitores (dois blocos cada, com read-ahead) mais o
+ *     bloco de saída recebam ao menos 4 KB (uma página) do orçamento — já
+ *     descontados os buffers próprios do backend em cada arquivo —, e que k
+ *     arquivos de run caibam no limite de descritores (RLIMIT_NOFILE),
+ *     descontada uma reserva para stdin/stdout/stderr, a saída e o .tar.
+ *
+ * param memoria_registros   Orçamento do merge em registros de tam_registro bytes
+ * param tam_registro        Bytes por registro das runs
+ * param leitura_antecipada  true se cada leitor usa dois blocos
+ * param por_memoria         Recebe true se a memória foi o limite (pode ser NULL)
+ * return                    k ≥ 2
+ */
+size_t calcular_fan_in(size_t memoria_registros, size_t tam_registro,
+                       bool leitura_antecipada, bool *por_memoria);
+
+/**
+ * ➔ planejar_merge:
+ *     Monta o plano de Huffman de ordem k: cada merge junta as k runs
+ *     menores existentes, e o primeiro junta apenas ((n−1) mod (k−1)) + 1,
+ *     de forma que o merge final receba exatamente k runs. Assim as runs
+ *     grandes são regravadas o menor número de vezes e nenhum passo fica
+ *     com um grupo residual minúsculo. Empates de tamanho: menor id
+ *     primeiro. As entradas de cada merge seguem a ordem das runs
+ *     originais, o que mantém o resultado determinístico.
+ *
+ * param tamanhos   Registros em cada run inicial
+ * param n_runs     Quantidade de runs iniciais (≥ 1)
+ * param fan_in     k (≥ 2), normalmente de calcular_fan_in
+ * param plano      Estrutura de saída (liberar com liberar_plano)
+ * return           0 em sucesso, -1 em falha de alocação
+ */
+int planejar_merge(const uint64_t *tamanhos, size_t n_runs, size_t fan_in, PlanoMerge *plano);
+
+/**
+ * ➔ planejar_runs_em_disco:
+ *     Lê o tamanho de run_00000.bin … run_{n-1}.bin, escolhe o fan-in com
+ *     calcular_fan_in e monta o plano com planejar_merge. Com threads > 1,
+ *     o fan-in é dividido entre elas, para que o merge final possa ser
+ *     repartido em faixas mescladas em paralelo; o chamador só passa
+ *     threads > 1 se esse merge vai mesmo ser repartido (ver
+ *     threads_merge_paralelo), para não encolher o fan-in à toa.
+ *
+ * param n_runs              Runs geradas pela Fase 1
+ * param memoria_registros   Orçamento do merge em registros de tam_registro bytes
+ * param tam_registro        Bytes por registro das runs
+ * param leitura_antecipada  true se cada leitor usa dois blocos
+ * param threads             Threads do merge final paralelo (1 → serial)
+ * param plano               Estrutura de saída (liberar com liberar_plano)
+ * return                    0 em sucesso, -1 em falha de alocação
+ */
+int planejar_runs_em_disco(size_t n_runs, size_t memoria_registros, size_t tam_registro,
+                           bool leitura_antecipada, size_t threads, PlanoMerge *plano);
+
+/**
+ * ➔ nome_run_plano:
+ *     Escreve o nome do arquivo da run “id” (run_xxxxx.bin ou
+ *     runInter_xxxxx.bin) em buf.
+ */
+void nome_run_plano(const PlanoMerge *plano, size_t id, char *buf, size_t tam);
+
+/**
+ * ➔ imprimir_plano:
+ *     Mostra em stdout o resumo do plano (fan-in, passos, volume regravado)
+ *     e os primeiros merges intermediários.
+ */
+void imprimir_plano(const PlanoMerge *plano);
+
+/**
+ * ➔ liberar_plano:
+ *     Libera os vetores do plano.
+ */
+void liberar_plano(PlanoMerge *plano);
+
+/**
+ * ➔ registros_no_arquivo:
+ *     Tamanho de um arquivo de registros de tam_registro bytes (0 se não
+ *     existir). Para as runs, que podem ser comprimidas, ver
+ *     registros_na_run.
+ */
+uint64_t registros_no_arquivo(const char *nome, size_t tam_registro);
+
+#endif // PLANEJADOR_H
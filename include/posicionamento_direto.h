@@ -0,0 +1,71 @@
+#ifndef POSICIONAMENTO_DIRETO_H
+#define POSICIONAMENTO_DIRETO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "monitor.h"
+#include "indice_esparso.h"
+
+/**
+ * ▪ MapaDenso:
+ *   Resultado da verificação do modo --chaves-densas: quando as N chaves
+ *   do .vet são exatamente 0..N-1, a posição de cada pacote no .tar é a
+ *   soma dos tamanhos das chaves menores, e a ordenação vira uma única
+ *   passagem que grava cada pacote no seu lugar.
+ *   • n: quantidade de registros (e de chaves)
+ *   • tamanhos: bytes válidos do pacote de cada chave (1 byte por chave)
+ *   • prefixo: soma dos tamanhos antes de cada grupo de 64 chaves (NULL
+ *     quando todos os pacotes estão cheios: a posição é chave × 250)
+ *   • total_bytes: conteúdo do .tar (soma de todos os tamanhos)
+ */
+typedef struct {
+    size_t    n;            // ➔ registros = chaves
+    uint8_t  *tamanhos;     // ➔ tamanho do pacote, indexado pela chave
+    uint64_t *prefixo;      // ➔ somas parciais por grupo (ou NULL)
+    uint64_t  total_bytes;  // ➔ conteúdo do .tar, sem padding
+} MapaDenso;
+
+/**
+ * ➔ verificar_chaves_densas:
+ *     Lê o .vet uma vez e confere se as chaves formam a sequência 0..N-1
+ *     (sem lacunas nem repetições), guardando o tamanho de cada pacote e
+ *     as somas parciais. O mapa ocupa ~1,1 byte por registro e precisa
+ *     caber no orçamento de max_blocos registros.
+ *
+ * param nome_entrada  Arquivo .vet
+ * param max_blocos    Orçamento de memória, em registros
+ * param mapa          Saída (válido apenas com retorno 0)
+ * return              •  0 se as chaves são densas
+ *                     •  1 se não são, ou o mapa não cabe no orçamento
+ *                          (motivo já impresso; nada fica alocado)
+ *                     • -1 em erro de leitura ou de alocação
+ */
+int verificar_chaves_densas(const char *nome_entrada, size_t max_blocos, MapaDenso *mapa);
+
+/**
+ * ➔ posicionar_registros:
+ *     Segunda leitura do .vet: grava cada pacote na sua posição do .tar
+ *     (e o registro inteiro em chave × 264 no arquivo ordenado, se
+ *     pedido), juntando numa só escrita os registros que caem em posições
+ *     consecutivas. Não grava o padding nem o fim-de-tar (tar_fechar, com
+ *     o gravador marcado como posicional).
+ *
+ * param mapa           Mapa de verificar_chaves_densas
+ * param nome_entrada   Arquivo .vet
+ * param tar            Arquivo do .tar aberto por tar_abrir, sem conteúdo
+ * param ordenado       “grande_sorted.bin” aberto com mon_fopen, ou NULL
+ * param indice         Índice do ordenado (o registro de chave k está na
+ *                      posição k), ou NULL
+ * return               0 em sucesso, -1 em falha de leitura ou escrita
+ */
+int posicionar_registros(const MapaDenso *mapa, const char *nome_entrada,
+                         ArquivoMon *tar, ArquivoMon *ordenado, IndiceEsparso *indice);
+
+/**
+ * ➔ liberar_mapa_denso:
+ *     Libera tamanhos e prefixo.
+ */
+void liberar_mapa_denso(MapaDenso *mapa);
+
+#endif // POSICIONAMENTO_DIRETO_H
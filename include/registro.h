@@ -6,8 +6,8 @@
 #include <stdio.h>
 
 // ────────────────────────────────────────────────────────────────────────────
-// ► Definição do tamanho máximo de runs abertas simultaneamente
-#define MAX_RUNS_ABERTAS 500
+// O número de runs abertas simultaneamente (fan-in do merge) é calculado em
+// tempo de execução por calcular_fan_in (planejador.h).
 
 #pragma pack(push, 1)
 /**
@@ -30,4 +30,19 @@ typedef struct {
 
 // sizeof(RegistroDisco) == 264
 
+/**
+ * ▪ EntradaChave:
+ *   ┌─────────────────────────────────────────────────────────────────────────┐
+ *   │ • chave (uint64_t):   8 bytes → chave de ordenação (mesma posição do    │
+ *   │                                 RegistroDisco, para o merge ler ambos)  │
+ *   │ • offset (uint64_t):  8 bytes → posição do registro no arquivo .vet     │
+ *   └─────────────────────────────────────────────────────────────────────────┘
+ *   Total: 16 bytes — formato das runs no modo --somente-chaves, em que o
+ *   payload só é buscado na entrada depois do merge.
+ */
+typedef struct {
+    uint64_t chave;   // ➔ chave de ordenação
+    uint64_t offset;  // ➔ offset do RegistroDisco na entrada, em bytes
+} EntradaChave;
+
 #endif // REGISTRO_H
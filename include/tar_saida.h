@@ -0,0 +1,89 @@
+#ifndef TAR_SAIDA_H
+#define TAR_SAIDA_H
+
+#include <stddef.h>
+#include "registro.h"
+#include "monitor.h"
+
+/**
+ * ▪ SaidaTar:
+ *   Gravador do “reconstruido.tar”: recebe registros já ordenados e grava
+ *   apenas pacote[0..tamanho-1] de cada um, juntando os bytes num buffer
+ *   antes de cada mon_fwrite.
+ *   • arquivo (ArquivoMon*): arquivo .tar aberto para escrita
+ *   • buffer, qtd: bytes de payload acumulados e ainda não gravados
+ *   • total_bytes: bytes de conteúdo gravados até agora
+ *   • padding: bytes de zeros gravados por tar_fechar (padding do último
+ *     bloco de 512 bytes + os dois blocos de fim-de-tar)
+ *   • erro: alguma gravação falhou
+ *   • posicional: o conteúdo foi gravado com mon_pwrite (reconstrução
+ *     paralela); tar_fechar grava o final da mesma forma
+ */
+typedef struct {
+    ArquivoMon    *arquivo;      // ➔ handle do .tar
+    unsigned char *buffer;       // ➔ payloads acumulados
+    size_t         qtd;          // ➔ bytes válidos no buffer
+    size_t         total_bytes;  // ➔ conteúdo gravado (sem padding)
+    size_t         padding;      // ➔ zeros do final (preenchido em tar_fechar)
+    bool           erro;         // ➔ true se algum mon_fwrite falhou
+    bool           posicional;   // ➔ conteúdo gravado com mon_pwrite
+} SaidaTar;
+
+/**
+ * ➔ tar_abrir:
+ *     Cria o arquivo .tar e aloca o buffer de gravação.
+ *
+ * param t     Gravador a inicializar
+ * param nome  Caminho do arquivo .tar
+ * return      0 em sucesso, -1 em falha (nada fica aberto)
+ */
+int tar_abrir(SaidaTar *t, const char *nome);
+
+/**
+ * ➔ tar_gravar_registros:
+ *     Acrescenta ao .tar os bytes válidos de n registros (tamanho acima de
+ *     250 é limitado a 250). Tem a assinatura de ConsumidorMerge, para ser
+ *     ligado diretamente ao merge final.
+ *
+ * param contexto   SaidaTar* (void* para servir de callback)
+ * param registros  Vetor de RegistroDisco em ordem
+ * param n          Quantidade de registros
+ * return           0 em sucesso, -1 em falha de escrita
+ */
+int tar_gravar_registros(void *contexto, const void *registros, size_t n);
+
+/**
+ * ➔ tar_gravar_arquivo:
+ *     Grava no .tar, ainda vazio, os registros de um arquivo ordenado
+ *     (RegistroDisco). Com threads > 1, o arquivo é repartido em pedaços
+ *     consecutivos: cada thread lê um pedaço, junta os pacotes num buffer
+ *     e grava-o com mon_pwrite na posição dada pela soma dos tamanhos de
+ *     todos os registros anteriores. Essa soma corre em cadeia — um pedaço
+ *     conhece sua posição assim que o anterior foi compactado, sem esperar
+ *     a gravação dele —, e o .tar resultante é idêntico ao da gravação
+ *     sequencial. Com threads ≤ 1, lê o arquivo do início ao fim.
+ *
+ * param t                  Gravador aberto por tar_abrir, sem conteúdo
+ * param nome               Arquivo ordenado (ex.: “grande_sorted.bin”)
+ * param threads            Threads de reconstrução
+ * param memoria_registros  Orçamento, em registros, repartido entre as
+ *                          threads (cada uma guarda o pedaço lido e o
+ *                          compactado); se não couber um pedaço mínimo
+ *                          por thread, usa menos threads (ou nenhuma)
+ * return                   0 em sucesso, -1 em falha de leitura ou escrita
+ */
+int tar_gravar_arquivo(SaidaTar *t, const char *nome, size_t threads,
+                       size_t memoria_registros);
+
+/**
+ * ➔ tar_fechar:
+ *     Grava o que restar no buffer, o padding até o próximo múltiplo de
+ *     512 bytes e os dois blocos de 512 bytes de zeros (fim-de-tar), e
+ *     fecha o arquivo. total_bytes e padding continuam válidos depois.
+ *
+ * param t  Gravador aberto por tar_abrir
+ * return   0 em sucesso, -1 se alguma gravação falhou
+ */
+int tar_fechar(SaidaTar *t);
+
+#endif // TAR_SAIDA_H
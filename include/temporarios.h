@@ -0,0 +1,81 @@
+#ifndef TEMPORARIOS_H
+#define TEMPORARIOS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * Nomes dos arquivos temporários (runs, baldes e o “grande_sorted.bin”
+ * que só serve à Fase 3): só este módulo monta os caminhos. Com vários
+ * diretórios (--tmpdir repetido), cada temporário novo vai para um deles
+ * por rodízio ponderado, e o diretório escolhido fica registrado: o mesmo
+ * nome sempre dá o mesmo caminho, e a limpeza apaga só o que foi
+ * registrado.
+ */
+
+// ► Espaço para o caminho de um temporário (diretório + nome)
+#define TAM_NOME_TEMPORARIO 512
+// ► Diretórios de temporários aceitos (--tmpdir repetido)
+#define MAX_DIRETORIOS_TEMPORARIOS 16
+
+/**
+ * ➔ configurar_temporarios:
+ *     Escolhe os diretórios dos temporários (nenhum → o diretório atual).
+ *     Confere que cada um é um diretório com permissão de escrita e que o
+ *     caminho cabe em TAM_NOME_TEMPORARIO com o nome do arquivo. Os
+ *     temporários novos são repartidos por rodízio ponderado: com
+ *     por_espaco, o peso de cada diretório é o espaço livre do sistema de
+ *     arquivos dele (statvfs, medido aqui); senão, todos pesam 1.
+ *
+ * param dirs        Caminhos dos diretórios (guardados, não copiados)
+ * param n           Quantidade (≤ MAX_DIRETORIOS_TEMPORARIOS)
+ * param por_espaco  Pesos pelo espaço livre em vez de rodízio simples
+ * return            •  0 em sucesso
+ *                   • -1 se algum diretório não servir (mensagem impressa)
+ */
+int configurar_temporarios(const char *const *dirs, size_t n, bool por_espaco);
+
+/**
+ * ➔ tam_maximo_temporario:
+ *     return  Bytes que bastam para qualquer caminho de temporário: o
+ *             diretório mais longo, a barra e o nome (menos que
+ *             TAM_NOME_TEMPORARIO, para vetores de muitos nomes)
+ */
+size_t tam_maximo_temporario(void);
+
+/**
+ * ➔ nome_temporario:
+ *     Caminho do temporário numerado “<prefixo>_<id, 5 dígitos>.bin” (ex.:
+ *     “/nvme1/run_00003.bin”; sem diretório na frente quando ele é o
+ *     atual). Na primeira vez, escolhe o diretório e registra-o; as
+ *     seguintes devolvem o mesmo caminho. Pode ser chamada por várias
+ *     threads.
+ *
+ * param buf      Destino (tam_maximo_temporario() bytes bastam)
+ * param tam      Tamanho de buf
+ * param prefixo  “run”, “runInter” ou “balde” (literal: não é copiado)
+ * param id       Número do arquivo
+ */
+void nome_temporario(char *buf, size_t tam, const char *prefixo, size_t id);
+
+/**
+ * ➔ caminho_temporario:
+ *     Como nome_temporario, para o temporário de nome fixo “nome” (ex.: o
+ *     “grande_sorted.bin” da Fase 3).
+ *
+ * param buf   Destino (tam_maximo_temporario() bytes bastam)
+ * param tam   Tamanho de buf
+ * param nome  Nome do arquivo, sem diretório (literal: não é copiado)
+ */
+void caminho_temporario(char *buf, size_t tam, const char *nome);
+
+/**
+ * ➔ remover_temporarios:
+ *     Apaga todos os temporários registrados por nome_temporario e
+ *     caminho_temporario que ainda existirem (os já apagados são
+ *     ignorados) e esvazia o registro. Arquivos de outros processos ou do
+ *     usuário nos mesmos diretórios nunca são tocados.
+ */
+void remover_temporarios(void);
+
+#endif // TEMPORARIOS_H
@@ -0,0 +1,78 @@
+#include <stdlib.h>
+#include "arvore_perdedores.h"
+
+/*
+ * ➔ vence:
+ *     true se a entrada a sai antes de b: menor chave e, em empate, menor
+ *     id. Runs esgotadas têm chave UINT64_MAX e id ≥ k, então perdem para
+ *     qualquer run ativa — inclusive uma cuja chave seja UINT64_MAX.
+ */
+static inline bool vence(const EntradaArvore *a, const EntradaArvore *b) {
+    if (a->chave != b->chave) return a->chave < b->chave;
+    return a->id < b->id;
+}
+
+/*
+ * ➔ entrada_folha:
+ *     Monta a entrada da run i (ativa ou esgotada).
+ */
+static inline EntradaArvore entrada_folha(size_t k, size_t i, uint64_t chave, bool ativa) {
+    EntradaArvore e;
+    e.chave = ativa ? chave : UINT64_MAX;
+    e.id    = ativa ? i : k + i;
+    return e;
+}
+
+int arvore_inicializar(ArvorePerdedores *a, const uint64_t *chaves, const bool *ativas, size_t k) {
+    a->k = k;
+    a->nos = malloc(k * sizeof(EntradaArvore));
+    if (!a->nos) return -1;
+
+    // Vencedores temporários de cada nó (posições 1..2k-1)
+    EntradaArvore *venc = malloc(2 * k * sizeof(EntradaArvore));
+    if (!venc) {
+        free(a->nos);
+        a->nos = NULL;
+        return -1;
+    }
+    for (size_t i = 0; i < k; i++) {
+        venc[k + i] = entrada_folha(k, i, chaves[i], ativas[i]);
+    }
+    // Confrontos de baixo para cima: o vencedor sobe, o perdedor fica no nó
+    for (size_t n = k - 1; n >= 1; n--) {
+        const EntradaArvore *e = &venc[2 * n];
+        const EntradaArvore *d = &venc[2 * n + 1];
+        if (vence(e, d)) {
+            venc[n] = *e;
+            a->nos[n] = *d;
+        } else {
+            venc[n] = *d;
+            a->nos[n] = *e;
+        }
+    }
+    a->nos[0] = venc[1];  // com k == 1 é a própria folha da run 0
+    free(venc);
+    return 0;
+}
+
+void arvore_substituir(ArvorePerdedores *a, uint64_t nova_chave, bool ativa) {
+    size_t run = a->nos[0].id;
+    if (run >= a->k) return;  // todas esgotadas
+
+    EntradaArvore atual = entrada_folha(a->k, run, nova_chave, ativa);
+    // Sobe da folha (posição k + run) até a raiz, trocando com os perdedores
+    for (size_t n = (a->k + run) / 2; n >= 1; n /= 2) {
+        if (vence(&a->nos[n], &atual)) {
+            EntradaArvore tmp = a->nos[n];
+            a->nos[n] = atual;
+            atual = tmp;
+        }
+    }
+    a->nos[0] = atual;
+}
+
+void arvore_destruir(ArvorePerdedores *a) {
+    free(a->nos);
+    a->nos = NULL;
+    a->k = 0;
+}
@@ -0,0 +1,232 @@
+// Para expor O_DIRECT, pread/pwrite e posix_memalign
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include "backend_io.h"
+
+/*
+ * Backend de I/O direto (O_DIRECT) para os arquivos temporários.
+ *
+ * As runs e o arquivo ordenado são gravados uma vez e lidos uma vez: pelo
+ * cache de páginas eles só expulsariam dados úteis de outros processos.
+ * Com O_DIRECT o kernel exige buffer, offset e tamanho alinhados, então
+ * todo acesso passa por um bloco alinhado de TAM_BLOCO_DIRETO bytes,
+ * emprestado de um pool compartilhado: o bloco que um gravador da Fase 1
+ * devolve ao fechar a run é o mesmo que um leitor da Fase 2 recebe depois.
+ * O pool só cresce até o máximo de arquivos diretos abertos ao mesmo
+ * tempo e nunca devolve memória ao sistema — o consumo fica estável. Esse
+ * máximo é limitado pelo orçamento: o bloco de cada arquivo aberto é
+ * declarado em buffer_leitura/buffer_escrita, e o planejador (fan-in e
+ * blocos do merge) e a Fase 1 descontam-no de max_blocos.
+ *
+ * O último bloco de um arquivo gravado raramente é múltiplo do
+ * alinhamento: ele é completado com zeros, gravado inteiro e o arquivo é
+ * truncado de volta ao tamanho real.
+ */
+
+// ► Alinhamento exigido pelo O_DIRECT (cobre setores de 512 B e 4 KiB)
+#define ALINHAMENTO_DIRETO 4096
+// ► Tamanho de cada bloco do pool (múltiplo de ALINHAMENTO_DIRETO)
+#define TAM_BLOCO_DIRETO   (128 * 1024)
+
+// ─────────────────────────────── Pool ───────────────────────────────
+
+typedef struct BlocoLivre {
+    struct BlocoLivre *proximo;
+} BlocoLivre;
+
+static pthread_mutex_t g_trava_pool = PTHREAD_MUTEX_INITIALIZER;
+static BlocoLivre     *g_livres = NULL;   // ➔ pilha de blocos devolvidos
+static size_t          g_criados = 0;     // ➔ blocos já alocados (pico do pool)
+
+static unsigned char *pool_emprestar(void) {
+    pthread_mutex_lock(&g_trava_pool);
+    BlocoLivre *b = g_livres;
+    if (b) g_livres = b->proximo;
+    pthread_mutex_unlock(&g_trava_pool);
+    if (b) return (unsigned char *) b;
+
+    void *novo = NULL;
+    if (posix_memalign(&novo, ALINHAMENTO_DIRETO, TAM_BLOCO_DIRETO) != 0) return NULL;
+    pthread_mutex_lock(&g_trava_pool);
+    g_criados++;
+    pthread_mutex_unlock(&g_trava_pool);
+    return novo;
+}
+
+static void pool_devolver(unsigned char *bloco) {
+    BlocoLivre *b = (BlocoLivre *) bloco;
+    pthread_mutex_lock(&g_trava_pool);
+    b->proximo = g_livres;
+    g_livres = b;
+    pthread_mutex_unlock(&g_trava_pool);
+}
+
+size_t direto_bytes_pool(void) {
+    pthread_mutex_lock(&g_trava_pool);
+    size_t n = g_criados;
+    pthread_mutex_unlock(&g_trava_pool);
+    return n * TAM_BLOCO_DIRETO;
+}
+
+// ───────────────────────────── Arquivo ──────────────────────────────
+
+typedef struct {
+    int            fd;
+    bool           escrita;
+    off_t          posicao;  // ➔ offset do bloco atual (sempre alinhado)
+    unsigned char *bloco;    // ➔ bloco alinhado emprestado do pool
+    size_t         qtd;      // ➔ bytes válidos (leitura) / acumulados (escrita)
+    size_t         pos;      // ➔ bytes já consumidos (leitura)
+    bool           fim;      // ➔ leitura: EOF atingido
+    bool           erro;     // ➔ alguma escrita falhou
+    int            erro_leitura; // ➔ errno da leitura que falhou (0 se nenhuma)
+} ArquivoDireto;
+
+/*
+ * ➔ gravar_bloco:
+ *     Grava “bytes” (múltiplo do alinhamento) do bloco no offset atual.
+ */
+static bool gravar_bloco(ArquivoDireto *a, size_t bytes) {
+    size_t total = 0;
+    while (total < bytes) {
+        ssize_t n = pwrite(a->fd, a->bloco + total, bytes - total, a->posicao + (off_t) total);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        total += (size_t) n;
+    }
+    return true;
+}
+
+/*
+ * ➔ recarregar_bloco:
+ *     Lê o próximo bloco. Uma leitura curta só é continuada enquanto o que
+ *     veio for múltiplo do alinhamento; caso contrário é o fim do arquivo.
+ */
+static void recarregar_bloco(ArquivoDireto *a) {
+    a->posicao += (off_t) a->qtd;
+    size_t total = 0;
+    while (total < TAM_BLOCO_DIRETO) {
+        ssize_t n = pread(a->fd, a->bloco + total, TAM_BLOCO_DIRETO - total,
+                          a->posicao + (off_t) total);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) a->erro_leitura = errno;
+        if (n <= 0) break;
+        total += (size_t) n;
+        if (total % ALINHAMENTO_DIRETO != 0) break;
+    }
+    a->qtd = total;
+    a->pos = 0;
+    if (total < TAM_BLOCO_DIRETO) a->fim = true;
+}
+
+static void *direto_abrir(const char *caminho, bool escrita, uint64_t inicio) {
+    int flags = escrita ? (O_WRONLY | O_CREAT | O_TRUNC) : O_RDONLY;
+    int fd = open(caminho, flags | O_DIRECT, 0644);
+    if (fd < 0) return NULL;  // errno == EINVAL: sistema de arquivos sem O_DIRECT
+
+    ArquivoDireto *a = calloc(1, sizeof(ArquivoDireto));
+    unsigned char *bloco = a ? pool_emprestar() : NULL;
+    if (!bloco) {
+        free(a);
+        close(fd);
+        errno = ENOMEM;
+        return NULL;
+    }
+    a->fd = fd;
+    a->escrita = escrita;
+    a->bloco = bloco;
+    if (inicio > 0) {
+        // O_DIRECT só lê a partir de offsets alinhados: carrega o bloco que
+        // contém “inicio” e pula os bytes anteriores a ele
+        a->posicao = (off_t) (inicio & ~(uint64_t) (ALINHAMENTO_DIRETO - 1));
+        recarregar_bloco(a);
+        size_t pular = (size_t) (inicio - (uint64_t) a->posicao);
+        a->pos = pular < a->qtd ? pular : a->qtd;
+    }
+    return a;
+}
+
+static size_t direto_ler(void *estado, void *destino, size_t bytes) {
+    ArquivoDireto *a = estado;
+    unsigned char *dst = destino;
+    size_t total = 0;
+    while (total < bytes) {
+        if (a->pos == a->qtd) {
+            if (a->fim) break;
+            recarregar_bloco(a);
+            if (a->qtd == 0) break;
+        }
+        size_t n = a->qtd - a->pos;
+        if (n > bytes - total) n = bytes - total;
+        memcpy(dst + total, a->bloco + a->pos, n);
+        a->pos += n;
+        total += n;
+    }
+    return total;
+}
+
+static size_t direto_escrever(void *estado, const void *origem, size_t bytes) {
+    ArquivoDireto *a = estado;
+    const unsigned char *src = origem;
+    size_t total = 0;
+    while (total < bytes && !a->erro) {
+        size_t n = TAM_BLOCO_DIRETO - a->qtd;
+        if (n > bytes - total) n = bytes - total;
+        memcpy(a->bloco + a->qtd, src + total, n);
+        a->qtd += n;
+        total += n;
+        if (a->qtd == TAM_BLOCO_DIRETO) {
+            if (!gravar_bloco(a, TAM_BLOCO_DIRETO)) {
+                a->erro = true;
+                break;
+            }
+            a->posicao += TAM_BLOCO_DIRETO;
+            a->qtd = 0;
+        }
+    }
+    return a->erro ? 0 : total;
+}
+
+static int direto_erro_leitura(void *estado) {
+    return ((ArquivoDireto *) estado)->erro_leitura;
+}
+
+static int direto_fechar(void *estado) {
+    ArquivoDireto *a = estado;
+    int ret = a->erro ? -1 : 0;
+
+    if (a->escrita && !a->erro && a->qtd > 0) {
+        // Bloco final parcial: completa até o alinhamento, grava e trunca
+        size_t alinhado = (a->qtd + ALINHAMENTO_DIRETO - 1) / ALINHAMENTO_DIRETO * ALINHAMENTO_DIRETO;
+        memset(a->bloco + a->qtd, 0, alinhado - a->qtd);
+        if (!gravar_bloco(a, alinhado) ||
+            ftruncate(a->fd, a->posicao + (off_t) a->qtd) != 0) {
+            ret = -1;
+        }
+    }
+
+    if (close(a->fd) != 0) ret = -1;
+    pool_devolver(a->bloco);
+    free(a);
+    return ret;
+}
+
+const OperacoesIO OPERACOES_DIRETO = {
+    .nome     = "direto",
+    .abrir    = direto_abrir,
+    .ler      = direto_ler,
+    .escrever = direto_escrever,
+    .escrever_em = NULL,  // offsets arbitrários quebrariam o alinhamento
+    .erro_leitura = direto_erro_leitura,
+    .fechar   = direto_fechar,
+    // Cada arquivo aberto segura um bloco do pool até fechar
+    .buffer_leitura = TAM_BLOCO_DIRETO,
+    .buffer_escrita = TAM_BLOCO_DIRETO
+};
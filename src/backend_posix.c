@@ -0,0 +1,184 @@
+// Para expor pread/pwrite (POSIX.1-2008)
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include "backend_io.h"
+
+/*
+ * Backend POSIX: open/pread/pwrite com a posição mantida aqui.
+ * Leituras e escritas grandes (≥ TAM_BUFFER_POSIX) vão direto ao kernel;
+ * só as pequenas passam por um buffer próprio, alocado sob demanda — os
+ * leitores de run e o merge já trabalham em blocos grandes, então a
+ * maioria dos arquivos nunca chega a alocá-lo.
+ */
+
+// ► Tamanho do buffer de operações pequenas
+#define TAM_BUFFER_POSIX (64 * 1024)
+
+typedef struct {
+    int            fd;
+    bool           escrita;
+    off_t          posicao;   // ➔ offset da próxima operação no arquivo
+    unsigned char *buffer;    // ➔ buffer de operações pequenas (ou NULL)
+    size_t         buf_qtd;   // ➔ bytes válidos (leitura) / acumulados (escrita)
+    size_t         buf_pos;   // ➔ bytes já consumidos (leitura)
+    bool           erro;      // ➔ alguma escrita falhou
+    int            erro_leitura; // ➔ errno da leitura que falhou (0 se nenhuma)
+} ArquivoPosix;
+
+/*
+ * ➔ ler_tudo / escrever_tudo:
+ *     pread/pwrite repetidos até completar (ou EOF/erro), tratando EINTR.
+ */
+static size_t ler_tudo(int fd, void *destino, size_t bytes, off_t posicao, int *erro) {
+    size_t total = 0;
+    while (total < bytes) {
+        ssize_t n = pread(fd, (unsigned char *) destino + total, bytes - total,
+                          posicao + (off_t) total);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) *erro = errno;
+        if (n <= 0) break;
+        total += (size_t) n;
+    }
+    return total;
+}
+
+static size_t escrever_tudo(int fd, const void *origem, size_t bytes, off_t posicao) {
+    size_t total = 0;
+    while (total < bytes) {
+        ssize_t n = pwrite(fd, (const unsigned char *) origem + total, bytes - total,
+                           posicao + (off_t) total);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        total += (size_t) n;
+    }
+    return total;
+}
+
+static int descarregar(ArquivoPosix *a) {
+    if (a->buf_qtd == 0) return 0;
+    size_t n = escrever_tudo(a->fd, a->buffer, a->buf_qtd, a->posicao);
+    a->posicao += (off_t) n;
+    int ret = (n == a->buf_qtd) ? 0 : -1;
+    if (ret < 0) a->erro = true;
+    a->buf_qtd = 0;
+    return ret;
+}
+
+static void *posix_abrir(const char *caminho, bool escrita, uint64_t inicio) {
+    int flags = escrita ? (O_WRONLY | O_CREAT | O_TRUNC) : O_RDONLY;
+    int fd = open(caminho, flags, 0644);
+    if (fd < 0) return NULL;
+    ArquivoPosix *a = calloc(1, sizeof(ArquivoPosix));
+    if (!a) {
+        close(fd);
+        return NULL;
+    }
+    a->fd = fd;
+    a->escrita = escrita;
+    a->posicao = (off_t) inicio;
+    return a;
+}
+
+static size_t posix_ler(void *estado, void *destino, size_t bytes) {
+    ArquivoPosix *a = estado;
+    unsigned char *dst = destino;
+    size_t total = 0;
+
+    while (total < bytes) {
+        // 1) Consome o que já está no buffer
+        if (a->buf_pos < a->buf_qtd) {
+            size_t n = a->buf_qtd - a->buf_pos;
+            if (n > bytes - total) n = bytes - total;
+            memcpy(dst + total, a->buffer + a->buf_pos, n);
+            a->buf_pos += n;
+            total += n;
+            continue;
+        }
+
+        // 2) Pedido grande: direto para o destino
+        size_t faltam = bytes - total;
+        if (faltam >= TAM_BUFFER_POSIX) {
+            size_t n = ler_tudo(a->fd, dst + total, faltam, a->posicao, &a->erro_leitura);
+            a->posicao += (off_t) n;
+            total += n;
+            break;  // completo, ou EOF
+        }
+
+        // 3) Pedido pequeno: recarrega o buffer
+        if (!a->buffer) {
+            a->buffer = malloc(TAM_BUFFER_POSIX);
+            if (!a->buffer) break;
+        }
+        size_t n = ler_tudo(a->fd, a->buffer, TAM_BUFFER_POSIX, a->posicao, &a->erro_leitura);
+        a->posicao += (off_t) n;
+        a->buf_qtd = n;
+        a->buf_pos = 0;
+        if (n == 0) break;  // EOF
+    }
+    return total;
+}
+
+static size_t posix_escrever(void *estado, const void *origem, size_t bytes) {
+    ArquivoPosix *a = estado;
+    if (a->erro) return 0;
+
+    // Pedido grande: esvazia o buffer e grava direto
+    if (bytes >= TAM_BUFFER_POSIX) {
+        if (descarregar(a) < 0) return 0;
+        size_t n = escrever_tudo(a->fd, origem, bytes, a->posicao);
+        a->posicao += (off_t) n;
+        if (n < bytes) a->erro = true;
+        return n;
+    }
+
+    if (!a->buffer) {
+        a->buffer = malloc(TAM_BUFFER_POSIX);
+        if (!a->buffer) return 0;
+    }
+    if (a->buf_qtd + bytes > TAM_BUFFER_POSIX && descarregar(a) < 0) return 0;
+    memcpy(a->buffer + a->buf_qtd, origem, bytes);
+    a->buf_qtd += bytes;
+    return bytes;
+}
+
+static size_t posix_escrever_em(void *estado, const void *origem, size_t bytes,
+                                uint64_t offset) {
+    ArquivoPosix *a = estado;
+    if (a->erro) return 0;
+    if (a->buf_qtd > 0 && descarregar(a) < 0) return 0;
+    return escrever_tudo(a->fd, origem, bytes, (off_t) offset);
+}
+
+static int posix_erro_leitura(void *estado) {
+    return ((ArquivoPosix *) estado)->erro_leitura;
+}
+
+static int posix_fechar(void *estado) {
+    ArquivoPosix *a = estado;
+    int ret = 0;
+    if (a->escrita && descarregar(a) < 0) ret = -1;
+    if (a->erro) ret = -1;
+    if (close(a->fd) != 0) ret = -1;
+    free(a->buffer);
+    free(a);
+    return ret;
+}
+
+const OperacoesIO OPERACOES_POSIX = {
+    .nome     = "posix",
+    .abrir    = posix_abrir,
+    .ler      = posix_ler,
+    .escrever = posix_escrever,
+    .escrever_em = posix_escrever_em,
+    .erro_leitura = posix_erro_leitura,
+    .fechar   = posix_fechar,
+    // O buffer de operações pequenas só é alocado se alguma acontecer
+    .buffer_leitura = TAM_BUFFER_POSIX,
+    .buffer_escrita = TAM_BUFFER_POSIX
+};
@@ -0,0 +1,104 @@
+// Para expor fileno, fseeko, pwrite e fdopen
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include "backend_io.h"
+
+/*
+ * Backend stdio: o comportamento original do projeto (fopen/fread/fwrite),
+ * com o buffer interno do FILE.
+ *
+ * OPERACOES_FLUXO usa as mesmas funções no stdin e no stdout (“-”), que
+ * podem ser pipes: só leitura e escrita sequenciais, sem escrever_em.
+ */
+
+// Descritor em que o fluxo de escrita grava (o stdout original; ver
+// fluxo_definir_saida)
+static int g_fd_saida_fluxo = STDOUT_FILENO;
+
+static void *stdio_abrir(const char *caminho, bool escrita, uint64_t inicio) {
+    FILE *f = fopen(caminho, escrita ? "wb" : "rb");
+    if (f && inicio > 0 && fseeko(f, (off_t) inicio, SEEK_SET) != 0) {
+        fclose(f);
+        return NULL;
+    }
+    return f;
+}
+
+static size_t stdio_ler(void *estado, void *destino, size_t bytes) {
+    return fread(destino, 1, bytes, (FILE *) estado);
+}
+
+static size_t stdio_escrever(void *estado, const void *origem, size_t bytes) {
+    return fwrite(origem, 1, bytes, (FILE *) estado);
+}
+
+static size_t stdio_escrever_em(void *estado, const void *origem, size_t bytes,
+                                uint64_t offset) {
+    FILE *f = estado;
+    // O buffer do FILE precisa chegar ao arquivo antes do pwrite no descritor
+    if (fflush(f) != 0) return 0;
+    size_t total = 0;
+    while (total < bytes) {
+        ssize_t n = pwrite(fileno(f), (const unsigned char *) origem + total,
+                           bytes - total, (off_t) (offset + total));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        total += (size_t) n;
+    }
+    return total;
+}
+
+static int stdio_erro_leitura(void *estado) {
+    return ferror((FILE *) estado) ? EIO : 0;
+}
+
+static int stdio_fechar(void *estado) {
+    return fclose((FILE *) estado);
+}
+
+void fluxo_definir_saida(int fd) {
+    g_fd_saida_fluxo = fd;
+}
+
+static void *fluxo_abrir(const char *caminho, bool escrita, uint64_t inicio) {
+    (void) caminho;
+    if (inicio > 0) {  // um pipe não pode ser posicionado
+        errno = ESPIPE;
+        return NULL;
+    }
+    // Uma cópia do descritor: o fclose de stdio_fechar não fecha o original
+    int fd = dup(escrita ? g_fd_saida_fluxo : STDIN_FILENO);
+    if (fd < 0) return NULL;
+    FILE *f = fdopen(fd, escrita ? "wb" : "rb");
+    if (!f) close(fd);
+    return f;
+}
+
+const OperacoesIO OPERACOES_STDIO = {
+    .nome     = "stdio",
+    .abrir    = stdio_abrir,
+    .ler      = stdio_ler,
+    .escrever = stdio_escrever,
+    .escrever_em = stdio_escrever_em,
+    .erro_leitura = stdio_erro_leitura,
+    .fechar   = stdio_fechar,
+    // O buffer do FILE (BUFSIZ) é pequeno e fica fora do orçamento
+    .buffer_leitura = 0,
+    .buffer_escrita = 0
+};
+
+const OperacoesIO OPERACOES_FLUXO = {
+    .nome     = "fluxo",
+    .abrir    = fluxo_abrir,
+    .ler      = stdio_ler,
+    .escrever = stdio_escrever,
+    .escrever_em = NULL,  // pipes não têm posição
+    .erro_leitura = stdio_erro_leitura,
+    .fechar   = stdio_fechar,
+    .buffer_leitura = 0,
+    .buffer_escrita = 0
+};
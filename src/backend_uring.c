@@ -0,0 +1,531 @@
+// Para expor syscall(), mmap e pread/pwrite
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <linux/io_uring.h>
+#include "backend_io.h"
+
+/*
+ * Backend io_uring, sem liburing (chamadas de sistema diretas).
+ *
+ * Um único anel é compartilhado por todos os arquivos e threads. Cada
+ * arquivo aberto para leitura mantém BLOCOS_LEITURA leituras em voo à
+ * frente da posição consumida; cada arquivo de escrita alterna entre
+ * BLOCOS_ESCRITA blocos, submetendo um bloco cheio e seguindo a preencher
+ * o próximo. As submissões são acumuladas e enviadas em lote (a cada
+ * LOTE_SUBMISSAO entradas ou quando alguém precisa esperar), então
+ * durante o merge as leituras de várias runs e a escrita da saída saem
+ * numa mesma chamada io_uring_enter, mantendo a fila do dispositivo cheia
+ * com uma única thread.
+ *
+ * A trava do anel protege só as filas e o estado “em voo” dos blocos: a
+ * cópia de e para os blocos acontece fora dela, e quem precisa esperar uma
+ * conclusão solta a trava durante o io_uring_enter bloqueante. Só uma
+ * thread fica bloqueada no kernel de cada vez; ela colhe as conclusões de
+ * todos e acorda as demais, que voltam a conferir os seus blocos.
+ */
+
+// ► Entradas do anel de submissão (o de conclusão tem o dobro)
+#define ENTRADAS_ANEL      1024
+// ► Blocos de leitura antecipada por arquivo e tamanho de cada um
+#define BLOCOS_LEITURA     2
+#define TAM_BLOCO_LEITURA  (128 * 1024)
+// ► Blocos de escrita em rotação por arquivo e tamanho de cada um
+#define BLOCOS_ESCRITA     4
+#define TAM_BLOCO_ESCRITA  (256 * 1024)
+// ► Submissões acumuladas antes de um io_uring_enter
+#define LOTE_SUBMISSAO     16
+
+// ─────────────────────────────── Anel ───────────────────────────────
+
+typedef struct {
+    int                  fd;
+    // Anel de submissão
+    unsigned            *sq_cabeca;
+    unsigned            *sq_cauda;
+    unsigned            *sq_mascara;
+    unsigned            *sq_entradas;
+    unsigned            *sq_indices;
+    struct io_uring_sqe *sqes;
+    // Anel de conclusão
+    unsigned            *cq_cabeca;
+    unsigned            *cq_cauda;
+    unsigned            *cq_mascara;
+    struct io_uring_cqe *cqes;
+    unsigned             nao_enviadas;  // ➔ SQEs publicadas e ainda não enviadas
+    bool                 esperando;     // ➔ alguma thread está no enter bloqueante
+    pthread_mutex_t      trava;         // ➔ protege o anel e o estado em voo dos blocos
+    pthread_cond_t       colheu;        // ➔ sinaliza conclusões colhidas
+} AnelUring;
+
+static AnelUring g_anel;
+static int       g_anel_estado = 0;  // ➔ 0 = não tentado, 1 = ok, -1 = indisponível
+
+/*
+ * ▪ BlocoUring:
+ *   Buffer de uma operação de leitura/escrita. “em_voo” e “resultado” são
+ *   atualizados por quem colhe a conclusão, sempre com g_anel.trava; os
+ *   demais campos só são tocados pela thread dona do arquivo.
+ */
+typedef struct {
+    unsigned char *dados;
+    size_t         qtd;        // ➔ bytes válidos (leitura) ou preenchidos (escrita)
+    size_t         pos;        // ➔ bytes já consumidos (leitura)
+    off_t          offset;     // ➔ posição do bloco no arquivo
+    size_t         pedido;     // ➔ bytes pedidos ao kernel
+    bool           em_voo;     // ➔ operação submetida e não concluída
+    bool           disponivel; // ➔ leitura concluída e já conferida
+    int            resultado;  // ➔ cqe->res
+} BlocoUring;
+
+typedef struct {
+    int         fd;
+    bool        escrita;
+    bool        fim;         // ➔ leitura: EOF encontrado
+    bool        erro;        // ➔ escrita: alguma operação falhou
+    int         erro_leitura; // ➔ leitura: errno da operação que falhou (0 se nenhuma)
+    off_t       proximo;     // ➔ offset da próxima operação a submeter
+    size_t      capacidade;  // ➔ tamanho de cada bloco
+    size_t      n_blocos;
+    size_t      atual;       // ➔ bloco sendo consumido/preenchido
+    BlocoUring  blocos[BLOCOS_ESCRITA];
+} ArquivoUring;
+
+static int sys_enter(unsigned enviar, unsigned minimo, unsigned flags) {
+    return (int) syscall(__NR_io_uring_enter, g_anel.fd, enviar, minimo, flags, NULL, 0);
+}
+
+int uring_inicializar(void) {
+    if (g_anel_estado != 0) return g_anel_estado > 0 ? 0 : -1;
+    g_anel_estado = -1;
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    int fd = (int) syscall(__NR_io_uring_setup, ENTRADAS_ANEL, &p);
+    if (fd < 0) return -1;
+
+    size_t tam_sq = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    size_t tam_cq = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool mapa_unico = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (mapa_unico && tam_cq > tam_sq) tam_sq = tam_cq;
+
+    unsigned char *sq = mmap(NULL, tam_sq, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    unsigned char *cq = sq;
+    if (!mapa_unico) {
+        cq = mmap(NULL, tam_cq, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cq == MAP_FAILED) {
+            munmap(sq, tam_sq);
+            close(fd);
+            return -1;
+        }
+    }
+    void *sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe),
+                      PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        if (!mapa_unico) munmap(cq, tam_cq);
+        munmap(sq, tam_sq);
+        close(fd);
+        return -1;
+    }
+
+    g_anel.fd          = fd;
+    g_anel.sq_cabeca   = (unsigned *) (sq + p.sq_off.head);
+    g_anel.sq_cauda    = (unsigned *) (sq + p.sq_off.tail);
+    g_anel.sq_mascara  = (unsigned *) (sq + p.sq_off.ring_mask);
+    g_anel.sq_entradas = (unsigned *) (sq + p.sq_off.ring_entries);
+    g_anel.sq_indices  = (unsigned *) (sq + p.sq_off.array);
+    g_anel.sqes        = sqes;
+    g_anel.cq_cabeca   = (unsigned *) (cq + p.cq_off.head);
+    g_anel.cq_cauda    = (unsigned *) (cq + p.cq_off.tail);
+    g_anel.cq_mascara  = (unsigned *) (cq + p.cq_off.ring_mask);
+    g_anel.cqes        = (struct io_uring_cqe *) (cq + p.cq_off.cqes);
+    g_anel.nao_enviadas = 0;
+    g_anel.esperando    = false;
+    pthread_mutex_init(&g_anel.trava, NULL);
+    pthread_cond_init(&g_anel.colheu, NULL);
+
+    // O anel vive até o fim do processo (o kernel o libera na saída)
+    g_anel_estado = 1;
+    return 0;
+}
+
+/*
+ * ➔ colher:
+ *     Processa todas as conclusões disponíveis, marcando os blocos.
+ *     Chamar com g_anel.trava.
+ */
+static void colher(void) {
+    unsigned cabeca = *g_anel.cq_cabeca;
+    unsigned cauda  = __atomic_load_n(g_anel.cq_cauda, __ATOMIC_ACQUIRE);
+    while (cabeca != cauda) {
+        struct io_uring_cqe *cqe = &g_anel.cqes[cabeca & *g_anel.cq_mascara];
+        BlocoUring *b = (BlocoUring *) (uintptr_t) cqe->user_data;
+        b->resultado = cqe->res;
+        b->em_voo = false;
+        cabeca++;
+    }
+    __atomic_store_n(g_anel.cq_cabeca, cabeca, __ATOMIC_RELEASE);
+}
+
+/*
+ * ➔ enviar:
+ *     Entrega ao kernel as SQEs acumuladas, sem esperar conclusões.
+ *     Chamar com g_anel.trava.
+ */
+static void enviar(void) {
+    if (g_anel.nao_enviadas == 0) return;
+    int n = sys_enter(g_anel.nao_enviadas, 0, 0);
+    if (n > 0) {
+        g_anel.nao_enviadas -= ((unsigned) n > g_anel.nao_enviadas) ? g_anel.nao_enviadas : (unsigned) n;
+    }
+}
+
+/*
+ * ➔ submeter:
+ *     Publica uma operação de leitura/escrita para o bloco b. Se o anel de
+ *     submissão estiver cheio, envia o lote acumulado primeiro.
+ *     Chamar com g_anel.trava.
+ */
+static void submeter(int fd, BlocoUring *b, bool escrita) {
+    unsigned cauda = *g_anel.sq_cauda;
+    while (cauda - __atomic_load_n(g_anel.sq_cabeca, __ATOMIC_ACQUIRE) >= *g_anel.sq_entradas) {
+        enviar();
+        colher();
+    }
+
+    unsigned idx = cauda & *g_anel.sq_mascara;
+    struct io_uring_sqe *sqe = &g_anel.sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode    = escrita ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd        = fd;
+    sqe->addr      = (uint64_t) (uintptr_t) b->dados;
+    sqe->len       = (uint32_t) b->pedido;
+    sqe->off       = (uint64_t) b->offset;
+    sqe->user_data = (uint64_t) (uintptr_t) b;
+    g_anel.sq_indices[idx] = idx;
+    b->em_voo = true;
+    __atomic_store_n(g_anel.sq_cauda, cauda + 1, __ATOMIC_RELEASE);
+
+    if (++g_anel.nao_enviadas >= LOTE_SUBMISSAO) enviar();
+}
+
+/*
+ * ➔ esperar_bloco:
+ *     Bloqueia até a operação do bloco concluir (enviando o lote pendente,
+ *     que pode incluir operações de outros arquivos). Chamar com a trava,
+ *     que é solta enquanto a thread espera no kernel ou pela thread que
+ *     já está lá.
+ */
+static void esperar_bloco(BlocoUring *b) {
+    colher();
+    while (b->em_voo) {
+        if (g_anel.esperando) {
+            // Outra thread já espera no kernel: entrega o que é nosso sem
+            // bloquear e aguarda que ela colha as conclusões
+            enviar();
+            pthread_cond_wait(&g_anel.colheu, &g_anel.trava);
+            colher();
+            continue;
+        }
+        g_anel.esperando = true;
+        unsigned pendentes = g_anel.nao_enviadas;
+        g_anel.nao_enviadas = 0;
+        pthread_mutex_unlock(&g_anel.trava);
+        int n = sys_enter(pendentes, 1, IORING_ENTER_GETEVENTS);
+        pthread_mutex_lock(&g_anel.trava);
+        if (n >= 0 && (unsigned) n < pendentes) {
+            g_anel.nao_enviadas += pendentes - (unsigned) n;
+        } else if (n < 0) {
+            g_anel.nao_enviadas += pendentes;  // EINTR/EBUSY: tenta de novo
+        }
+        g_anel.esperando = false;
+        colher();
+        pthread_cond_broadcast(&g_anel.colheu);
+    }
+}
+
+// ──────────────────────────────── Leitura ────────────────────────────────
+
+static void pedir_leitura(ArquivoUring *a, BlocoUring *b) {
+    b->offset = a->proximo;
+    b->pedido = a->capacidade;
+    b->qtd = 0;
+    b->pos = 0;
+    b->disponivel = false;
+    a->proximo += (off_t) a->capacidade;
+    submeter(a->fd, b, false);
+}
+
+/*
+ * ➔ conferir_leitura:
+ *     Depois da conclusão, fixa quantos bytes o bloco tem. Uma leitura
+ *     curta que não seja EOF (rara em arquivos regulares) é completada com
+ *     pread síncrono, para que os blocos seguintes continuem alinhados.
+ *     Um erro (cqe->res < 0 ou falha do pread) encerra a leitura do
+ *     arquivo: fica em erro_leitura e em errno, para quem chamou não
+ *     confundi-lo com o EOF.
+ */
+static void conferir_leitura(ArquivoUring *a, BlocoUring *b) {
+    size_t n = 0;
+    if (b->resultado < 0) {
+        a->erro_leitura = -b->resultado;
+    } else {
+        n = (size_t) b->resultado;
+        while (n < b->pedido) {
+            ssize_t r = pread(a->fd, b->dados + n, b->pedido - n, b->offset + (off_t) n);
+            if (r < 0 && errno == EINTR) continue;
+            if (r < 0) a->erro_leitura = errno;
+            if (r <= 0) break;
+            n += (size_t) r;
+        }
+    }
+    b->qtd = n;
+    b->pos = 0;
+    b->disponivel = true;
+    if (n < b->pedido) a->fim = true;
+    if (a->erro_leitura != 0) errno = a->erro_leitura;
+}
+
+// ──────────────────────────────── Escrita ────────────────────────────────
+
+/*
+ * ➔ conferir_escrita:
+ *     Trata o resultado de uma escrita concluída: erro marca o arquivo;
+ *     escrita curta é completada com pwrite síncrono.
+ */
+static void conferir_escrita(ArquivoUring *a, BlocoUring *b) {
+    if (b->pedido == 0) return;
+    if (b->resultado < 0) {
+        a->erro = true;
+    } else {
+        size_t n = (size_t) b->resultado;
+        while (n < b->pedido) {
+            ssize_t r = pwrite(a->fd, b->dados + n, b->pedido - n, b->offset + (off_t) n);
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) {
+                a->erro = true;
+                break;
+            }
+            n += (size_t) r;
+        }
+    }
+    b->pedido = 0;
+}
+
+static void pedir_escrita(ArquivoUring *a, BlocoUring *b) {
+    b->offset = a->proximo;
+    b->pedido = b->qtd;
+    a->proximo += (off_t) b->qtd;
+    submeter(a->fd, b, true);
+}
+
+// ─────────────────────────────── Operações ───────────────────────────────
+
+static void *uring_abrir(const char *caminho, bool escrita, uint64_t inicio) {
+    int flags = escrita ? (O_WRONLY | O_CREAT | O_TRUNC) : O_RDONLY;
+    int fd = open(caminho, flags, 0644);
+    if (fd < 0) return NULL;
+
+    ArquivoUring *a = calloc(1, sizeof(ArquivoUring));
+    if (!a) {
+        close(fd);
+        return NULL;
+    }
+    a->fd         = fd;
+    a->escrita    = escrita;
+    a->proximo    = (off_t) inicio;
+    a->n_blocos   = escrita ? BLOCOS_ESCRITA : BLOCOS_LEITURA;
+    a->capacidade = escrita ? TAM_BLOCO_ESCRITA : TAM_BLOCO_LEITURA;
+    for (size_t i = 0; i < a->n_blocos; i++) {
+        a->blocos[i].dados = malloc(a->capacidade);
+        if (!a->blocos[i].dados) {
+            for (size_t j = 0; j < i; j++) free(a->blocos[j].dados);
+            free(a);
+            close(fd);
+            return NULL;
+        }
+    }
+
+    // Leitura: já deixa os primeiros blocos em voo
+    if (!escrita) {
+        pthread_mutex_lock(&g_anel.trava);
+        for (size_t i = 0; i < a->n_blocos; i++) {
+            pedir_leitura(a, &a->blocos[i]);
+        }
+        pthread_mutex_unlock(&g_anel.trava);
+    }
+    return a;
+}
+
+static size_t uring_ler(void *estado, void *destino, size_t bytes) {
+    ArquivoUring *a = estado;
+    unsigned char *dst = destino;
+    size_t total = 0;
+
+    while (total < bytes && a->erro_leitura == 0) {
+        BlocoUring *b = &a->blocos[a->atual];
+        if (!b->disponivel) {
+            if (b->pedido == 0) break;  // nada pedido: EOF anterior
+            pthread_mutex_lock(&g_anel.trava);
+            esperar_bloco(b);
+            pthread_mutex_unlock(&g_anel.trava);
+            conferir_leitura(a, b);
+        }
+
+        size_t n = b->qtd - b->pos;
+        if (n > bytes - total) n = bytes - total;
+        memcpy(dst + total, b->dados + b->pos, n);
+        b->pos += n;
+        total += n;
+
+        if (b->pos < b->qtd) continue;
+        // Bloco consumido: se era o último, EOF; senão pede o próximo
+        bool ultimo = (b->qtd < b->pedido);
+        b->disponivel = false;
+        if (ultimo) {
+            b->pedido = 0;
+            break;
+        }
+        if (!a->fim) {
+            pthread_mutex_lock(&g_anel.trava);
+            pedir_leitura(a, b);
+            pthread_mutex_unlock(&g_anel.trava);
+        } else {
+            b->pedido = 0;
+        }
+        a->atual = (a->atual + 1) % a->n_blocos;
+    }
+    if (a->erro_leitura != 0) errno = a->erro_leitura;
+    return total;
+}
+
+static size_t uring_escrever(void *estado, const void *origem, size_t bytes) {
+    ArquivoUring *a = estado;
+    const unsigned char *src = origem;
+    size_t total = 0;
+
+    while (total < bytes && !a->erro) {
+        BlocoUring *b = &a->blocos[a->atual];
+        if (b->pedido > 0) {
+            // O bloco ainda tem uma escrita anterior: espera e confere
+            pthread_mutex_lock(&g_anel.trava);
+            esperar_bloco(b);
+            pthread_mutex_unlock(&g_anel.trava);
+            conferir_escrita(a, b);
+            b->qtd = 0;
+            if (a->erro) break;
+        }
+
+        size_t n = a->capacidade - b->qtd;
+        if (n > bytes - total) n = bytes - total;
+        memcpy(b->dados + b->qtd, src + total, n);
+        b->qtd += n;
+        total += n;
+
+        if (b->qtd == a->capacidade) {
+            pthread_mutex_lock(&g_anel.trava);
+            pedir_escrita(a, b);
+            pthread_mutex_unlock(&g_anel.trava);
+            a->atual = (a->atual + 1) % a->n_blocos;
+        }
+    }
+    return a->erro ? 0 : total;
+}
+
+static size_t uring_escrever_em(void *estado, const void *origem, size_t bytes,
+                                uint64_t offset) {
+    ArquivoUring *a = estado;
+
+    // Conclui as escritas sequenciais pendentes; a posicional é síncrona
+    pthread_mutex_lock(&g_anel.trava);
+    for (size_t i = 0; i < a->n_blocos; i++) {
+        BlocoUring *b = &a->blocos[i];
+        if (b->em_voo || b->pedido > 0) {
+            esperar_bloco(b);
+            conferir_escrita(a, b);
+            b->qtd = 0;
+        }
+    }
+    BlocoUring *b = &a->blocos[a->atual];
+    if (b->qtd > 0) {
+        pedir_escrita(a, b);
+        esperar_bloco(b);
+        conferir_escrita(a, b);
+        b->qtd = 0;
+        a->atual = (a->atual + 1) % a->n_blocos;
+    }
+    bool erro = a->erro;
+    pthread_mutex_unlock(&g_anel.trava);
+    if (erro) return 0;
+
+    size_t total = 0;
+    while (total < bytes) {
+        ssize_t n = pwrite(a->fd, (const unsigned char *) origem + total,
+                           bytes - total, (off_t) (offset + total));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        total += (size_t) n;
+    }
+    return total;
+}
+
+static int uring_erro_leitura(void *estado) {
+    return ((ArquivoUring *) estado)->erro_leitura;
+}
+
+static int uring_fechar(void *estado) {
+    ArquivoUring *a = estado;
+
+    pthread_mutex_lock(&g_anel.trava);
+    if (a->escrita) {
+        // Submete o bloco parcial e espera todas as escritas
+        BlocoUring *b = &a->blocos[a->atual];
+        if (!b->em_voo && b->pedido == 0 && b->qtd > 0) {
+            pedir_escrita(a, b);
+        }
+        for (size_t i = 0; i < a->n_blocos; i++) {
+            esperar_bloco(&a->blocos[i]);
+            conferir_escrita(a, &a->blocos[i]);
+        }
+    } else {
+        // Leituras antecipadas ainda em voo precisam concluir antes do free
+        for (size_t i = 0; i < a->n_blocos; i++) {
+            esperar_bloco(&a->blocos[i]);
+        }
+    }
+    pthread_mutex_unlock(&g_anel.trava);
+
+    int ret = a->erro ? -1 : 0;
+    if (close(a->fd) != 0) ret = -1;
+    for (size_t i = 0; i < a->n_blocos; i++) free(a->blocos[i].dados);
+    free(a);
+    return ret;
+}
+
+const OperacoesIO OPERACOES_URING = {
+    .nome     = "io_uring",
+    .abrir    = uring_abrir,
+    .ler      = uring_ler,
+    .escrever = uring_escrever,
+    .escrever_em = uring_escrever_em,
+    .erro_leitura = uring_erro_leitura,
+    .fechar   = uring_fechar,
+    .buffer_leitura = BLOCOS_LEITURA * TAM_BLOCO_LEITURA,
+    .buffer_escrita = BLOCOS_ESCRITA * TAM_BLOCO_ESCRITA
+};
@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "coleta_payload.h"
+
+// ► Registros buscados na entrada antes de cada entrega ao .tar
+#define REGISTROS_POR_COLETA 256
+
+/*
+ * ➔ entregar_lote:
+ *     Entrega os registros buscados ao .tar e ao arquivo ordenado.
+ */
+static int entregar_lote(ColetaPayload *c, size_t qtd) {
+    if (qtd == 0) return 0;
+    mon_contar_bytes_lidos(qtd * sizeof(RegistroDisco));
+    if (tar_gravar_registros(c->tar, c->lote, qtd) < 0) c->erro = true;
+    if (c->ordenado &&
+        mon_fwrite(c->lote, sizeof(RegistroDisco), qtd, c->ordenado) != qtd) {
+        c->erro = true;
+    }
+    if (c->ordenado && c->indice) indice_acrescentar(c->indice, c->lote, qtd);
+    return c->erro ? -1 : 0;
+}
+
+int coleta_abrir(ColetaPayload *c, const char *nome_entrada, SaidaTar *tar,
+                 const char *nome_ordenado) {
+    memset(c, 0, sizeof(*c));
+    c->tar = tar;
+
+    // Em ordem de chave os offsets saltam pela entrada: sem read-ahead
+    size_t tamanho = 0;
+    const void *mapa = mon_mmap(nome_entrada, &tamanho, MON_MAPA_ALEATORIO);
+    if (!mapa) return -1;
+    c->mapa = mapa;
+    c->tamanho_mapa = tamanho;
+    if (tamanho < sizeof(RegistroDisco)) {
+        coleta_fechar(c);
+        errno = EINVAL;
+        return -1;
+    }
+
+    c->lote = malloc(REGISTROS_POR_COLETA * sizeof(RegistroDisco));
+    if (nome_ordenado) c->ordenado = mon_fopen_temporario(nome_ordenado, "wb");
+    if (!c->lote || (nome_ordenado && !c->ordenado)) {
+        coleta_fechar(c);
+        return -1;
+    }
+    return 0;
+}
+
+int coleta_consumir(void *contexto, const void *dados, size_t n) {
+    ColetaPayload *c = contexto;
+    const EntradaChave *entradas = dados;
+
+    size_t qtd = 0;
+    for (size_t i = 0; i < n && !c->erro; i++) {
+        uint64_t offset = entradas[i].offset;
+        if (offset > c->tamanho_mapa - sizeof(RegistroDisco)) {
+            fprintf(stderr, "❌ Offset %llu fora do arquivo de entrada\n",
+                    (unsigned long long) offset);
+            c->erro = true;
+            break;
+        }
+        memcpy(&c->lote[qtd++], c->mapa + offset, sizeof(RegistroDisco));
+        if (qtd == REGISTROS_POR_COLETA) {
+            entregar_lote(c, qtd);
+            qtd = 0;
+        }
+    }
+    if (!c->erro) entregar_lote(c, qtd);
+    return c->erro ? -1 : 0;
+}
+
+int coleta_fechar(ColetaPayload *c) {
+    int ret = c->erro ? -1 : 0;
+    if (c->mapa) mon_munmap(c->mapa, c->tamanho_mapa);
+    if (c->ordenado && mon_fclose(c->ordenado) != 0) ret = -1;
+    free(c->lote);
+    c->mapa = NULL;
+    c->ordenado = NULL;
+    c->lote = NULL;
+    return ret;
+}
@@ -0,0 +1,143 @@
+#include <string.h>
+#include "compressao_lz.h"
+
+// ► Menor cópia que vale um trecho (token + distância = 3 bytes)
+#define COPIA_MINIMA 4
+// ► Maior distância de uma cópia (2 bytes)
+#define DISTANCIA_MAXIMA 65535
+// ► Bits do hash: log2(TAM_TABELA_LZ)
+#define BITS_TABELA_LZ 12
+
+static inline uint32_t ler32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t hash4(uint32_t v) {
+    return (v * 2654435761u) >> (32 - BITS_TABELA_LZ);
+}
+
+/*
+ * ➔ estender:
+ *     Grava o resto “n” de um campo de 4 bits saturado (bytes 255 até o
+ *     último, menor que 255).
+ */
+static unsigned char *estender(unsigned char *d, size_t n) {
+    while (n >= 255) {
+        *d++ = 255;
+        n -= 255;
+    }
+    *d++ = (unsigned char) n;
+    return d;
+}
+
+/*
+ * ➔ emitir_trecho:
+ *     Grava um trecho: n_literais literais seguidos de uma cópia de
+ *     “copia” bytes à distância “distancia” (copia == 0 → último trecho,
+ *     só literais).
+ *
+ * return  Fim do que foi gravado, ou NULL se não coube até “fim”
+ */
+static unsigned char *emitir_trecho(unsigned char *d, const unsigned char *fim,
+                                    const unsigned char *literais, size_t n_literais,
+                                    size_t distancia, size_t copia) {
+    size_t resto = copia ? copia - COPIA_MINIMA : 0;
+    size_t pior = 1 + (n_literais / 255 + 1) + n_literais + 2 + (resto / 255 + 1);
+    if ((size_t) (fim - d) < pior) return NULL;
+
+    *d++ = (unsigned char) (((n_literais < 15 ? n_literais : 15) << 4) |
+                            (resto < 15 ? resto : 15));
+    if (n_literais >= 15) d = estender(d, n_literais - 15);
+    memcpy(d, literais, n_literais);
+    d += n_literais;
+    if (copia) {
+        d[0] = (unsigned char) (distancia & 0xFF);
+        d[1] = (unsigned char) (distancia >> 8);
+        d += 2;
+        if (resto >= 15) d = estender(d, resto - 15);
+    }
+    return d;
+}
+
+size_t lz_comprimir(const unsigned char *origem, size_t n, unsigned char *destino,
+                    size_t capacidade, uint16_t *tabela) {
+    // tabela[h] = posição + 1 da última sequência de 4 bytes com hash h (0 = vazia)
+    memset(tabela, 0, TAM_TABELA_LZ * sizeof(uint16_t));
+    unsigned char *d = destino;
+    const unsigned char *fim = destino + capacidade;
+    size_t i = 0, ancora = 0;
+
+    while (i + COPIA_MINIMA <= n) {
+        uint32_t v = ler32(origem + i);
+        uint32_t h = hash4(v);
+        size_t candidato = tabela[h];
+        tabela[h] = (uint16_t) (i + 1);
+        if (candidato == 0 || i - (candidato - 1) > DISTANCIA_MAXIMA ||
+            ler32(origem + candidato - 1) != v) {
+            i++;
+            continue;
+        }
+        candidato--;
+
+        size_t copia = COPIA_MINIMA;
+        while (i + copia < n && origem[candidato + copia] == origem[i + copia]) copia++;
+        d = emitir_trecho(d, fim, origem + ancora, i - ancora, i - candidato, copia);
+        if (!d) return 0;
+        i += copia;
+        ancora = i;
+    }
+
+    d = emitir_trecho(d, fim, origem + ancora, n - ancora, 0, 0);
+    return d ? (size_t) (d - destino) : 0;
+}
+
+/*
+ * ➔ ler_extensao:
+ *     Soma a *n os bytes de extensão de um campo saturado.
+ *     return  0, ou -1 se o bloco acabar no meio
+ */
+static int ler_extensao(const unsigned char **s, const unsigned char *fim, size_t *n) {
+    unsigned char b;
+    do {
+        if (*s >= fim) return -1;
+        b = *(*s)++;
+        *n += b;
+    } while (b == 255);
+    return 0;
+}
+
+int lz_descomprimir(const unsigned char *origem, size_t n, unsigned char *destino, size_t tam) {
+    const unsigned char *s = origem;
+    const unsigned char *s_fim = origem + n;
+    unsigned char *d = destino;
+    unsigned char *d_fim = destino + tam;
+
+    while (s < s_fim) {
+        unsigned token = *s++;
+        size_t n_literais = token >> 4;
+        if (n_literais == 15 && ler_extensao(&s, s_fim, &n_literais) < 0) return -1;
+        if (n_literais > (size_t) (s_fim - s) || n_literais > (size_t) (d_fim - d)) return -1;
+        memcpy(d, s, n_literais);
+        d += n_literais;
+        s += n_literais;
+        if (s == s_fim) break;  // último trecho: só literais
+
+        if (s_fim - s < 2) return -1;
+        size_t distancia = (size_t) s[0] | ((size_t) s[1] << 8);
+        s += 2;
+        size_t copia = token & 15;
+        if (copia == 15 && ler_extensao(&s, s_fim, &copia) < 0) return -1;
+        copia += COPIA_MINIMA;
+        if (distancia == 0 || distancia > (size_t) (d - destino) ||
+            copia > (size_t) (d_fim - d)) {
+            return -1;
+        }
+        // Byte a byte: a cópia pode sobrepor o que ela mesma grava
+        const unsigned char *m = d - distancia;
+        for (size_t k = 0; k < copia; k++) d[k] = m[k];
+        d += copia;
+    }
+    return d == d_fim ? 0 : -1;
+}
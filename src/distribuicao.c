@@ -0,0 +1,538 @@
+// Para expor stat
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "distribuicao.h"
+#include "registro.h"
+#include "ordena_chaves.h"
+#include "gera_runs.h"
+#include "merge_runs.h"
+#include "planejador.h"
+#include "temporarios.h"
+
+// ► Chaves sorteadas por balde na escolha dos divisores
+#define AMOSTRAS_POR_BALDE 64
+// ► Registros reunidos em ordem antes de cada entrega ao .tar
+#define REGISTROS_POR_ENTREGA 256
+// ► Semente do sorteio (fixa: a mesma entrada gera os mesmos baldes)
+#define SEMENTE_AMOSTRA 0x9E3779B97F4A7C15ULL
+
+/*
+ * ➔ nome_balde:
+ *     Escreve o caminho de “balde_xxxxx.bin” (no diretório dos
+ *     temporários) em buf.
+ */
+static void nome_balde(size_t id, char *buf, size_t tam) {
+    nome_temporario(buf, tam, "balde", id);
+}
+
+static int comparar_chaves(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * ➔ proximo_aleatorio:
+ *     xorshift64: sorteio barato e reprodutível para a amostra.
+ */
+static uint64_t proximo_aleatorio(uint64_t *estado) {
+    uint64_t x = *estado;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *estado = x;
+    return x;
+}
+
+/*
+ * ➔ escolher_divisores:
+ *     Sorteia n_amostras chaves (uma em cada faixa igual da entrada) e
+ *     guarda em divisores os n_baldes − 1 quantis da amostra ordenada.
+ *
+ * return  0 em sucesso, -1 em falha (mensagem já impressa)
+ */
+static int escolher_divisores(const char *nome_entrada, uint64_t n, size_t n_baldes,
+                              size_t n_amostras, uint64_t *divisores) {
+    // Cada amostra toca uma página distante da anterior: sem read-ahead
+    size_t tamanho = 0;
+    const void *mapa = mon_mmap(nome_entrada, &tamanho, MON_MAPA_ALEATORIO);
+    uint64_t *amostras = malloc(n_amostras * sizeof(uint64_t));
+    if (!mapa || tamanho < (size_t) n * sizeof(RegistroDisco) || !amostras) {
+        perror("❌ Erro ao preparar a amostragem das chaves");
+        if (mapa) mon_munmap(mapa, tamanho);
+        free(amostras);
+        return -1;
+    }
+
+    uint64_t estado = SEMENTE_AMOSTRA;
+    for (size_t s = 0; s < n_amostras; s++) {
+        uint64_t inicio = (uint64_t) s * n / n_amostras;
+        uint64_t fim    = (uint64_t) (s + 1) * n / n_amostras;
+        uint64_t idx    = inicio + proximo_aleatorio(&estado) % (fim - inicio);
+        memcpy(&amostras[s], (const unsigned char *) mapa + idx * sizeof(RegistroDisco),
+               sizeof(uint64_t));
+    }
+    mon_contar_bytes_lidos(n_amostras * sizeof(uint64_t));
+    mon_munmap(mapa, tamanho);
+
+    qsort(amostras, n_amostras, sizeof(uint64_t), comparar_chaves);
+    for (size_t j = 0; j + 1 < n_baldes; j++) {
+        divisores[j] = amostras[(j + 1) * n_amostras / n_baldes];
+    }
+    free(amostras);
+    return 0;
+}
+
+/*
+ * ➔ escolher_balde:
+ *     O balde j recebe as chaves em [divisores[j-1], divisores[j]]. Uma
+ *     chave estritamente entre dois divisores tem um único balde; uma
+ *     chave igual a divisores[lo..hi-1] pode ir para qualquer balde de lo
+ *     a hi, e a escolha cresce com a posição do registro na entrada, de
+ *     modo que registros de mesma chave continuam na ordem de leitura.
+ */
+static size_t escolher_balde(const uint64_t *divisores, size_t n_divisores,
+                             uint64_t chave, uint64_t posicao, uint64_t n) {
+    // lo = primeiro divisor ≥ chave
+    size_t lo = 0, hi = n_divisores;
+    while (lo < hi) {
+        size_t meio = lo + (hi - lo) / 2;
+        if (divisores[meio] < chave) lo = meio + 1;
+        else hi = meio;
+    }
+    if (lo == n_divisores || divisores[lo] != chave) return lo;
+
+    // hi = primeiro divisor > chave
+    size_t a = lo, b = n_divisores;
+    while (a < b) {
+        size_t meio = a + (b - a) / 2;
+        if (divisores[meio] <= chave) a = meio + 1;
+        else b = meio;
+    }
+    hi = a;
+    return lo + (size_t) (posicao * (hi - lo + 1) / n);
+}
+
+void liberar_distribuicao(Distribuicao *dist) {
+    // Só os baldes que este processo criou (os já gravados no .tar foram
+    // apagados pela Fase 2; sobram os de uma execução interrompida)
+    char nome[TAM_NOME_TEMPORARIO];
+    for (size_t b = 0; b < dist->n_criados; b++) {
+        nome_balde(b, nome, sizeof(nome));
+        if (remove(nome) != 0 && errno != ENOENT) {
+            fprintf(stderr, "⚠️ Aviso: falha ao apagar temporário “%s”\n", nome);
+        }
+    }
+    dist->n_criados = 0;
+    free(dist->contagens);
+    dist->contagens = NULL;
+}
+
+int distribuir_em_baldes(const Opcoes *op, Distribuicao *dist) {
+    memset(dist, 0, sizeof(*dist));
+    if (op->somente_chaves || op->pipeline || op->geracao != GERACAO_BLOCOS) {
+        fprintf(stderr, "⚠️ Aviso: --somente-chaves/--pipeline/--geracao são ignorados "
+                "com --distribuicao\n");
+    }
+
+    struct stat st;
+    if (stat(op->nome_entrada, &st) != 0) {
+        perror("❌ Erro ao consultar o arquivo de entrada");
+        return -1;
+    }
+    uint64_t n = (uint64_t) st.st_size / sizeof(RegistroDisco);
+    if (n == 0) {
+        fprintf(stderr, "❌ Nenhum registro encontrado em '%s'.\n", op->nome_entrada);
+        return -1;
+    }
+
+    // 1) P: cada balde deve caber na fatia de memória de uma thread, com
+    //    folga para o erro da amostragem; P arquivos ficam abertos e cada
+    //    um precisa de um buffer de escrita (calcular_fan_in)
+    size_t threads = op->threads > 0 ? op->threads : 1;
+    dist->capacidade = op->max_blocos / threads > 0 ? op->max_blocos / threads : 1;
+    uint64_t alvo = dist->capacidade * 3 / 4 > 0 ? dist->capacidade * 3 / 4 : 1;
+    uint64_t desejado = (n + alvo - 1) / alvo;
+    size_t maximo = calcular_fan_in(op->max_blocos, sizeof(RegistroDisco), false, NULL);
+    size_t n_baldes = desejado < maximo ? (size_t) desejado : maximo;
+    if (desejado > maximo) {
+        fprintf(stderr, "⚠️ %llu baldes caberiam em memória, mas só %zu podem ser gravados "
+                "ao mesmo tempo; os maiores serão ordenados por runs + merge.\n",
+                (unsigned long long) desejado, maximo);
+    }
+
+    dist->n_baldes    = n_baldes;
+    dist->n_registros = n;
+    dist->contagens   = calloc(n_baldes, sizeof(uint64_t));
+    uint64_t *divisores = malloc(n_baldes * sizeof(uint64_t));
+    if (!dist->contagens || !divisores) {
+        perror("❌ Falha no malloc da distribuição");
+        free(divisores);
+        liberar_distribuicao(dist);
+        return -1;
+    }
+
+    // 2) Divisores nos quantis de uma amostra aleatória
+    if (n_baldes > 1) {
+        uint64_t amostras = (uint64_t) n_baldes * AMOSTRAS_POR_BALDE;
+        dist->n_amostras = amostras < n ? (size_t) amostras : (size_t) n;
+        if (escolher_divisores(op->nome_entrada, n, n_baldes, dist->n_amostras,
+                               divisores) < 0) {
+            free(divisores);
+            liberar_distribuicao(dist);
+            return -1;
+        }
+    }
+
+    // 3) Uma leitura da entrada espalha os registros: o orçamento é
+    //    dividido entre o bloco de leitura e os P buffers de escrita
+    size_t cap_buffer = op->max_blocos / (n_baldes + 1) > 0 ? op->max_blocos / (n_baldes + 1) : 1;
+    RegistroDisco *memoria = malloc((n_baldes + 1) * cap_buffer * sizeof(RegistroDisco));
+    size_t *no_buffer = calloc(n_baldes, sizeof(size_t));
+    ArquivoMon **baldes = calloc(n_baldes, sizeof(ArquivoMon *));
+    ArquivoMon *entrada = mon_fopen(op->nome_entrada, "rb");
+    int ret = 0;
+    if (!memoria || !no_buffer || !baldes || !entrada) {
+        perror("❌ Erro ao preparar a distribuição");
+        ret = -1;
+    }
+    char nome[TAM_NOME_TEMPORARIO];
+    for (size_t b = 0; ret == 0 && b < n_baldes; b++) {
+        nome_balde(b, nome, sizeof(nome));
+        baldes[b] = mon_fopen_temporario(nome, "wb");
+        if (!baldes[b]) {
+            perror("❌ Erro ao criar balde temporário");
+            ret = -1;
+        } else {
+            dist->n_criados = b + 1;
+        }
+    }
+
+    RegistroDisco *lote = memoria + n_baldes * cap_buffer;
+    uint64_t posicao = 0;
+    size_t lidos;
+    while (ret == 0 &&
+           (lidos = mon_fread(lote, sizeof(RegistroDisco), cap_buffer, entrada)) > 0) {
+        for (size_t i = 0; i < lidos; i++, posicao++) {
+            size_t b = escolher_balde(divisores, n_baldes - 1, lote[i].chave, posicao, n);
+            RegistroDisco *buffer = memoria + b * cap_buffer;
+            buffer[no_buffer[b]++] = lote[i];
+            if (no_buffer[b] == cap_buffer) {
+                if (mon_fwrite(buffer, sizeof(RegistroDisco), cap_buffer, baldes[b]) != cap_buffer) {
+                    perror("❌ Erro ao escrever balde temporário");
+                    ret = -1;
+                    break;
+                }
+                dist->contagens[b] += cap_buffer;
+                no_buffer[b] = 0;
+            }
+        }
+    }
+    for (size_t b = 0; ret == 0 && b < n_baldes; b++) {
+        if (no_buffer[b] > 0 &&
+            mon_fwrite(memoria + b * cap_buffer, sizeof(RegistroDisco), no_buffer[b],
+                       baldes[b]) != no_buffer[b]) {
+            perror("❌ Erro ao escrever balde temporário");
+            ret = -1;
+        }
+        dist->contagens[b] += no_buffer[b];
+    }
+    if (ret == 0 && posicao != n) {
+        fprintf(stderr, "❌ Leitura incompleta de '%s' na distribuição\n", op->nome_entrada);
+        ret = -1;
+    }
+
+    for (size_t b = 0; baldes && b < n_baldes; b++) {
+        if (baldes[b] && mon_fclose(baldes[b]) != 0) ret = -1;
+    }
+    if (entrada) mon_fclose(entrada);
+    free(baldes);
+    free(no_buffer);
+    free(memoria);
+    free(divisores);
+    if (ret < 0) liberar_distribuicao(dist);
+    return ret;
+}
+
+// ─────────────────────────────── Fase 2 ───────────────────────────────
+
+/*
+ * ▪ EstadoBaldes:
+ *   Estado compartilhado pelas threads da Fase 2. Cada thread pega o
+ *   próximo balde (proximo), lê e ordena-o, e espera “vez” chegar ao seu
+ *   número para gravá-lo: a leitura e a ordenação de um balde se sobrepõem
+ *   à gravação do anterior, e a saída continua na ordem dos baldes.
+ *   Os tempos de cada estágio (o de espera pela vez fica de fora) são
+ *   somados para mon_registrar_estagios.
+ */
+typedef struct {
+    const Opcoes       *op;
+    const Distribuicao *dist;
+    SaidaTar           *tar;
+    ArquivoMon         *ordenado;
+    IndiceEsparso      *indice;
+    pthread_mutex_t     trava;
+    pthread_cond_t      vez_mudou;
+    size_t              proximo;  // ➔ próximo balde a ser pego
+    size_t              vez;      // ➔ balde que pode gravar agora
+    bool                erro;
+    double              t_leitura;    // ➔ tempos somados de todas as threads (s)
+    double              t_ordenacao;
+    double              t_escrita;
+} EstadoBaldes;
+
+/*
+ * ➔ entregar_registros:
+ *     ConsumidorMerge que acrescenta registros ordenados ao .tar e ao
+ *     arquivo ordenado (e ao índice dele). Só roda na vez do balde, então
+ *     os acréscimos ao índice ficam em sequência.
+ */
+static int entregar_registros(void *contexto, const void *registros, size_t n) {
+    EstadoBaldes *e = contexto;
+    if (tar_gravar_registros(e->tar, registros, n) < 0) return -1;
+    if (e->ordenado && mon_fwrite(registros, sizeof(RegistroDisco), n, e->ordenado) != n) {
+        return -1;
+    }
+    if (e->indice) indice_acrescentar(e->indice, registros, n);
+    return 0;
+}
+
+/*
+ * ➔ entregar_ordenados:
+ *     Reúne os registros na ordem dos pares, em lotes, e entrega-os.
+ */
+static int entregar_ordenados(EstadoBaldes *e, const RegistroDisco *vetor,
+                              const ParChave *pares, size_t n, RegistroDisco *lote) {
+    for (size_t i = 0; i < n; i += REGISTROS_POR_ENTREGA) {
+        size_t qtd = n - i < REGISTROS_POR_ENTREGA ? n - i : REGISTROS_POR_ENTREGA;
+        for (size_t j = 0; j < qtd; j++) {
+            lote[j] = vetor[pares[i + j].indice];
+        }
+        if (entregar_registros(e, lote, qtd) < 0) return -1;
+    }
+    return 0;
+}
+
+/*
+ * ➔ ordenar_por_merge:
+ *     Balde maior que a fatia de memória: gera runs dele com a mesma fatia
+ *     e mescla-as direto na saída (só uma thread por vez chega aqui).
+ */
+static int ordenar_por_merge(EstadoBaldes *e, const char *nome) {
+    Opcoes sub = *e->op;
+    sub.nome_entrada   = nome;
+    sub.max_blocos     = e->dist->capacidade;
+    sub.threads        = 1;
+    sub.pipeline       = false;
+    sub.geracao        = GERACAO_BLOCOS;
+    sub.somente_chaves = false;
+
+    size_t n_runs = 0;
+    if (gerar_runs(&sub, &n_runs, NULL) < 0) return -1;
+    if (n_runs == 0) return 0;
+
+    ParametrosMerge params = {
+        .memoria_registros  = e->dist->capacidade,
+        .tam_registro       = sizeof(RegistroDisco),
+        .leitura_antecipada = e->op->leitura_antecipada,
+        .consumidor         = entregar_registros,
+        .contexto           = e
+    };
+    PlanoMerge plano;
+    if (planejar_runs_em_disco(n_runs, params.memoria_registros, params.tam_registro,
+                               params.leitura_antecipada, 1, &plano) < 0) {
+        fprintf(stderr, "❌ Falha ao montar o plano de merge do balde\n");
+        return -1;
+    }
+    int ret = executar_merges_intermediarios(&plano, &params);
+    if (ret == 0) ret = executar_merge_final(&plano, NULL, &params);
+    liberar_plano(&plano);
+    return ret;
+}
+
+/*
+ * ➔ esperar_vez / passar_vez:
+ *     Sincronizam a gravação na ordem dos baldes; esperar_vez retorna
+ *     false se outra thread falhou.
+ */
+static bool esperar_vez(EstadoBaldes *e, size_t id) {
+    pthread_mutex_lock(&e->trava);
+    while (e->vez != id && !e->erro) {
+        pthread_cond_wait(&e->vez_mudou, &e->trava);
+    }
+    bool ok = !e->erro;
+    pthread_mutex_unlock(&e->trava);
+    return ok;
+}
+
+static void passar_vez(EstadoBaldes *e, bool ok, double leitura, double ordenacao,
+                       double escrita) {
+    pthread_mutex_lock(&e->trava);
+    e->t_leitura   += leitura;
+    e->t_ordenacao += ordenacao;
+    e->t_escrita   += escrita;
+    if (ok) e->vez++;
+    else e->erro = true;
+    pthread_cond_broadcast(&e->vez_mudou);
+    pthread_mutex_unlock(&e->trava);
+}
+
+/*
+ * ➔ ler_balde:
+ *     Lê o balde inteiro (qtd registros) para o vetor.
+ */
+static int ler_balde(const char *nome, RegistroDisco *vetor, size_t qtd) {
+    ArquivoMon *f = mon_fopen_temporario(nome, "rb");
+    if (!f) return -1;
+    size_t lidos = mon_fread(vetor, sizeof(RegistroDisco), qtd, f);
+    mon_fclose(f);
+    return lidos == qtd ? 0 : -1;
+}
+
+/*
+ * ▪ BuffersBalde:
+ *   Buffers de ordenação de uma thread da Fase 2, de cap registros cada:
+ *   o balde lido, os pares (chave, índice) e, no radix, o auxiliar.
+ */
+typedef struct {
+    RegistroDisco *vetor;
+    ParChave      *pares;
+    ParChave      *aux;
+} BuffersBalde;
+
+/*
+ * ➔ alocar_buffers / liberar_buffers:
+ *     Alocam e devolvem os buffers de uma thread; alocar_buffers retorna
+ *     -1 se algum malloc falhou (o que foi alocado fica em b, para
+ *     liberar_buffers).
+ */
+static int alocar_buffers(BuffersBalde *b, size_t cap, const Opcoes *op) {
+    b->vetor = malloc(cap * sizeof(RegistroDisco));
+    b->pares = malloc(cap * sizeof(ParChave));
+    b->aux = (op->ordenacao == ORDENACAO_RADIX) ? malloc(cap * sizeof(ParChave)) : NULL;
+    return (!b->vetor || !b->pares || (op->ordenacao == ORDENACAO_RADIX && !b->aux)) ? -1 : 0;
+}
+
+static void liberar_buffers(BuffersBalde *b) {
+    free(b->vetor);
+    free(b->pares);
+    free(b->aux);
+    b->vetor = NULL;
+    b->pares = NULL;
+    b->aux = NULL;
+}
+
+static void *trabalhar_baldes(void *arg) {
+    EstadoBaldes *e = arg;
+    const Opcoes *op = e->op;
+    size_t cap = e->dist->capacidade;
+
+    BuffersBalde b;
+    int alocou = alocar_buffers(&b, cap, op);
+    RegistroDisco *lote = malloc(REGISTROS_POR_ENTREGA * sizeof(RegistroDisco));
+    if (alocou < 0 || !lote) {
+        fprintf(stderr, "❌ Falha no malloc dos buffers da Fase 2\n");
+        passar_vez(e, false, 0.0, 0.0, 0.0);
+    }
+
+    char nome[TAM_NOME_TEMPORARIO];
+    while (true) {
+        pthread_mutex_lock(&e->trava);
+        size_t id = e->proximo++;
+        bool parar = e->erro || id >= e->dist->n_baldes;
+        pthread_mutex_unlock(&e->trava);
+        if (parar) break;
+
+        nome_balde(id, nome, sizeof(nome));
+        size_t qtd = (size_t) e->dist->contagens[id];
+        bool em_memoria = (qtd <= cap);
+        int ret = 0;
+
+        // Leitura e ordenação acontecem fora da vez
+        double t0 = mon_agora(), t1 = t0, t2 = t0;
+        if (em_memoria && qtd > 0) {
+            ret = ler_balde(nome, b.vetor, qtd);
+            t1 = mon_agora();
+            if (ret < 0) fprintf(stderr, "❌ Erro ao ler o balde “%s”\n", nome);
+            else ordenar_bloco(b.vetor, qtd, b.pares, b.aux, op->ordenacao, op->bits_radix);
+            t2 = mon_agora();
+        }
+
+        if (!esperar_vez(e, id)) break;
+        double t3 = mon_agora();
+        if (ret == 0 && em_memoria) {
+            ret = entregar_ordenados(e, b.vetor, b.pares, qtd, lote);
+        } else if (ret == 0) {
+            // As runs do balde usam um bloco próprio de cap registros: os
+            // buffers desta thread são devolvidos antes e refeitos depois,
+            // para que a thread não segure as duas cotas ao mesmo tempo
+            liberar_buffers(&b);
+            ret = ordenar_por_merge(e, nome);
+            if (ret == 0 && alocar_buffers(&b, cap, op) < 0) {
+                fprintf(stderr, "❌ Falha no malloc dos buffers da Fase 2\n");
+                ret = -1;
+            }
+        }
+        if (ret < 0) {
+            fprintf(stderr, "❌ Erro ao gravar o balde “%s”\n", nome);
+        } else {
+            remove(nome);
+        }
+        passar_vez(e, ret == 0, t1 - t0, t2 - t1, mon_agora() - t3);
+    }
+
+    liberar_buffers(&b);
+    free(lote);
+    return NULL;
+}
+
+int ordenar_baldes(const Opcoes *op, const Distribuicao *dist, SaidaTar *tar,
+                   ArquivoMon *ordenado, IndiceEsparso *indice) {
+    EstadoBaldes e = {
+        .op = op, .dist = dist, .tar = tar, .ordenado = ordenado, .indice = indice,
+        .proximo = 0, .vez = 0, .erro = false
+    };
+    pthread_mutex_init(&e.trava, NULL);
+    pthread_cond_init(&e.vez_mudou, NULL);
+
+    size_t n_threads = op->threads > 0 ? op->threads : 1;
+    if (n_threads > dist->n_baldes) n_threads = dist->n_baldes;
+
+    if (n_threads <= 1) {
+        trabalhar_baldes(&e);
+    } else {
+        pthread_t *threads = malloc(n_threads * sizeof(pthread_t));
+        size_t criadas = 0;
+        if (!threads) {
+            fprintf(stderr, "❌ Falha no malloc das threads da Fase 2\n");
+            e.erro = true;
+        }
+        for (size_t t = 0; threads && t < n_threads; t++) {
+            if (pthread_create(&threads[t], NULL, trabalhar_baldes, &e) != 0) {
+                fprintf(stderr, "❌ Falha ao criar thread da Fase 2\n");
+                passar_vez(&e, false, 0.0, 0.0, 0.0);
+                break;
+            }
+            criadas++;
+        }
+        for (size_t t = 0; t < criadas; t++) {
+            pthread_join(threads[t], NULL);
+        }
+        free(threads);
+    }
+
+    // Sobrescreve os tempos que um balde ordenado por runs + merge tenha
+    // registrado (gerar_runs), que cobririam só aquele balde
+    mon_registrar_estagios(e.t_leitura, e.t_ordenacao, e.t_escrita);
+
+    pthread_mutex_destroy(&e.trava);
+    pthread_cond_destroy(&e.vez_mudou);
+    return (e.erro || e.vez != dist->n_baldes) ? -1 : 0;
+}
@@ -0,0 +1,46 @@
+#include <stdlib.h>
+#include "fila.h"
+
+int fila_inicializar(Fila *f, size_t capacidade) {
+    if (capacidade == 0) capacidade = 1;
+    pthread_mutex_init(&f->trava, NULL);
+    pthread_cond_init(&f->nao_vazia, NULL);
+    pthread_cond_init(&f->nao_cheia, NULL);
+    f->capacidade = capacidade;
+    f->inicio = 0;
+    f->qtd = 0;
+    f->itens = malloc(capacidade * sizeof(void *));
+    return f->itens ? 0 : -1;
+}
+
+void fila_inserir(Fila *f, void *item) {
+    pthread_mutex_lock(&f->trava);
+    while (f->qtd == f->capacidade) {
+        pthread_cond_wait(&f->nao_cheia, &f->trava);
+    }
+    f->itens[(f->inicio + f->qtd) % f->capacidade] = item;
+    f->qtd++;
+    pthread_cond_signal(&f->nao_vazia);
+    pthread_mutex_unlock(&f->trava);
+}
+
+void *fila_remover(Fila *f) {
+    pthread_mutex_lock(&f->trava);
+    while (f->qtd == 0) {
+        pthread_cond_wait(&f->nao_vazia, &f->trava);
+    }
+    void *item = f->itens[f->inicio];
+    f->inicio = (f->inicio + 1) % f->capacidade;
+    f->qtd--;
+    pthread_cond_signal(&f->nao_cheia);
+    pthread_mutex_unlock(&f->trava);
+    return item;
+}
+
+void fila_destruir(Fila *f) {
+    free(f->itens);
+    f->itens = NULL;
+    pthread_mutex_destroy(&f->trava);
+    pthread_cond_destroy(&f->nao_vazia);
+    pthread_cond_destroy(&f->nao_cheia);
+}
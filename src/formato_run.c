@@ -0,0 +1,400 @@
+// Para expor pread e fstat
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "formato_run.h"
+#include "compressao_lz.h"
+#include "registro.h"
+
+// ► Maior corpo de bloco, em bytes (registros codificados antes do LZ)
+#define BYTES_CORPO_BLOCO 16384
+// ► Maior registro codificado: chave (varint) + tamanho (varint) + pacote
+#define MAX_REGISTRO_CODIFICADO (10 + 5 + 250)
+// ► codec de um bloco: corpo guardado como está ou comprimido por LZ
+#define CODEC_DELTA 0u
+#define CODEC_LZ    1u
+
+/*
+ * ▪ CabecalhoBloco:
+ *   Antecede cada bloco de uma run comprimida; zerado (n_registros == 0)
+ *   no rodapé, que é seguido do total de registros da run.
+ */
+typedef struct {
+    uint32_t n_registros;     // ➔ registros no bloco (0 → rodapé)
+    uint32_t bytes_corpo;     // ➔ bytes do corpo decodificado
+    uint32_t bytes_gravados;  // ➔ bytes que seguem no arquivo
+    uint32_t codec;           // ➔ CODEC_DELTA ou CODEC_LZ
+} CabecalhoBloco;
+
+static CompressaoRun g_compressao = COMPRESSAO_NENHUMA;
+
+// Volume das runs comprimidas: registros inteiros × bytes gravados
+static uint64_t        g_bytes_registros = 0;
+static uint64_t        g_bytes_gravados  = 0;
+static pthread_mutex_t g_trava_contagem  = PTHREAD_MUTEX_INITIALIZER;
+
+void formato_run_definir(CompressaoRun compressao) {
+    g_compressao = compressao;
+}
+
+CompressaoRun formato_run_compressao(void) {
+    return g_compressao;
+}
+
+const char *formato_run_nome(CompressaoRun compressao) {
+    switch (compressao) {
+        case COMPRESSAO_DELTA: return "delta";
+        case COMPRESSAO_LZ:    return "lz";
+        default:               return "nenhuma";
+    }
+}
+
+size_t bytes_codec_por_run(bool escrita) {
+    if (g_compressao == COMPRESSAO_NENHUMA) return 0;
+    if (g_compressao == COMPRESSAO_DELTA) return BYTES_CORPO_BLOCO;
+    return 2 * BYTES_CORPO_BLOCO + (escrita ? TAM_TABELA_LZ * sizeof(uint16_t) : 0);
+}
+
+// ─────────────────────────────── Varints ───────────────────────────────
+
+static inline unsigned char *gravar_varint(unsigned char *d, uint64_t v) {
+    while (v >= 0x80) {
+        *d++ = (unsigned char) (v | 0x80);
+        v >>= 7;
+    }
+    *d++ = (unsigned char) v;
+    return d;
+}
+
+/*
+ * ➔ ler_varint:
+ *     Lê um varint de corpo[*pos, tam), avançando *pos.
+ *     return  0, ou -1 se o corpo acabar no meio ou o valor passar de 64 bits
+ */
+static inline int ler_varint(const unsigned char *corpo, size_t tam, size_t *pos, uint64_t *v) {
+    uint64_t valor = 0;
+    for (unsigned desloc = 0; desloc < 64; desloc += 7) {
+        if (*pos >= tam) return -1;
+        unsigned char b = corpo[(*pos)++];
+        valor |= (uint64_t) (b & 0x7F) << desloc;
+        if (!(b & 0x80)) {
+            *v = valor;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// ─────────────────────────────── Escrita ───────────────────────────────
+
+struct EscritorRun {
+    ArquivoMon    *arquivo;
+    size_t         tam_registro;
+    CompressaoRun  compressao;
+    unsigned char *corpo;       // ➔ registros codificados do bloco em montagem
+    size_t         no_corpo;    // ➔ bytes usados do corpo
+    uint32_t       no_bloco;    // ➔ registros no bloco em montagem
+    uint64_t       anterior;    // ➔ última chave do bloco (base do delta)
+    uint64_t       total;       // ➔ registros gravados na run
+    unsigned char *comprimido;  // ➔ saída do LZ (NULL sem LZ)
+    uint16_t      *tabela;      // ➔ tabela de hash do LZ (NULL sem LZ)
+    uint64_t       gravados;    // ➔ bytes gravados no arquivo
+    int            erro;        // ➔ alguma escrita falhou
+};
+
+EscritorRun *escritor_run_abrir(const char *nome, size_t tam_registro, CompressaoRun compressao) {
+    EscritorRun *e = calloc(1, sizeof(EscritorRun));
+    if (!e) return NULL;
+    e->tam_registro = tam_registro;
+    e->compressao   = compressao;
+    if (compressao != COMPRESSAO_NENHUMA) {
+        e->corpo = malloc(BYTES_CORPO_BLOCO);
+        if (compressao == COMPRESSAO_LZ) {
+            e->comprimido = malloc(BYTES_CORPO_BLOCO);
+            e->tabela     = malloc(TAM_TABELA_LZ * sizeof(uint16_t));
+        }
+        if (!e->corpo || (compressao == COMPRESSAO_LZ && (!e->comprimido || !e->tabela))) {
+            free(e->corpo);
+            free(e->comprimido);
+            free(e->tabela);
+            free(e);
+            errno = ENOMEM;
+            return NULL;
+        }
+    }
+    e->arquivo = mon_fopen_temporario(nome, "wb");
+    if (!e->arquivo) {
+        int erro = errno;
+        free(e->corpo);
+        free(e->comprimido);
+        free(e->tabela);
+        free(e);
+        errno = erro;
+        return NULL;
+    }
+    return e;
+}
+
+/*
+ * ➔ descarregar_bloco:
+ *     Grava o bloco em montagem (cabeçalho + corpo, comprimido se encolher)
+ *     e começa outro.
+ */
+static int descarregar_bloco(EscritorRun *e) {
+    if (e->no_bloco == 0) return 0;
+    CabecalhoBloco cab = { e->no_bloco, (uint32_t) e->no_corpo, (uint32_t) e->no_corpo,
+                           CODEC_DELTA };
+    const unsigned char *dados = e->corpo;
+    if (e->compressao == COMPRESSAO_LZ) {
+        size_t n = lz_comprimir(e->corpo, e->no_corpo, e->comprimido, e->no_corpo - 1,
+                                e->tabela);
+        if (n > 0) {
+            cab.bytes_gravados = (uint32_t) n;
+            cab.codec = CODEC_LZ;
+            dados = e->comprimido;
+        }
+    }
+    if (mon_fwrite(&cab, sizeof(cab), 1, e->arquivo) != 1 ||
+        mon_fwrite(dados, 1, cab.bytes_gravados, e->arquivo) != cab.bytes_gravados) {
+        e->erro = 1;
+    }
+    e->gravados += sizeof(cab) + cab.bytes_gravados;
+    e->no_corpo = 0;
+    e->no_bloco = 0;
+    e->anterior = 0;
+    return e->erro ? -1 : 0;
+}
+
+/*
+ * ➔ codificar_registro:
+ *     Acrescenta um registro ao corpo: delta da chave e, num RegistroDisco,
+ *     o tamanho e os bytes válidos do pacote; noutro formato, o resto do
+ *     registro como está.
+ */
+static void codificar_registro(EscritorRun *e, const unsigned char *registro) {
+    unsigned char *d = e->corpo + e->no_corpo;
+    uint64_t chave;
+    memcpy(&chave, registro, sizeof(chave));
+    d = gravar_varint(d, chave - e->anterior);
+    e->anterior = chave;
+
+    if (e->tam_registro == sizeof(RegistroDisco)) {
+        const RegistroDisco *r = (const RegistroDisco *) registro;
+        uint32_t tamanho;
+        memcpy(&tamanho, &r->tamanho, sizeof(tamanho));
+        size_t validos = tamanho < sizeof(r->pacote) ? tamanho : sizeof(r->pacote);
+        d = gravar_varint(d, tamanho);
+        memcpy(d, r->pacote, validos);
+        d += validos;
+    } else {
+        memcpy(d, registro + sizeof(chave), e->tam_registro - sizeof(chave));
+        d += e->tam_registro - sizeof(chave);
+    }
+    e->no_corpo = (size_t) (d - e->corpo);
+    e->no_bloco++;
+}
+
+int escritor_run_gravar(EscritorRun *e, const void *registros, size_t n) {
+    if (e->erro) return -1;
+    if (e->compressao == COMPRESSAO_NENHUMA) {
+        if (mon_fwrite(registros, e->tam_registro, n, e->arquivo) != n) e->erro = 1;
+        e->total += n;
+        return e->erro ? -1 : 0;
+    }
+
+    size_t maior = e->tam_registro == sizeof(RegistroDisco)
+                   ? MAX_REGISTRO_CODIFICADO : 10 + e->tam_registro - sizeof(uint64_t);
+    const unsigned char *r = registros;
+    for (size_t i = 0; i < n; i++, r += e->tam_registro) {
+        if (e->no_corpo + maior > BYTES_CORPO_BLOCO && descarregar_bloco(e) < 0) return -1;
+        codificar_registro(e, r);
+    }
+    e->total += n;
+    return 0;
+}
+
+int escritor_run_gravar_em(EscritorRun *e, const void *registros, size_t n, uint64_t posicao) {
+    if (e->compressao != COMPRESSAO_NENHUMA) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    size_t bytes = n * e->tam_registro;
+    return mon_pwrite(registros, bytes, posicao * e->tam_registro, e->arquivo) == bytes ? 0 : -1;
+}
+
+int escritor_run_fechar(EscritorRun *e) {
+    if (!e) return 0;
+    if (e->compressao != COMPRESSAO_NENHUMA && !e->erro && descarregar_bloco(e) == 0) {
+        CabecalhoBloco rodape = { 0, 0, 0, 0 };
+        if (mon_fwrite(&rodape, sizeof(rodape), 1, e->arquivo) != 1 ||
+            mon_fwrite(&e->total, sizeof(e->total), 1, e->arquivo) != 1) {
+            e->erro = 1;
+        }
+        pthread_mutex_lock(&g_trava_contagem);
+        g_bytes_registros += e->total * e->tam_registro;
+        g_bytes_gravados  += e->gravados + sizeof(rodape) + sizeof(e->total);
+        pthread_mutex_unlock(&g_trava_contagem);
+    }
+    int ret = e->erro ? -1 : 0;
+    if (mon_fclose(e->arquivo) != 0) ret = -1;
+    free(e->corpo);
+    free(e->comprimido);
+    free(e->tabela);
+    free(e);
+    return ret;
+}
+
+// ─────────────────────────────── Leitura ───────────────────────────────
+
+struct DecodificadorRun {
+    unsigned char *gravado;    // ➔ bloco como está no arquivo
+    unsigned char *descomp;    // ➔ corpo descomprimido (NULL sem LZ)
+    const unsigned char *corpo; // ➔ corpo do bloco atual (gravado ou descomp)
+    size_t         tam_corpo;  // ➔ bytes do corpo
+    size_t         pos;        // ➔ próximo registro no corpo
+    uint32_t       restantes;  // ➔ registros do bloco ainda não decodificados
+    uint64_t       anterior;   // ➔ última chave decodificada do bloco
+    bool           fim;        // ➔ rodapé lido
+};
+
+DecodificadorRun *decodificador_run_criar(void) {
+    DecodificadorRun *d = calloc(1, sizeof(DecodificadorRun));
+    if (!d) return NULL;
+    d->gravado = malloc(BYTES_CORPO_BLOCO);
+    if (g_compressao == COMPRESSAO_LZ) d->descomp = malloc(BYTES_CORPO_BLOCO);
+    if (!d->gravado || (g_compressao == COMPRESSAO_LZ && !d->descomp)) {
+        decodificador_run_destruir(d);
+        return NULL;
+    }
+    return d;
+}
+
+void decodificador_run_destruir(DecodificadorRun *d) {
+    if (!d) return;
+    free(d->gravado);
+    free(d->descomp);
+    free(d);
+}
+
+/*
+ * ➔ carregar_bloco:
+ *     Lê o próximo bloco (ou o rodapé) e descomprime-o se preciso.
+ *     return  0, ou o errno da falha (EIO em run corrompida ou truncada)
+ */
+static int carregar_bloco(DecodificadorRun *d, ArquivoMon *arquivo) {
+    CabecalhoBloco cab;
+    if (mon_fread(&cab, sizeof(cab), 1, arquivo) != 1) {
+        int erro = mon_erro_leitura(arquivo);
+        return erro ? erro : EIO;  // sem rodapé: run truncada
+    }
+    if (cab.n_registros == 0) {
+        d->fim = true;
+        return 0;
+    }
+    bool lz = cab.codec == CODEC_LZ;
+    if (cab.bytes_corpo > BYTES_CORPO_BLOCO || cab.bytes_gravados > BYTES_CORPO_BLOCO ||
+        (lz ? !d->descomp : (cab.codec != CODEC_DELTA || cab.bytes_gravados != cab.bytes_corpo))) {
+        return EIO;
+    }
+    if (mon_fread(d->gravado, 1, cab.bytes_gravados, arquivo) != cab.bytes_gravados) {
+        int erro = mon_erro_leitura(arquivo);
+        return erro ? erro : EIO;
+    }
+    if (lz && lz_descomprimir(d->gravado, cab.bytes_gravados, d->descomp, cab.bytes_corpo) < 0) {
+        return EIO;
+    }
+    d->corpo     = lz ? d->descomp : d->gravado;
+    d->tam_corpo = cab.bytes_corpo;
+    d->pos       = 0;
+    d->restantes = cab.n_registros;
+    d->anterior  = 0;
+    return 0;
+}
+
+/*
+ * ➔ decodificar_registro:
+ *     Reconstrói um registro inteiro a partir do corpo.
+ *     return  0, ou -1 se o corpo estiver corrompido
+ */
+static int decodificar_registro(DecodificadorRun *d, unsigned char *destino, size_t tam_registro) {
+    uint64_t delta;
+    if (ler_varint(d->corpo, d->tam_corpo, &d->pos, &delta) < 0) return -1;
+    d->anterior += delta;
+
+    if (tam_registro == sizeof(RegistroDisco)) {
+        RegistroDisco *r = (RegistroDisco *) destino;
+        uint64_t tamanho;
+        if (ler_varint(d->corpo, d->tam_corpo, &d->pos, &tamanho) < 0 || tamanho > UINT32_MAX) {
+            return -1;
+        }
+        size_t validos = tamanho < sizeof(r->pacote) ? (size_t) tamanho : sizeof(r->pacote);
+        if (validos > d->tam_corpo - d->pos) return -1;
+        memset(r, 0, sizeof(*r));
+        r->chave   = d->anterior;
+        r->tamanho = (uint32_t) tamanho;
+        memcpy(r->pacote, d->corpo + d->pos, validos);
+        d->pos += validos;
+    } else {
+        size_t resto = tam_registro - sizeof(uint64_t);
+        if (resto > d->tam_corpo - d->pos) return -1;
+        memcpy(destino, &d->anterior, sizeof(uint64_t));
+        memcpy(destino + sizeof(uint64_t), d->corpo + d->pos, resto);
+        d->pos += resto;
+    }
+    d->restantes--;
+    return 0;
+}
+
+size_t decodificador_run_ler(DecodificadorRun *d, ArquivoMon *arquivo, void *destino,
+                             size_t tam_registro, size_t n, int *erro) {
+    unsigned char *saida = destino;
+    size_t lidos = 0;
+    *erro = 0;
+    while (lidos < n && !d->fim) {
+        if (d->restantes == 0) {
+            *erro = carregar_bloco(d, arquivo);
+            if (*erro != 0) break;
+            continue;
+        }
+        if (decodificar_registro(d, saida + lidos * tam_registro, tam_registro) < 0) {
+            *erro = EIO;
+            break;
+        }
+        lidos++;
+    }
+    return lidos;
+}
+
+uint64_t registros_na_run(const char *nome, size_t tam_registro) {
+    struct stat st;
+    if (g_compressao == COMPRESSAO_NENHUMA) {
+        if (stat(nome, &st) != 0 || st.st_size < 0) return 0;
+        return (uint64_t) st.st_size / tam_registro;
+    }
+    // O total fica nos últimos 8 bytes, depois do cabeçalho zerado do rodapé
+    int fd = open(nome, O_RDONLY);
+    if (fd < 0) return 0;
+    uint64_t total = 0;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t) (sizeof(CabecalhoBloco) + sizeof(total)) ||
+        pread(fd, &total, sizeof(total), st.st_size - (off_t) sizeof(total))
+            != (ssize_t) sizeof(total)) {
+        total = 0;
+    }
+    close(fd);
+    return total;
+}
+
+void formato_run_log(void) {
+    if (g_compressao == COMPRESSAO_NENHUMA || g_bytes_registros == 0) return;
+    fprintf(stderr, "METRICA_COMPRESSAO_RUNS: %.2f MB -> %.2f MB (%.1f%%)\n",
+            (double) g_bytes_registros / (1024.0 * 1024.0),
+            (double) g_bytes_gravados / (1024.0 * 1024.0),
+            100.0 * (double) g_bytes_gravados / (double) g_bytes_registros);
+}
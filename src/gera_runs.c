@@ -0,0 +1,1074 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <pthread.h>
+#include "gera_runs.h"
+#include "ordena_chaves.h"
+#include "heap_minimo.h"
+#include "fila.h"
+#include "monitor.h"
+#include "planejador.h"
+#include "temporarios.h"
+#include "formato_run.h"
+
+/*
+ * ▪ EntradaFase1:
+ *   Arquivo de entrada da Fase 1: lido com mon_fread para os buffers de
+ *   quem lê ou, com --mmap, mapeado inteiro (mon_mmap) e entregue em
+ *   fatias do próprio mapeamento, sem cópia. Com --intervalo, quem lê por
+ *   proximos_filtrados recebe só os registros da faixa.
+ */
+typedef struct {
+    ArquivoMon          *arquivo;    // ➔ entrada lida por mon_fread (NULL com mmap)
+    const RegistroDisco *mapa;       // ➔ entrada mapeada (NULL sem --mmap)
+    size_t               bytes_mapa; // ➔ bytes mapeados
+    uint64_t             n_mapa;     // ➔ registros inteiros no mapeamento
+    uint64_t             proximo;    // ➔ próximo registro do mapeamento a entregar
+    bool                 filtrar;    // ➔ --intervalo: descarta chaves fora da faixa
+    uint64_t             chave_inicial, chave_final;
+    uint64_t             descartados; // ➔ registros fora da faixa (só a leitora conta)
+} EntradaFase1;
+
+/*
+ * ➔ na_faixa:
+ *     true se a chave está na faixa de --intervalo (ou não há faixa).
+ */
+static inline bool na_faixa(const EntradaFase1 *e, uint64_t chave) {
+    return !e->filtrar || (chave >= e->chave_inicial && chave <= e->chave_final);
+}
+
+/*
+ * ➔ proximos_registros:
+ *     Entrega até “capacidade” registros sem passar de “restantes”
+ *     (registros que ainda podem ser lidos da entrada), que é descontado.
+ *     Com a entrada mapeada, *registros aponta para o próprio mapeamento
+ *     e a fatia seguinte, do mesmo tamanho, é antecipada; senão, os
+ *     registros são lidos com mon_fread em “buffer”.
+ */
+static size_t proximos_registros(EntradaFase1 *e, RegistroDisco *buffer, size_t capacidade,
+                                 uint64_t *restantes, const RegistroDisco **registros) {
+    if (capacidade > *restantes) capacidade = (size_t) *restantes;
+    size_t lidos;
+    if (e->mapa) {
+        uint64_t disponiveis = e->n_mapa - e->proximo;
+        lidos = capacidade < disponiveis ? capacidade : (size_t) disponiveis;
+        *registros = e->mapa + e->proximo;
+        e->proximo += lidos;
+        mon_contar_bytes_lidos(lidos * sizeof(RegistroDisco));
+        mon_mmap_antecipar(e->mapa, e->bytes_mapa, e->proximo * sizeof(RegistroDisco),
+                           lidos * sizeof(RegistroDisco));
+    } else {
+        lidos = capacidade > 0
+                ? mon_fread(buffer, sizeof(RegistroDisco), capacidade, e->arquivo) : 0;
+        *registros = buffer;
+    }
+    *restantes -= lidos;
+    return lidos;
+}
+
+/*
+ * ➔ devolver_registros:
+ *     Com a entrada mapeada, tira do processo as páginas dos n registros
+ *     já consumidos (mon_mmap_descartar), para que o RSS fique nos blocos
+ *     em uso em vez de crescer até o tamanho da entrada. Registros fora
+ *     do mapeamento (as cópias de proximos_filtrados) não têm o que
+ *     devolver.
+ */
+static void devolver_registros(const EntradaFase1 *e, const RegistroDisco *registros, size_t n) {
+    if (!e->mapa || n == 0 || registros < e->mapa || registros >= e->mapa + e->n_mapa) return;
+    mon_mmap_descartar(e->mapa, e->bytes_mapa,
+                       (size_t) (registros - e->mapa) * sizeof(RegistroDisco),
+                       n * sizeof(RegistroDisco));
+}
+
+/*
+ * ➔ proximos_filtrados:
+ *     Como proximos_registros, mas com --intervalo entrega só registros da
+ *     faixa, sempre copiados para “buffer” (compactados no próprio buffer,
+ *     ou tirados do mapeamento, cujas páginas lidas já são devolvidas),
+ *     lendo até juntar “capacidade” deles ou a entrada acabar. Os de fora
+ *     são descartados antes de qualquer ordenação.
+ */
+static size_t proximos_filtrados(EntradaFase1 *e, RegistroDisco *buffer, size_t capacidade,
+                                 uint64_t *restantes, const RegistroDisco **registros) {
+    if (!e->filtrar) return proximos_registros(e, buffer, capacidade, restantes, registros);
+    size_t n = 0;
+    while (n < capacidade && *restantes > 0) {
+        size_t pedir = capacidade - n;
+        const RegistroDisco *lidos_em;
+        size_t lidos = proximos_registros(e, buffer + n, pedir, restantes, &lidos_em);
+        for (size_t i = 0; i < lidos; i++) {
+            if (na_faixa(e, lidos_em[i].chave)) {
+                buffer[n++] = lidos_em[i];
+            } else {
+                e->descartados++;
+            }
+        }
+        devolver_registros(e, lidos_em, lidos);
+        if (lidos < pedir) break;  // fim de arquivo
+    }
+    *registros = buffer;
+    return n;
+}
+
+/*
+ * ➔ com_buffer_proprio:
+ *     Os blocos precisam do próprio vetor de registros sem o mapeamento
+ *     ou com --intervalo, que copia para eles só os registros da faixa.
+ */
+static bool com_buffer_proprio(const EntradaFase1 *e) {
+    return !e->mapa || e->filtrar;
+}
+
+/*
+ * ▪ BlocoFase1:
+ *   Buffer de trabalho de um bloco da Fase 1 (registros lidos, pares a
+ *   ordenar e vetor auxiliar do radix sort), mais o número da run que ele
+ *   vai originar. Com a entrada mapeada, “registros” não é alocado e
+ *   “dados” aponta para a fatia do mapeamento.
+ */
+typedef struct {
+    RegistroDisco *registros;  // ➔ registros lidos da entrada (NULL com mmap)
+    const RegistroDisco *dados; // ➔ registros do bloco: “registros” ou o mapeamento
+    ParChave      *pares;      // ➔ pares (chave, índice) ordenados
+    ParChave      *aux;        // ➔ auxiliar do radix (NULL nos outros modos)
+    size_t         capacidade; // ➔ registros que cabem no bloco
+    size_t         lidos;      // ➔ registros válidos no bloco
+    size_t         id_run;     // ➔ número da run (run_%05zu.bin)
+    double         t_ordenacao; // ➔ tempo acumulado ordenando (s)
+    double         t_escrita;   // ➔ tempo acumulado gravando runs (s)
+} BlocoFase1;
+
+/*
+ * ➔ aloca_bloco / libera_bloco:
+ *     Reserva (ou libera) os vetores de um BlocoFase1 com capacidade
+ *     para “capacidade” registros (sem o de registros, se “mapeada”).
+ */
+static int aloca_bloco(BlocoFase1 *b, size_t capacidade, MetodoOrdenacao metodo, bool mapeada) {
+    b->registros  = mapeada ? NULL : malloc(capacidade * sizeof(RegistroDisco));
+    b->dados      = b->registros;
+    b->pares      = malloc(capacidade * sizeof(ParChave));
+    b->aux        = (metodo == ORDENACAO_RADIX) ? malloc(capacidade * sizeof(ParChave)) : NULL;
+    b->capacidade = capacidade;
+    b->lidos      = 0;
+    b->id_run     = 0;
+    b->t_ordenacao = 0.0;
+    b->t_escrita   = 0.0;
+    if ((!mapeada && !b->registros) || !b->pares || (metodo == ORDENACAO_RADIX && !b->aux)) {
+        return -1;
+    }
+    return 0;
+}
+
+static void libera_bloco(BlocoFase1 *b) {
+    free(b->registros);
+    free(b->pares);
+    free(b->aux);
+    b->registros = NULL;
+    b->pares = NULL;
+    b->aux = NULL;
+}
+
+/*
+ * ➔ ordenar:
+ *     Ordena os pares do bloco com o método escolhido em --ordenacao.
+ *     Os tempos ficam no próprio bloco: ele só é tocado por uma thread de
+ *     cada vez, então não há necessidade de trava.
+ */
+static void ordenar(BlocoFase1 *b, const Opcoes *op) {
+    double t0 = mon_agora();
+    if (b->dados == b->registros) {
+        ordenar_bloco(b->registros, b->lidos, b->pares, b->aux, op->ordenacao, op->bits_radix);
+    } else {
+        // Fatia da entrada mapeada (somente leitura): só os pares se movem
+        ordenar_pares_bloco(b->dados, b->lidos, b->pares, b->aux, op->ordenacao, op->bits_radix);
+    }
+    b->t_ordenacao += mon_agora() - t0;
+}
+
+/*
+ * ➔ gravar:
+ *     Grava a run correspondente ao bloco (run_<id_run>.bin), copiando
+ *     cada registro uma única vez, e devolve as páginas do bloco se ele
+ *     veio da entrada mapeada. Com --limite K, só os K primeiros pares
+ *     vão para a run: os demais nunca chegariam à saída.
+ *
+ * return  0 em sucesso, -1 em falha (mensagem já impressa)
+ */
+static int gravar(BlocoFase1 *b, const Opcoes *op, const EntradaFase1 *entrada) {
+    double t0 = mon_agora();
+    char nome_run[TAM_NOME_TEMPORARIO];
+    nome_temporario(nome_run, sizeof(nome_run), "run", b->id_run);
+    EscritorRun *saida_run = escritor_run_abrir(nome_run, sizeof(RegistroDisco),
+                                                formato_run_compressao());
+    if (!saida_run) {
+        perror("❌ Erro ao criar run temporário");
+        return -1;
+    }
+    size_t n = b->lidos;
+    if (op->limite_registros && n > op->limite_registros) n = op->limite_registros;
+    bool ok = gravar_registros_ordenados(b->dados, b->pares, n, saida_run) == n;
+    if (escritor_run_fechar(saida_run) != 0) ok = false;
+    devolver_registros(entrada, b->dados, b->lidos);
+    if (!ok) {
+        perror("❌ Erro ao escrever run temporário");
+        return -1;
+    }
+    b->t_escrita += mon_agora() - t0;
+    return 0;
+}
+
+/*
+ * ➔ orcamento_fase1:
+ *     max_blocos menos os buffers próprios do backend de I/O (ex.: os
+ *     blocos em voo do io_uring) da entrada e das runs gravadas ao mesmo
+ *     tempo, mais os do codec das runs comprimidas, descontados no máximo
+ *     até a metade do orçamento.
+ */
+static size_t orcamento_fase1(const Opcoes *op) {
+    bool por_blocos = !op->somente_chaves && op->geracao != GERACAO_SELECAO;
+    size_t gravadores = (por_blocos && op->threads > 1 && !op->pipeline) ? op->threads : 1;
+    size_t bytes = mon_buffer_por_arquivo(false, false) +
+                   gravadores * (mon_buffer_por_arquivo(true, true) + bytes_codec_por_run(true));
+    size_t registros = (bytes + sizeof(RegistroDisco) - 1) / sizeof(RegistroDisco);
+    if (registros > op->max_blocos / 2) registros = op->max_blocos / 2;
+    return op->max_blocos - registros;
+}
+
+/*
+ * ➔ gerar_runs_serial:
+ *     Um único buffer de max_blocos registros: lê, ordena e grava.
+ */
+static int gerar_runs_serial(const Opcoes *op, EntradaFase1 *entrada, uint64_t limite,
+                             size_t *contagem_runs) {
+    BlocoFase1 bloco;
+    if (aloca_bloco(&bloco, orcamento_fase1(op), op->ordenacao,
+                    !com_buffer_proprio(entrada)) < 0) {
+        perror("❌ Falha no malloc do buffer");
+        libera_bloco(&bloco);
+        return -1;
+    }
+
+    int ret = 0;
+    double t_leitura = 0.0;
+    while (1) {
+        // Lê no máximo max_blocos registros de uma vez
+        double t0 = mon_agora();
+        bloco.lidos = proximos_filtrados(entrada, bloco.registros, bloco.capacidade, &limite,
+                                         &bloco.dados);
+        t_leitura += mon_agora() - t0;
+        if (bloco.lidos == 0) break;  // fim de arquivo
+
+        bloco.id_run = *contagem_runs;
+        ordenar(&bloco, op);
+        if (gravar(&bloco, op, entrada) < 0) {
+            ret = -1;
+            break;
+        }
+        (*contagem_runs)++;
+    }
+
+    mon_registrar_estagios(t_leitura, bloco.t_ordenacao, bloco.t_escrita);
+    libera_bloco(&bloco);
+    return ret;
+}
+
+/*
+ * ▪ PoolFase1:
+ *   Estado compartilhado entre a thread leitora (principal), as threads
+ *   de ordenação e, no modo pipeline, a thread gravadora.
+ *
+ *   Sem pipeline:  leitora → [prontos] → ordena+grava → [livres] → leitora
+ *   Com pipeline:  leitora → [prontos] → ordena → [a_gravar] → grava
+ *                  → [livres] → leitora
+ */
+typedef struct {
+    const Opcoes   *op;
+    const EntradaFase1 *entrada; // ➔ entrada (páginas devolvidas após gravar)
+    Fila            prontos;   // ➔ blocos lidos aguardando ordenação (NULL = fim)
+    Fila            a_gravar;  // ➔ blocos ordenados aguardando gravação (pipeline)
+    Fila            livres;    // ➔ blocos disponíveis para a próxima leitura
+    bool            pipeline;  // ➔ true se a gravação tem thread própria
+    int             erro;      // ➔ 1 se alguma thread falhou
+    pthread_mutex_t trava_erro;
+} PoolFase1;
+
+static void marca_erro(PoolFase1 *pool) {
+    pthread_mutex_lock(&pool->trava_erro);
+    pool->erro = 1;
+    pthread_mutex_unlock(&pool->trava_erro);
+}
+
+static int teve_erro(PoolFase1 *pool) {
+    pthread_mutex_lock(&pool->trava_erro);
+    int e = pool->erro;
+    pthread_mutex_unlock(&pool->trava_erro);
+    return e;
+}
+
+/*
+ * ➔ ordenadora_fase1:
+ *     Laço de uma thread de ordenação: retira um bloco lido e o ordena.
+ *     No modo pipeline entrega o bloco à thread gravadora; caso contrário
+ *     grava a run ela mesma e devolve o bloco à fila de livres.
+ *     Termina ao receber NULL.
+ */
+static void *ordenadora_fase1(void *arg) {
+    PoolFase1 *pool = arg;
+    BlocoFase1 *b;
+    while ((b = fila_remover(&pool->prontos)) != NULL) {
+        ordenar(b, pool->op);
+        if (pool->pipeline) {
+            fila_inserir(&pool->a_gravar, b);
+            continue;
+        }
+        if (gravar(b, pool->op, pool->entrada) < 0) marca_erro(pool);
+        fila_inserir(&pool->livres, b);
+    }
+    return NULL;
+}
+
+/*
+ * ➔ gravadora_fase1:
+ *     Thread de escrita do modo pipeline: grava cada bloco ordenado e o
+ *     devolve à fila de livres. Depois de um erro continua só reciclando
+ *     os blocos, para que as outras threads não fiquem bloqueadas.
+ */
+static void *gravadora_fase1(void *arg) {
+    PoolFase1 *pool = arg;
+    BlocoFase1 *b;
+    while ((b = fila_remover(&pool->a_gravar)) != NULL) {
+        if (!teve_erro(pool) && gravar(b, pool->op, pool->entrada) < 0) marca_erro(pool);
+        fila_inserir(&pool->livres, b);
+    }
+    return NULL;
+}
+
+/*
+ * ➔ capacidade_bloco:
+ *     Registros por bloco da Fase 1 nos modos por blocos: o orçamento
+ *     inteiro no serial; dividido entre os buffers em rotação no paralelo.
+ */
+static size_t capacidade_bloco(const Opcoes *op) {
+    if (op->threads <= 1 && !op->pipeline) return orcamento_fase1(op);
+    size_t n_blocos = op->pipeline ? op->threads + 2 : op->threads;
+    size_t capacidade = orcamento_fase1(op) / n_blocos;
+    return capacidade > 0 ? capacidade : 1;
+}
+
+/*
+ * ➔ gerar_runs_paralelo:
+ *     Divide o orçamento de max_blocos registros entre os buffers em
+ *     rotação: N (um por thread de ordenação) ou, no modo pipeline, N + 2,
+ *     para que o bloco i+1 seja lido e o bloco i-1 gravado enquanto o
+ *     bloco i é ordenado. A thread principal lê em sequência e fixa o
+ *     número de cada run, então a numeração continua determinística.
+ */
+static int gerar_runs_paralelo(const Opcoes *op, EntradaFase1 *entrada, uint64_t limite,
+                               size_t *contagem_runs) {
+    size_t n_threads = op->threads;
+    size_t n_blocos  = op->pipeline ? n_threads + 2 : n_threads;
+    size_t capacidade = capacidade_bloco(op);
+
+    BlocoFase1 *blocos = calloc(n_blocos, sizeof(BlocoFase1));
+    pthread_t  *threads = calloc(n_threads, sizeof(pthread_t));
+    PoolFase1 pool = { .op = op, .entrada = entrada, .pipeline = op->pipeline, .erro = 0 };
+    if (!blocos || !threads) {
+        perror("❌ Falha no malloc do pool da Fase 1");
+        free(blocos);
+        free(threads);
+        return -1;
+    }
+    int ret = 0;
+    if (fila_inicializar(&pool.prontos, n_blocos) < 0) ret = -1;
+    if (fila_inicializar(&pool.a_gravar, n_blocos) < 0) ret = -1;
+    if (fila_inicializar(&pool.livres, n_blocos) < 0) ret = -1;
+    pthread_mutex_init(&pool.trava_erro, NULL);
+    if (ret < 0) perror("❌ Falha no malloc do pool da Fase 1");
+
+    for (size_t i = 0; ret == 0 && i < n_blocos; i++) {
+        if (aloca_bloco(&blocos[i], capacidade, op->ordenacao,
+                        !com_buffer_proprio(entrada)) < 0) {
+            perror("❌ Falha no malloc do buffer");
+            ret = -1;
+            break;
+        }
+        fila_inserir(&pool.livres, &blocos[i]);
+    }
+
+    size_t criadas = 0;
+    pthread_t gravadora;
+    bool tem_gravadora = false;
+    if (ret == 0 && op->pipeline) {
+        if (pthread_create(&gravadora, NULL, gravadora_fase1, &pool) != 0) {
+            fprintf(stderr, "❌ Falha ao criar thread gravadora da Fase 1\n");
+            ret = -1;
+        } else {
+            tem_gravadora = true;
+        }
+    }
+    if (ret == 0) {
+        for (; criadas < n_threads; criadas++) {
+            if (pthread_create(&threads[criadas], NULL, ordenadora_fase1, &pool) != 0) {
+                fprintf(stderr, "❌ Falha ao criar thread da Fase 1\n");
+                ret = -1;
+                break;
+            }
+        }
+    }
+
+    // Thread leitora: lê blocos na ordem do arquivo e numera as runs
+    double t_leitura = 0.0;
+    while (ret == 0) {
+        BlocoFase1 *b = fila_remover(&pool.livres);
+        if (teve_erro(&pool)) {
+            fila_inserir(&pool.livres, b);
+            break;
+        }
+
+        double t0 = mon_agora();
+        b->lidos = proximos_filtrados(entrada, b->registros, b->capacidade, &limite, &b->dados);
+        t_leitura += mon_agora() - t0;
+        if (b->lidos == 0) {
+            fila_inserir(&pool.livres, b);
+            break;  // fim de arquivo
+        }
+        b->id_run = (*contagem_runs)++;
+        fila_inserir(&pool.prontos, b);
+    }
+
+    // Sinaliza término às ordenadoras e, depois delas, à gravadora
+    for (size_t i = 0; i < criadas; i++) {
+        fila_inserir(&pool.prontos, NULL);
+    }
+    for (size_t i = 0; i < criadas; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    if (tem_gravadora) {
+        fila_inserir(&pool.a_gravar, NULL);
+        pthread_join(gravadora, NULL);
+    }
+    if (pool.erro) ret = -1;
+
+    double t_ordenacao = 0.0, t_escrita = 0.0;
+    for (size_t i = 0; i < n_blocos; i++) {
+        t_ordenacao += blocos[i].t_ordenacao;
+        t_escrita   += blocos[i].t_escrita;
+        libera_bloco(&blocos[i]);
+    }
+    mon_registrar_estagios(t_leitura, t_ordenacao, t_escrita);
+
+    pthread_mutex_destroy(&pool.trava_erro);
+    fila_destruir(&pool.prontos);
+    fila_destruir(&pool.a_gravar);
+    fila_destruir(&pool.livres);
+    free(blocos);
+    free(threads);
+    return ret;
+}
+
+// ► Registros lidos da entrada / juntados para gravação por vez na seleção
+#define REGISTROS_POR_LOTE 256
+
+/*
+ * ▪ LoteSelecao:
+ *   Pequenos buffers de entrada e de saída da seleção por substituição,
+ *   para que o heap receba e entregue um registro de cada vez sem uma
+ *   chamada de mon_fread/escritor_run_gravar por registro.
+ */
+typedef struct {
+    EntradaFase1  *entrada;
+    uint64_t       restantes;  // ➔ registros que ainda podem ser lidos
+    RegistroDisco  ent[REGISTROS_POR_LOTE];
+    const RegistroDisco *ent_dados; // ➔ “ent” ou o lote no mapeamento
+    size_t         ent_qtd, ent_pos;
+    RegistroDisco  sai[REGISTROS_POR_LOTE];
+    size_t         sai_qtd;
+    double         t_leitura, t_escrita;
+} LoteSelecao;
+
+/*
+ * ➔ proximo_registro:
+ *     Entrega o próximo registro da entrada em *r.
+ *     return  true se havia registro, false no fim do arquivo
+ */
+static bool proximo_registro(LoteSelecao *l, RegistroDisco *r) {
+    if (l->ent_pos == l->ent_qtd) {
+        devolver_registros(l->entrada, l->ent_dados, l->ent_qtd);
+        double t0 = mon_agora();
+        l->ent_qtd = proximos_filtrados(l->entrada, l->ent, REGISTROS_POR_LOTE, &l->restantes,
+                                        &l->ent_dados);
+        l->t_leitura += mon_agora() - t0;
+        l->ent_pos = 0;
+        if (l->ent_qtd == 0) return false;
+    }
+    *r = l->ent_dados[l->ent_pos++];
+    return true;
+}
+
+/*
+ * ➔ descarregar_saida / emitir_registro:
+ *     Junta registros da run atual e grava-os em lotes.
+ *     return  0 em sucesso, -1 em falha de escrita
+ */
+static int descarregar_saida(LoteSelecao *l, EscritorRun *run) {
+    if (l->sai_qtd == 0) return 0;
+    double t0 = mon_agora();
+    int ret = escritor_run_gravar(run, l->sai, l->sai_qtd);
+    l->t_escrita += mon_agora() - t0;
+    l->sai_qtd = 0;
+    return ret;
+}
+
+static int emitir_registro(LoteSelecao *l, EscritorRun *run, const RegistroDisco *r) {
+    l->sai[l->sai_qtd++] = *r;
+    if (l->sai_qtd == REGISTROS_POR_LOTE) return descarregar_saida(l, run);
+    return 0;
+}
+
+/*
+ * ➔ gerar_runs_selecao:
+ *     Seleção por substituição (“snow-plow”) com o min-heap de heap_minimo.
+ *     O vetor de max_blocos nós guarda, em [0, h), o heap da run atual e,
+ *     em [h, total), os registros que já ficaram para a próxima run (chave
+ *     menor que a última gravada). A cada registro gravado:
+ *       • se o novo registro da entrada pode continuar a run, ele ocupa a
+ *         raiz e desce no heap;
+ *       • senão, o último nó do heap vai para a raiz, o heap encolhe e o
+ *         novo registro ocupa a posição liberada no fim (próxima run).
+ *     Quando o heap esvazia, a run é fechada e a região pendente vira o
+ *     novo heap. Em dados aleatórios as runs têm ~2·max_blocos registros;
+ *     em dados quase ordenados sai uma única run.
+ */
+static int gerar_runs_selecao(const Opcoes *op, EntradaFase1 *entrada, uint64_t limite,
+                              size_t *contagem_runs) {
+    size_t capacidade = orcamento_fase1(op);
+    NoHeap *heap = malloc(capacidade * sizeof(NoHeap));
+    LoteSelecao *lote = calloc(1, sizeof(LoteSelecao));
+    if (!heap || !lote) {
+        perror("❌ Falha no malloc do heap da seleção por substituição");
+        free(heap);
+        free(lote);
+        return -1;
+    }
+    lote->entrada = entrada;
+    lote->restantes = limite;
+    double t_inicio = mon_agora();
+
+    // Carga inicial: até max_blocos registros
+    size_t total = 0;
+    while (total < capacidade && proximo_registro(lote, &heap[total].registro)) {
+        heap[total].id_run = 0;
+        total++;
+    }
+
+    int ret = 0;
+    while (total > 0 && ret == 0) {
+        // A região pendente (ou a carga inicial) vira o heap da nova run
+        size_t h = total;
+        for (size_t i = h / 2; i-- > 0; ) {
+            descer_heap(heap, h, i);
+        }
+
+        char nome_run[TAM_NOME_TEMPORARIO];
+        nome_temporario(nome_run, sizeof(nome_run), "run", *contagem_runs);
+        EscritorRun *saida_run = escritor_run_abrir(nome_run, sizeof(RegistroDisco),
+                                                    formato_run_compressao());
+        if (!saida_run) {
+            perror("❌ Erro ao criar run temporário");
+            ret = -1;
+            break;
+        }
+
+        // Com --limite K, a run guarda só os K primeiros; o heap continua
+        // girando para que os demais fiquem fora dela
+        uint64_t na_run = 0;
+        uint64_t maximo = op->limite_registros ? op->limite_registros : UINT64_MAX;
+        while (h > 0) {
+            uint64_t ultima = heap[0].registro.chave;
+            if (na_run++ < maximo && emitir_registro(lote, saida_run, &heap[0].registro) < 0) {
+                ret = -1;
+                break;
+            }
+
+            RegistroDisco novo;
+            if (proximo_registro(lote, &novo)) {
+                if (novo.chave >= ultima) {
+                    // Continua a run atual
+                    heap[0].registro = novo;
+                } else {
+                    // Fica para a próxima run: ocupa o fim do heap
+                    heap[0] = heap[h - 1];
+                    heap[h - 1].registro = novo;
+                    h--;
+                }
+            } else {
+                // Fim da entrada: o heap encolhe e o último pendente
+                // preenche o buraco entre o heap e a região pendente
+                heap[0] = heap[h - 1];
+                h--;
+                if (total - 1 > h) {
+                    heap[h] = heap[total - 1];
+                }
+                total--;
+            }
+            if (h > 0) descer_heap(heap, h, 0);
+        }
+
+        if (ret == 0 && descarregar_saida(lote, saida_run) < 0) ret = -1;
+        if (escritor_run_fechar(saida_run) != 0) ret = -1;
+        if (ret < 0) perror("❌ Erro ao escrever run temporário");
+        (*contagem_runs)++;
+    }
+
+    double t_total = mon_agora() - t_inicio;
+    mon_registrar_estagios(lote->t_leitura,
+                           t_total - lote->t_leitura - lote->t_escrita,
+                           lote->t_escrita);
+    free(heap);
+    free(lote);
+    return ret;
+}
+
+/*
+ * ➔ gerar_runs_chaves:
+ *     Modo --somente-chaves: o payload nunca entra nas runs. A entrada é
+ *     lida em lotes de REGISTROS_POR_LOTE registros (com --mmap, as chaves
+ *     são tiradas direto do mapeamento) e só o par (chave, número do
+ *     registro) de cada um é guardado. Como um par ocupa 16
+ *     bytes (32 com o auxiliar do radix) em vez de 264, o mesmo orçamento
+ *     de max_blocos registros comporta ~8–16× mais chaves por run. Cada
+ *     run é gravada como EntradaChave { chave, offset no .vet }.
+ */
+static int gerar_runs_chaves(const Opcoes *op, EntradaFase1 *entrada, uint64_t limite,
+                             size_t *contagem_runs) {
+    bool radix = (op->ordenacao == ORDENACAO_RADIX);
+    size_t por_chave = sizeof(ParChave) * (radix ? 2 : 1);
+    size_t capacidade = orcamento_fase1(op) * sizeof(RegistroDisco) / por_chave;
+    if (capacidade == 0) capacidade = 1;
+
+    ParChave *pares = malloc(capacidade * sizeof(ParChave));
+    ParChave *aux = radix ? malloc(capacidade * sizeof(ParChave)) : NULL;
+    RegistroDisco *lote = malloc(REGISTROS_POR_LOTE * sizeof(RegistroDisco));
+    if (!pares || (radix && !aux) || !lote) {
+        perror("❌ Falha no malloc do buffer de chaves");
+        free(pares);
+        free(aux);
+        free(lote);
+        return -1;
+    }
+
+    int ret = 0;
+    size_t proximo_indice = 0;
+    double t_leitura = 0.0, t_ordenacao = 0.0, t_escrita = 0.0;
+    bool fim = false;
+    while (!fim) {
+        // Junta até “capacidade” chaves, lendo a entrada em lotes
+        size_t n = 0;
+        double t0 = mon_agora();
+        while (n < capacidade) {
+            size_t pedir = capacidade - n;
+            if (pedir > REGISTROS_POR_LOTE) pedir = REGISTROS_POR_LOTE;
+            const RegistroDisco *registros;
+            // O filtro de --intervalo fica aqui, e não em proximos_filtrados:
+            // o par precisa do número do registro na entrada
+            size_t lidos = proximos_registros(entrada, lote, pedir, &limite, &registros);
+            for (size_t i = 0; i < lidos; i++, proximo_indice++) {
+                if (!na_faixa(entrada, registros[i].chave)) {
+                    entrada->descartados++;
+                    continue;
+                }
+                pares[n].chave  = registros[i].chave;
+                pares[n].indice = proximo_indice;
+                n++;
+            }
+            devolver_registros(entrada, registros, lidos);
+            if (lidos < pedir) {
+                fim = true;
+                break;
+            }
+        }
+        t_leitura += mon_agora() - t0;
+        if (n == 0) break;
+
+        // O quicksort original move registros inteiros: aqui vale o introsort
+        t0 = mon_agora();
+        if (radix) {
+            radix_pares(pares, aux, n, op->bits_radix);
+        } else {
+            introsort_pares(pares, n);
+        }
+        t_ordenacao += mon_agora() - t0;
+
+        t0 = mon_agora();
+        char nome_run[TAM_NOME_TEMPORARIO];
+        nome_temporario(nome_run, sizeof(nome_run), "run", *contagem_runs);
+        EscritorRun *saida_run = escritor_run_abrir(nome_run, sizeof(EntradaChave),
+                                                    formato_run_compressao());
+        if (!saida_run) {
+            perror("❌ Erro ao criar run temporário");
+            ret = -1;
+            break;
+        }
+        if (op->limite_registros && n > op->limite_registros) n = op->limite_registros;
+        if (gravar_chaves_ordenadas(pares, n, saida_run) != n) {
+            perror("❌ Erro ao escrever run temporário");
+            ret = -1;
+        }
+        if (escritor_run_fechar(saida_run) != 0) ret = -1;
+        t_escrita += mon_agora() - t0;
+        if (ret < 0) break;
+        (*contagem_runs)++;
+    }
+
+    mon_registrar_estagios(t_leitura, t_ordenacao, t_escrita);
+    free(pares);
+    free(aux);
+    free(lote);
+    return ret;
+}
+
+/*
+ * ▪ NoTopo:
+ *   Nó do max-heap de --limite: a chave e o número do registro na entrada
+ *   (o desempate da ordem estável) e o lugar dele no vetor de registros,
+ *   que não se move enquanto o heap é refeito.
+ */
+typedef struct {
+    uint64_t chave;
+    uint64_t posicao;  // ➔ número do registro na entrada
+    size_t   slot;     // ➔ índice do registro em RunMemoria.registros
+} NoTopo;
+
+/*
+ * ➔ topo_maior / descer_topo:
+ *     Ordem do max-heap por (chave, posição) e a descida de um nó.
+ */
+static inline bool topo_maior(const NoTopo *a, const NoTopo *b) {
+    if (a->chave != b->chave) return a->chave > b->chave;
+    return a->posicao > b->posicao;
+}
+
+static void descer_topo(NoTopo *v, size_t n, size_t i) {
+    NoTopo x = v[i];
+    while (1) {
+        size_t filho = 2 * i + 1;
+        if (filho >= n) break;
+        if (filho + 1 < n && topo_maior(&v[filho + 1], &v[filho])) filho++;
+        if (!topo_maior(&v[filho], &x)) break;
+        v[i] = v[filho];
+        i = filho;
+    }
+    v[i] = x;
+}
+
+/*
+ * ➔ maximo_heap_topo:
+ *     Maior K de --limite cujo heap (registro, nó e par de cada um) cabe,
+ *     com o lote de leitura, no orçamento da Fase 1.
+ */
+static size_t maximo_heap_topo(const Opcoes *op) {
+    size_t orcamento = orcamento_fase1(op);
+    if (orcamento <= REGISTROS_POR_LOTE) return 0;
+    return (orcamento - REGISTROS_POR_LOTE) * sizeof(RegistroDisco) /
+           (sizeof(RegistroDisco) + sizeof(NoTopo) + sizeof(ParChave));
+}
+
+/*
+ * ➔ selecionar_menores:
+ *     --limite K com K pequeno: uma única passagem pela entrada (em lotes
+ *     de REGISTROS_POR_LOTE, ou direto do mapeamento) mantém os K primeiros
+ *     registros da ordem estável num max-heap de K nós. Um registro só
+ *     entra se a chave for menor que a da raiz, o maior dos K guardados,
+ *     cujo lugar ele ocupa (no empate, o mais antigo fica); em dados
+ *     aleatórios isso acontece ~K·ln(N/K) vezes. No fim, o heap é
+ *     desmontado em ordem e os registros permutados no lugar: nenhuma run
+ *     é gravada e o resultado é a RunMemoria da entrada inteira.
+ *
+ * return  0 em sucesso, -1 em falha (mensagem já impressa)
+ */
+static int selecionar_menores(const Opcoes *op, EntradaFase1 *entrada, uint64_t limite,
+                              RunMemoria *run) {
+    size_t k = op->limite_registros;
+    run->registros = malloc(k * sizeof(RegistroDisco));
+    NoTopo *heap = malloc(k * sizeof(NoTopo));
+    RegistroDisco *lote = malloc(REGISTROS_POR_LOTE * sizeof(RegistroDisco));
+    if (!run->registros || !heap || !lote) {
+        perror("❌ Falha no malloc do heap de --limite");
+        free(heap);
+        free(lote);
+        liberar_run_memoria(run);
+        return -1;
+    }
+
+    double t_inicio = mon_agora(), t_leitura = 0.0;
+    size_t n = 0;
+    uint64_t posicao = 0;
+    while (1) {
+        double t0 = mon_agora();
+        const RegistroDisco *registros;
+        size_t lidos = proximos_registros(entrada, lote, REGISTROS_POR_LOTE, &limite, &registros);
+        t_leitura += mon_agora() - t0;
+        for (size_t i = 0; i < lidos; i++, posicao++) {
+            uint64_t chave = registros[i].chave;
+            if (!na_faixa(entrada, chave)) {
+                entrada->descartados++;
+            } else if (n < k) {
+                run->registros[n] = registros[i];
+                heap[n] = (NoTopo) { chave, posicao, n };
+                if (++n == k) {
+                    for (size_t j = k / 2; j-- > 0; ) descer_topo(heap, k, j);
+                }
+            } else if (chave < heap[0].chave) {
+                run->registros[heap[0].slot] = registros[i];
+                heap[0].chave   = chave;
+                heap[0].posicao = posicao;
+                descer_topo(heap, k, 0);
+            }
+        }
+        devolver_registros(entrada, registros, lidos);
+        if (lidos < REGISTROS_POR_LOTE) break;
+    }
+    free(lote);
+
+    // Menos de K registros: o heap ainda não foi montado
+    if (n < k) {
+        for (size_t j = n / 2; j-- > 0; ) descer_topo(heap, n, j);
+    }
+    // Heapsort: o maior vai para o fim a cada passo, e os nós ficam em ordem
+    for (size_t fim = n; fim-- > 1; ) {
+        NoTopo maior = heap[0];
+        heap[0] = heap[fim];
+        heap[fim] = maior;
+        descer_topo(heap, fim, 0);
+    }
+    ParChave *pares = malloc((n > 0 ? n : 1) * sizeof(ParChave));
+    if (!pares) {
+        perror("❌ Falha no malloc do heap de --limite");
+        free(heap);
+        liberar_run_memoria(run);
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        pares[i] = (ParChave) { heap[i].chave, heap[i].slot };
+    }
+    permutar_registros(run->registros, pares, n);
+    run->n = n;
+    free(pares);
+    free(heap);
+
+    mon_registrar_estagios(t_leitura, mon_agora() - t_inicio - t_leitura, 0.0);
+    return 0;
+}
+
+/*
+ * ➔ carregar_run_memoria:
+ *     Lê os próximos n registros da entrada, ordena-os (--ordenacao) e
+ *     põe o próprio buffer em ordem, para o merge lê-lo como uma run.
+ *     Com a entrada mapeada, os pares são ordenados sobre o mapeamento e
+ *     os registros copiados já na ordem, uma única vez. Com --intervalo,
+ *     ficam só os da faixa e, com --limite K, só os K primeiros. Os tempos
+ *     de leitura e ordenação são somados a t_leitura e t_ordenacao.
+ *
+ * return  0 em sucesso, -1 em falha (mensagem já impressa)
+ */
+static int carregar_run_memoria(const Opcoes *op, EntradaFase1 *entrada, size_t n,
+                                RunMemoria *run, double *t_leitura, double *t_ordenacao) {
+    run->registros = malloc(n * sizeof(RegistroDisco));
+    ParChave *pares = malloc(n * sizeof(ParChave));
+    ParChave *aux = (op->ordenacao == ORDENACAO_RADIX) ? malloc(n * sizeof(ParChave)) : NULL;
+    if (!run->registros || !pares || (op->ordenacao == ORDENACAO_RADIX && !aux)) {
+        perror("❌ Falha no malloc do bloco em memória");
+        free(pares);
+        free(aux);
+        liberar_run_memoria(run);
+        return -1;
+    }
+
+    double t0 = mon_agora();
+    uint64_t restantes = n;
+    const RegistroDisco *dados;
+    size_t lidos = proximos_filtrados(entrada, run->registros, n, &restantes, &dados);
+    double t1 = mon_agora();
+    run->n = lidos;
+    if (op->limite_registros && run->n > op->limite_registros) run->n = op->limite_registros;
+    if (dados == run->registros) {
+        ordenar_bloco(run->registros, lidos, pares, aux, op->ordenacao, op->bits_radix);
+        permutar_registros(run->registros, pares, lidos);
+    } else {
+        ordenar_pares_bloco(dados, lidos, pares, aux, op->ordenacao, op->bits_radix);
+        for (size_t i = 0; i < run->n; i++) {
+            run->registros[i] = dados[pares[i].indice];
+        }
+        devolver_registros(entrada, dados, lidos);
+    }
+    *t_leitura   += t1 - t0;
+    *t_ordenacao += mon_agora() - t1;
+    free(pares);
+    free(aux);
+
+    if (restantes > 0) {
+        fprintf(stderr, "❌ Leitura incompleta do último bloco de '%s'\n", op->nome_entrada);
+        liberar_run_memoria(run);
+        return -1;
+    }
+    return 0;
+}
+
+int gravar_run_memoria(const RunMemoria *run, size_t id) {
+    char nome_run[TAM_NOME_TEMPORARIO];
+    nome_temporario(nome_run, sizeof(nome_run), "run", id);
+    EscritorRun *saida = escritor_run_abrir(nome_run, sizeof(RegistroDisco),
+                                            formato_run_compressao());
+    if (!saida) {
+        perror("❌ Erro ao criar run temporário");
+        return -1;
+    }
+    int ret = escritor_run_gravar(saida, run->registros, run->n);
+    if (escritor_run_fechar(saida) != 0) ret = -1;
+    if (ret < 0) perror("❌ Erro ao escrever run temporário");
+    return ret;
+}
+
+/*
+ * ➔ fechar_entrada:
+ *     As leituras curtas da entrada são tratadas como fim do arquivo; aqui,
+ *     no fim da Fase 1, um erro de I/O escondido nelas aborta a ordenação
+ *     em vez de deixar as runs truncadas. Depois fecha a entrada (ou desfaz
+ *     o mapeamento, que não tem leituras a conferir).
+ *
+ * return  0 se nenhuma leitura falhou, -1 caso contrário (mensagem impressa)
+ */
+static int fechar_entrada(EntradaFase1 *entrada) {
+    if (entrada->mapa) {
+        mon_munmap(entrada->mapa, entrada->bytes_mapa);
+        return 0;
+    }
+    int erro = mon_erro_leitura(entrada->arquivo);
+    mon_fclose(entrada->arquivo);
+    if (erro == 0) return 0;
+    errno = erro;
+    perror("❌ Erro de leitura no arquivo de entrada");
+    return -1;
+}
+
+/*
+ * ➔ relatar_filtro:
+ *     Com --intervalo, informa quantos registros a Fase 1 descartou.
+ */
+static void relatar_filtro(const Opcoes *op, const EntradaFase1 *entrada) {
+    if (!entrada->filtrar) return;
+    printf("   • %llu registros com chave fora de [%llu, %llu] descartados antes da ordenação\n",
+           (unsigned long long) entrada->descartados, (unsigned long long) op->chave_inicial,
+           (unsigned long long) op->chave_final);
+}
+
+void liberar_run_memoria(RunMemoria *run) {
+    free(run->registros);
+    run->registros = NULL;
+    run->n = 0;
+}
+
+int gerar_runs(const Opcoes *op, size_t *contagem_runs, RunMemoria *ultima) {
+    *contagem_runs = 0;
+    if (ultima) {
+        ultima->registros = NULL;
+        ultima->n = 0;
+    }
+
+    // Quantos registros ficam em memória: a entrada inteira, se couber no
+    // orçamento (qualquer modo), ou o último bloco dos modos por blocos.
+    // Do stdin não se sabe o tamanho: tudo é lido até o EOF e vira runs
+    // (menos com --limite pequeno, que nunca grava runs)
+    bool por_blocos = !op->somente_chaves && op->geracao != GERACAO_SELECAO;
+    bool fluxo = strcmp(op->nome_entrada, MON_FLUXO) == 0;
+    uint64_t total = fluxo ? UINT64_MAX
+                           : registros_no_arquivo(op->nome_entrada, sizeof(RegistroDisco));
+
+    // Com --mmap, a entrada é mapeada e os blocos apontam para ela; o
+    // quicksort original ordena os próprios registros e precisa da cópia
+    EntradaFase1 entrada = { 0 };
+    bool mapear = op->entrada_mmap && !fluxo && total > 0;
+    if (mapear && op->ordenacao == ORDENACAO_QUICKSORT) {
+        fprintf(stderr, "⚠️ Aviso: --mmap é ignorado com --ordenacao quick, que move os registros\n");
+        mapear = false;
+    }
+    if (mapear) {
+        entrada.mapa = mon_mmap(op->nome_entrada, &entrada.bytes_mapa, MON_MAPA_SEQUENCIAL);
+        if (!entrada.mapa) {
+            perror("⚠️ Não foi possível mapear a entrada; lendo com mon_fread");
+        }
+        entrada.n_mapa = entrada.bytes_mapa / sizeof(RegistroDisco);
+    }
+    if (!entrada.mapa) {
+        entrada.arquivo = mon_fopen(op->nome_entrada, "rb");
+        if (!entrada.arquivo) {
+            perror("❌ Erro ao abrir arquivo de entrada");
+            return -1;
+        }
+    }
+    entrada.filtrar       = op->filtrar_chaves;
+    entrada.chave_inicial = op->chave_inicial;
+    entrada.chave_final   = op->chave_final;
+
+    // --limite K com o heap de K no orçamento: os K primeiros são escolhidos
+    // numa passagem, sem runs (o resultado fica em memória)
+    if (ultima && op->limite_registros > 0 && op->limite_registros <= maximo_heap_topo(op)) {
+        int ret = selecionar_menores(op, &entrada, total, ultima);
+        if (fechar_entrada(&entrada) < 0) ret = -1;
+        relatar_filtro(op, &entrada);
+        return ret;
+    }
+
+    // Com --intervalo, os blocos são de registros da faixa: o tamanho do
+    // último não se sabe antes de ler a entrada
+    size_t na_memoria = 0;
+    if (!fluxo && ultima && total > 0 && total <= op->max_blocos) {
+        na_memoria = (size_t) total;
+    } else if (!fluxo && ultima && total > 0 && por_blocos && !entrada.filtrar) {
+        size_t capacidade = capacidade_bloco(op);
+        size_t resto = (size_t) (total % capacidade);
+        if (resto == 0) resto = capacidade;
+        if (resto <= op->max_blocos / 2) na_memoria = resto;
+    }
+    double t_leitura = 0.0, t_ordenacao = 0.0;
+    if (na_memoria == total && total > 0) {
+        int ret = carregar_run_memoria(op, &entrada, na_memoria, ultima,
+                                       &t_leitura, &t_ordenacao);
+        mon_registrar_estagios(t_leitura, t_ordenacao, 0.0);
+        if (fechar_entrada(&entrada) < 0) ret = -1;
+        relatar_filtro(op, &entrada);
+        return ret;
+    }
+    uint64_t limite = total - na_memoria;
+
+    int ret;
+    if (op->somente_chaves) {
+        if (op->threads > 1 || op->pipeline || op->geracao == GERACAO_SELECAO) {
+            fprintf(stderr, "⚠️ Aviso: --threads/--pipeline/--geracao são ignorados com --somente-chaves\n");
+        }
+        ret = gerar_runs_chaves(op, &entrada, limite, contagem_runs);
+    } else if (op->geracao == GERACAO_SELECAO) {
+        if (op->threads > 1 || op->pipeline) {
+            fprintf(stderr, "⚠️ Aviso: --threads/--pipeline são ignorados com --geracao selecao\n");
+        }
+        ret = gerar_runs_selecao(op, &entrada, limite, contagem_runs);
+    } else if (op->threads > 1 || op->pipeline) {
+        ret = gerar_runs_paralelo(op, &entrada, limite, contagem_runs);
+    } else {
+        ret = gerar_runs_serial(op, &entrada, limite, contagem_runs);
+    }
+
+    // O último bloco é lido por último, depois de todas as runs gravadas
+    // (os estágios registrados pelo gerador não incluem esse bloco)
+    if (ret == 0 && na_memoria > 0) {
+        ret = carregar_run_memoria(op, &entrada, na_memoria, ultima,
+                                   &t_leitura, &t_ordenacao);
+    }
+
+    if (fechar_entrada(&entrada) < 0) ret = -1;
+    relatar_filtro(op, &entrada);
+    return ret;
+}
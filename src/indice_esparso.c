@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "indice_esparso.h"
+#include "monitor.h"
+
+// ► Maior caminho do arquivo de índice
+#define TAM_NOME_INDICE 4096
+
+void indice_nome(const char *nome_ordenado, char *buf, size_t tam) {
+    size_t n = strlen(nome_ordenado);
+    if (n > 4 && strcmp(nome_ordenado + n - 4, ".bin") == 0) {
+        snprintf(buf, tam, "%.*s.idx", (int) (n - 4), nome_ordenado);
+    } else {
+        snprintf(buf, tam, "%s.idx", nome_ordenado);
+    }
+}
+
+int indice_criar(IndiceEsparso *ix, uint64_t n_registros, size_t tam_registro) {
+    memset(ix, 0, sizeof(*ix));
+    ix->n_registros  = n_registros;
+    ix->tam_registro = tam_registro;
+    ix->passo        = PASSO_INDICE;
+    ix->n_entradas   = (n_registros + PASSO_INDICE - 1) / PASSO_INDICE;
+    if (ix->n_entradas == 0) return 0;
+    // Offsets de todo-1 marcam entradas ainda não registradas
+    ix->entradas = malloc(ix->n_entradas * sizeof(EntradaIndice));
+    if (!ix->entradas) return -1;
+    memset(ix->entradas, 0xFF, ix->n_entradas * sizeof(EntradaIndice));
+    return 0;
+}
+
+void indice_registrar(IndiceEsparso *ix, const void *registros, size_t n, uint64_t posicao) {
+    if (!ix->entradas || n == 0) return;
+    // Primeira posição múltipla de passo em [posicao, posicao + n)
+    uint64_t p = (posicao + ix->passo - 1) / ix->passo * ix->passo;
+    for (; p < posicao + n && p < ix->n_registros; p += ix->passo) {
+        EntradaIndice *e = &ix->entradas[p / ix->passo];
+        memcpy(&e->chave, (const unsigned char *) registros + (p - posicao) * ix->tam_registro,
+               sizeof(e->chave));
+        e->offset = p * ix->tam_registro;
+    }
+}
+
+void indice_acrescentar(IndiceEsparso *ix, const void *registros, size_t n) {
+    indice_registrar(ix, registros, n, ix->proximo);
+    ix->proximo += n;
+}
+
+int indice_gravar(const IndiceEsparso *ix, const char *nome_ordenado) {
+    for (uint64_t i = 0; i < ix->n_entradas; i++) {
+        if (ix->entradas[i].offset != i * ix->passo * ix->tam_registro) {
+            errno = EINVAL;  // alguma parte do ordenado não passou pelo índice
+            return -1;
+        }
+    }
+
+    CabecalhoIndice cab = {
+        .n_registros  = ix->n_registros,
+        .tam_registro = ix->tam_registro,
+        .passo        = ix->passo,
+        .n_entradas   = ix->n_entradas
+    };
+    memcpy(cab.magico, MAGICO_INDICE, sizeof(cab.magico));
+
+    char nome[TAM_NOME_INDICE];
+    indice_nome(nome_ordenado, nome, sizeof(nome));
+    ArquivoMon *f = mon_fopen(nome, "wb");
+    if (!f) return -1;
+    int ret = 0;
+    if (mon_fwrite(&cab, sizeof(cab), 1, f) != 1 ||
+        (ix->n_entradas > 0 &&
+         mon_fwrite(ix->entradas, sizeof(EntradaIndice), ix->n_entradas, f) != ix->n_entradas)) {
+        ret = -1;
+    }
+    if (mon_fclose(f) != 0) ret = -1;
+    return ret;
+}
+
+void indice_liberar(IndiceEsparso *ix) {
+    free(ix->entradas);
+    ix->entradas = NULL;
+}
+
+int consulta_abrir(ConsultaIndice *c, const char *nome_ordenado) {
+    memset(c, 0, sizeof(*c));
+    char nome[TAM_NOME_INDICE];
+    indice_nome(nome_ordenado, nome, sizeof(nome));
+    c->cabecalho = mon_mmap(nome, &c->bytes_indice, MON_MAPA_ALEATORIO);
+    if (!c->cabecalho) return -1;
+    c->entradas = (const EntradaIndice *) (c->cabecalho + 1);
+
+    // Um ordenado vazio não se mapeia: fica sem registros
+    const CabecalhoIndice *cab = c->cabecalho;
+    if (c->bytes_indice >= sizeof(*cab) && cab->n_registros > 0) {
+        c->registros = mon_mmap(nome_ordenado, &c->bytes_dados, MON_MAPA_ALEATORIO);
+        if (!c->registros) {
+            consulta_fechar(c);
+            return -1;
+        }
+    }
+
+    // O índice tem de ser deste arquivo: mesmo tamanho de registro e de
+    // arquivo, entradas para todas as janelas
+    if (c->bytes_indice < sizeof(*cab) ||
+        memcmp(cab->magico, MAGICO_INDICE, sizeof(cab->magico)) != 0 ||
+        cab->tam_registro != sizeof(RegistroDisco) || cab->passo == 0 ||
+        cab->n_registros * sizeof(RegistroDisco) != c->bytes_dados ||
+        cab->n_entradas != (cab->n_registros + cab->passo - 1) / cab->passo ||
+        c->bytes_indice != sizeof(*cab) + cab->n_entradas * sizeof(EntradaIndice)) {
+        consulta_fechar(c);
+        errno = EINVAL;
+        return -1;
+    }
+    c->n_registros = cab->n_registros;
+    return 0;
+}
+
+uint64_t consulta_limite_inferior(const ConsultaIndice *c, uint64_t chave) {
+    // Primeira entrada com chave ≥ “chave”: os registros antes da anterior
+    // a ela são todos menores, e o dela já serve
+    uint64_t lo = 0, hi = c->cabecalho->n_entradas;
+    while (lo < hi) {
+        uint64_t meio = lo + (hi - lo) / 2;
+        if (c->entradas[meio].chave < chave) lo = meio + 1;
+        else hi = meio;
+    }
+    uint64_t passo = c->cabecalho->passo;
+    uint64_t fim = lo * passo;
+    if (fim > c->n_registros) fim = c->n_registros;
+    uint64_t inicio = lo > 0 ? (lo - 1) * passo + 1 : 0;
+
+    // Busca binária na janela [inicio, fim): no máximo passo registros
+    while (inicio < fim) {
+        uint64_t meio = inicio + (fim - inicio) / 2;
+        if (c->registros[meio].chave < chave) inicio = meio + 1;
+        else fim = meio;
+    }
+    return inicio;
+}
+
+uint64_t consulta_intervalo(const ConsultaIndice *c, uint64_t chave_inicial,
+                            uint64_t chave_final, uint64_t *inicio) {
+    *inicio = consulta_limite_inferior(c, chave_inicial);
+    if (chave_final < chave_inicial) return 0;
+    uint64_t fim = chave_final == UINT64_MAX ? c->n_registros
+                                             : consulta_limite_inferior(c, chave_final + 1);
+    return fim - *inicio;
+}
+
+void consulta_fechar(ConsultaIndice *c) {
+    if (c->registros) mon_munmap(c->registros, c->bytes_dados);
+    if (c->cabecalho) mon_munmap(c->cabecalho, c->bytes_indice);
+    memset(c, 0, sizeof(*c));
+}
@@ -1,48 +1,283 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <pthread.h>
+#include <errno.h>
 #include "leitor_run.h"
+#include "fila.h"
 #include "monitor.h"
 
+// ► Estados do bloco reserva de um LeitorRun
+#define RESERVA_VAZIA  0  // ➔ livre, nenhum pedido feito
+#define RESERVA_PEDIDA 1  // ➔ pedido na fila / sendo lido pela thread
+#define RESERVA_PRONTA 2  // ➔ lido, aguardando a troca
+
+struct LeituraAntecipada {
+    pthread_t       thread;
+    Fila            pedidos;  // ➔ LeitorRun* a recarregar (NULL = encerrar)
+    pthread_mutex_t trava;    // ➔ protege reserva/qtd dos leitores
+    pthread_cond_t  pronto;   // ➔ sinaliza RESERVA_PRONTA
+};
+
 /*
- * ➔ inicializa_leitor:
- *     Abre o arquivo binário “run” e já lê o primeiro registro
- *     para preencher lr->registro. Se não conseguir abrir ou
- *     não ler nenhum registro, define tem_reg = false.
- *
- * param lr        Ponteiro para struct LeitorRun a ser inicializada
- * param nome_run  Nome do arquivo de run (ex.: “run_00005.bin”)
+ * ➔ ler_bloco:
+ *     Lê até um bloco de registros, sem passar do fim da faixa. Chamada
+ *     por quem faz a leitura (o merge ou a thread de read-ahead), uma de
+ *     cada vez.
  */
-void inicializa_leitor(LeitorRun *lr, const char *nome_run) {
-    lr->arquivo = mon_fopen(nome_run, "rb");
-    if (!lr->arquivo) {
-        lr->tem_reg = false;  // ❌ não abriu
-        return;
-    }
-    size_t lidos = mon_fread(&lr->registro, sizeof(RegistroDisco), 1, lr->arquivo);
-    if (lidos == 1) {
-        lr->tem_reg = true;   // ✔ primeiro registro lido com sucesso
+static size_t ler_bloco(LeitorRun *lr, unsigned char *destino) {
+    size_t n = lr->capacidade;
+    if (n > lr->restantes) n = (size_t) lr->restantes;
+    size_t lidos;
+    if (lr->codec) {
+        int erro = 0;
+        lidos = n > 0 ? decodificador_run_ler(lr->codec, lr->arquivo, destino,
+                                              lr->tam_registro, n, &erro) : 0;
+        if (erro != 0) lr->erro = erro;
     } else {
-        lr->tem_reg = false;  // ❌ sem registros
-        mon_fclose(lr->arquivo);
-        lr->arquivo = NULL;
+        lidos = n > 0 ? mon_fread(destino, lr->tam_registro, n, lr->arquivo) : 0;
+        if (lidos < n && mon_erro_leitura(lr->arquivo) != 0) {
+            lr->erro = mon_erro_leitura(lr->arquivo);  // leitura curta por erro, não EOF
+        }
     }
+    lr->restantes -= lidos;
+    return lidos;
 }
 
 /*
- * ➔ avancar_leitor:
- *     Avança para o próximo registro na run. Se EOF,
- *     fecha o arquivo e marca tem_reg = false.
+ * ➔ thread_leitura_antecipada:
+ *     Atende os pedidos em ordem de chegada: lê um bloco inteiro da run
+ *     no bloco reserva do leitor e marca-o como pronto.
+ */
+static void *thread_leitura_antecipada(void *arg) {
+    LeituraAntecipada *la = arg;
+    LeitorRun *lr;
+    while ((lr = fila_remover(&la->pedidos)) != NULL) {
+        pthread_mutex_lock(&la->trava);
+        int r = 1 - lr->ativo;
+        pthread_mutex_unlock(&la->trava);
+
+        size_t lidos = ler_bloco(lr, lr->blocos[r]);
+
+        pthread_mutex_lock(&la->trava);
+        lr->qtd[r] = lidos;
+        lr->reserva = RESERVA_PRONTA;
+        pthread_cond_broadcast(&la->pronto);
+        pthread_mutex_unlock(&la->trava);
+    }
+    return NULL;
+}
+
+LeituraAntecipada *leitura_antecipada_criar(size_t max_leitores) {
+    LeituraAntecipada *la = malloc(sizeof(LeituraAntecipada));
+    if (!la) return NULL;
+    if (fila_inicializar(&la->pedidos, max_leitores + 1) < 0) {
+        fila_destruir(&la->pedidos);
+        free(la);
+        return NULL;
+    }
+    pthread_mutex_init(&la->trava, NULL);
+    pthread_cond_init(&la->pronto, NULL);
+    if (pthread_create(&la->thread, NULL, thread_leitura_antecipada, la) != 0) {
+        pthread_mutex_destroy(&la->trava);
+        pthread_cond_destroy(&la->pronto);
+        fila_destruir(&la->pedidos);
+        free(la);
+        return NULL;
+    }
+    return la;
+}
+
+void leitura_antecipada_destruir(LeituraAntecipada *la) {
+    if (!la) return;
+    fila_inserir(&la->pedidos, NULL);
+    pthread_join(la->thread, NULL);
+    pthread_mutex_destroy(&la->trava);
+    pthread_cond_destroy(&la->pronto);
+    fila_destruir(&la->pedidos);
+    free(la);
+}
+
+/*
+ * ➔ pedir_reserva:
+ *     Enfileira a recarga do bloco reserva, a menos que a run já tenha
+ *     chegado ao fim. Chamado logo que o bloco reserva fica livre, para
+ *     que a leitura aconteça enquanto o bloco ativo é consumido.
+ */
+static void pedir_reserva(LeitorRun *lr) {
+    if (lr->fim_arquivo) return;
+    LeituraAntecipada *la = lr->antecipada;
+    pthread_mutex_lock(&la->trava);
+    lr->reserva = RESERVA_PEDIDA;
+    pthread_mutex_unlock(&la->trava);
+    fila_inserir(&la->pedidos, lr);
+}
+
+/*
+ * ➔ esperar_reserva:
+ *     Bloqueia até o pedido pendente (se houver) ser atendido.
+ *     return  Estado final do bloco reserva (VAZIA ou PRONTA)
+ */
+static int esperar_reserva(LeitorRun *lr) {
+    LeituraAntecipada *la = lr->antecipada;
+    pthread_mutex_lock(&la->trava);
+    while (lr->reserva == RESERVA_PEDIDA) {
+        pthread_cond_wait(&la->pronto, &la->trava);
+    }
+    int estado = lr->reserva;
+    pthread_mutex_unlock(&la->trava);
+    return estado;
+}
+
+/*
+ * ➔ carregar_proximo_bloco:
+ *     Torna ativo o próximo bloco da run: com read-ahead, troca pelo bloco
+ *     reserva (já lido ou em leitura) e pede a recarga do que foi liberado;
+ *     sem read-ahead, lê o bloco diretamente.
  *
- * param lr  Ponteiro para LeitorRun já inicializado
+ * return  Quantidade de registros no novo bloco ativo (0 → fim da run)
  */
+static size_t carregar_proximo_bloco(LeitorRun *lr) {
+    size_t lidos;
+    if (lr->antecipada) {
+        if (esperar_reserva(lr) == RESERVA_VAZIA) {
+            // Só acontece depois do EOF: não há mais nada a ler
+            lidos = 0;
+        } else {
+            lr->ativo = 1 - lr->ativo;
+            lr->reserva = RESERVA_VAZIA;
+            lidos = lr->qtd[lr->ativo];
+        }
+    } else {
+        lidos = lr->fim_arquivo ? 0 : ler_bloco(lr, lr->blocos[0]);
+        lr->qtd[0] = lidos;
+    }
+
+    if (lidos < lr->capacidade) lr->fim_arquivo = true;  // leitura curta → EOF
+    lr->pos = 0;
+    if (lidos > 0 && lr->antecipada) pedir_reserva(lr);
+    return lidos;
+}
+
+int inicializa_leitor(LeitorRun *lr, const char *nome_run, size_t tam_registro,
+                      size_t registros_por_bloco, LeituraAntecipada *la) {
+    return inicializa_leitor_faixa(lr, nome_run, tam_registro, registros_por_bloco, la,
+                                   0, UINT64_MAX);
+}
+
+int inicializa_leitor_faixa(LeitorRun *lr, const char *nome_run, size_t tam_registro,
+                            size_t registros_por_bloco, LeituraAntecipada *la,
+                            uint64_t primeiro, uint64_t quantidade) {
+    lr->registro     = NULL;
+    lr->tam_registro = tam_registro;
+    lr->tem_reg      = false;
+    lr->blocos[0]    = NULL;
+    lr->blocos[1]    = NULL;
+    lr->qtd[0]       = 0;
+    lr->qtd[1]       = 0;
+    lr->capacidade   = registros_por_bloco > 0 ? registros_por_bloco : 1;
+    lr->pos          = 0;
+    lr->ativo        = 0;
+    lr->reserva      = RESERVA_VAZIA;
+    lr->fim_arquivo  = false;
+    lr->antecipada   = la;
+    lr->restantes    = quantidade;
+    lr->emprestado   = false;
+    lr->erro         = 0;
+    lr->codec        = NULL;
+
+    // Os blocos de uma run comprimida não têm posição fixa: só do início
+    bool comprimida = formato_run_compressao() != COMPRESSAO_NENHUMA;
+    if (comprimida && primeiro > 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    lr->arquivo = mon_fopen_temporario_em(nome_run, "rb", primeiro * tam_registro);
+    if (!lr->arquivo) {
+        return -1;  // ❌ não abriu
+    }
+    lr->blocos[0] = malloc(lr->capacidade * tam_registro);
+    if (la) lr->blocos[1] = malloc(lr->capacidade * tam_registro);
+    if (comprimida) lr->codec = decodificador_run_criar();
+    if (!lr->blocos[0] || (la && !lr->blocos[1]) || (comprimida && !lr->codec)) {
+        fechar_leitor(lr);
+        return -1;
+    }
+
+    // Primeiro bloco: leitura síncrona (e, com read-ahead, pedido do reserva)
+    size_t lidos = ler_bloco(lr, lr->blocos[0]);
+    lr->qtd[0] = lidos;
+    if (lidos < lr->capacidade) lr->fim_arquivo = true;
+    if (lr->erro != 0) {
+        int erro = lr->erro;
+        fechar_leitor(lr);
+        errno = erro;
+        return -1;  // ❌ erro de leitura
+    }
+    if (lidos == 0) {
+        fechar_leitor(lr);  // ❌ sem registros
+        return 0;
+    }
+    if (la) pedir_reserva(lr);
+
+    lr->registro = lr->blocos[0];
+    lr->tem_reg  = true;   // ✔ primeiro registro disponível
+    return 0;
+}
+
+void inicializa_leitor_memoria(LeitorRun *lr, const void *registros, size_t n,
+                               size_t tam_registro) {
+    memset(lr, 0, sizeof(*lr));
+    lr->tam_registro = tam_registro;
+    lr->emprestado   = true;
+    lr->fim_arquivo  = true;
+    if (n == 0) return;
+    // O bloco é só lido: a escrita nos blocos acontece apenas nas recargas
+    lr->blocos[0]   = (unsigned char *) registros;
+    lr->qtd[0]      = n;
+    lr->capacidade  = n;
+    lr->registro    = lr->blocos[0];
+    lr->tem_reg     = true;
+}
+
 void avancar_leitor(LeitorRun *lr) {
-    if (!lr->arquivo) return;  // já estava fechado
-    size_t lidos = mon_fread(&lr->registro, sizeof(RegistroDisco), 1, lr->arquivo);
-    if (lidos == 1) {
-        lr->tem_reg = true;   // ✔ registro válido disponível
+    if (!lr->tem_reg) return;  // já estava fechado
+
+    // Caminho rápido: ainda há registros no bloco ativo
+    if (++lr->pos < lr->qtd[lr->ativo]) {
+        lr->registro = lr->blocos[lr->ativo] + lr->pos * lr->tam_registro;
+        return;
+    }
+
+    if (carregar_proximo_bloco(lr) > 0) {
+        lr->registro = lr->blocos[lr->ativo];  // ✔ novo bloco
     } else {
-        lr->tem_reg = false;  // ❌ fim do arquivo
+        fechar_leitor(lr);                     // ❌ fim do arquivo
+    }
+}
+
+void avancar_leitor_varios(LeitorRun *lr, size_t n) {
+    if (!lr->tem_reg || n == 0) return;
+    lr->pos += n - 1;
+    avancar_leitor(lr);
+}
+
+void fechar_leitor(LeitorRun *lr) {
+    if (lr->antecipada) {
+        esperar_reserva(lr);
+    }
+    if (lr->arquivo) {
         mon_fclose(lr->arquivo);
         lr->arquivo = NULL;
     }
+    if (!lr->emprestado) {
+        free(lr->blocos[0]);
+        free(lr->blocos[1]);
+    }
+    decodificador_run_destruir(lr->codec);
+    lr->codec     = NULL;
+    lr->blocos[0] = NULL;
+    lr->blocos[1] = NULL;
+    lr->registro  = NULL;
+    lr->tem_reg   = false;
+    lr->reserva   = RESERVA_VAZIA;
 }
@@ -1,13 +1,30 @@
+// Para expor stat (POSIX)
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
-#include <errno.h>
 #include <string.h>
-#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
 
 #include "registro.h"
 #include "merge_runs.h"
-#include "quicksort.h"
+#include "gera_runs.h"
+#include "opcoes.h"
 #include "monitor.h"
+#include "tar_saida.h"
+#include "planejador.h"
+#include "coleta_payload.h"
+#include "posicionamento_direto.h"
+#include "distribuicao.h"
+#include "memoria_auto.h"
+#include "temporarios.h"
+#include "formato_run.h"
+#include "merge_vetorial.h"
+#include "indice_esparso.h"
+
+// ► Arquivo ordenado (o .tar de saída vem de --saida)
+#define NOME_ORDENADO     "grande_sorted.bin"
 
 /*
  * ────────────────────────────────────────────────────────────────────────────
@@ -16,265 +33,740 @@
  *
  *   Fase 1: Geração de runs simples (blocos de até max_blocos registros) ➔
  *           lê do arquivo de entrada “misturado-grande.vet” em fatias,
- *           ordena cada fatia em memória e grava run_xxxxx.bin no disco.
+ *           ordena os pares (chave, índice) de cada fatia (introsort ou
+ *           radix sort, conforme --ordenacao) e grava run_xxxxx.bin copiando cada registro uma única vez.
+ *           Com --mmap, as fatias são o próprio .vet mapeado, sem cópia.
  *
  *   Fase 2: Mesclagem em múltiplas passagens (multi-pass merge) ➔
- *           enquanto houver mais de MAX_RUNS_ABERTAS runs no disco:
- *             • agrupa até MAX_RUNS_ABERTAS runs de cada vez
- *             • mescla (k-way merge) em runInter_xxxxx.bin
- *             • remove runs antigas após mesclar
- *           • ao final, mescla o que restar em “grande_sorted.bin”
+ *           • escolhe o fan-in k pela memória e por RLIMIT_NOFILE e monta
+ *             um plano de Huffman (planejador.c), impresso antes do merge
+ *           • cada merge intermediário junta as runs menores (k-way merge)
+ *             em runInter_xxxxx.bin, numeradas em sequência
+ *           • remove runs antigas após mesclar
+ *           • ao final, mescla o que restar direto no “reconstruido.tar”,
+ *             gravando apenas os bytes válidos (pacote[0..tamanho-1]) de
+ *             cada registro (e também “grande_sorted.bin”, com
+ *             --manter-ordenado)
+ *           • com --somente-chaves, runs e merges carregam só
+ *             (chave, offset) e o merge final busca cada registro no .vet
+ *             de entrada (mmap) antes de gravá-lo
+ *           • com --threads N, cada merge é repartido em até N faixas de
+ *             chave mescladas em paralelo, cada uma gravada na sua região
+ *             do arquivo de saída; se o merge final for repartido, grava
+ *             o “grande_sorted.bin”, e a Fase 3 monta o .tar a partir dele
+ *           • com --compressao, as runs e os runInter_ são gravados em
+ *             blocos com chaves em delta/varint e só os bytes válidos de
+ *             cada pacote (mais LZ, em “lz”), e os merges são seriais
  *
- *   Fase 3: Reconstrução do arquivo .tar ➔
- *           • lê registros de “grande_sorted.bin”
- *           • grava apenas os bytes válidos (registro.pacote[0..tamanho-1])
- *             em “reconstruido.tar”
+ *   Fase 3: Fechamento do arquivo .tar ➔
+ *           • depois do merge final paralelo (--threads), grava o conteúdo
+ *             a partir do “grande_sorted.bin”: cada thread compacta um
+ *             pedaço e o grava (pwrite) na posição dada pela soma dos
+ *             tamanhos dos registros anteriores
  *           • preenche zeros para fechar o último bloco de 512 bytes
  *           • escreve dois blocos de 512 bytes de zeros (fim-de-tar)
- *           • remove todos os arquivos temporários de run_*.bin, runInter_*.bin
+ *           • remove os temporários (run_*.bin, runInter_*.bin) registrados
+ *             por esta execução, em todos os diretórios de --tmpdir (numa
+ *             saída por falha, o atexit registrado em main faz o mesmo)
  *
  *   Após isso, exibe mensagem de sucesso e finaliza.
+ *
+ *   Com --distribuicao, as Fases 1 e 2 dão lugar a um sample sort: a
+ *   Fase 1 espalha a entrada em baldes por faixa de chave (divisores
+ *   escolhidos numa amostra) e a Fase 2 ordena cada balde em memória,
+ *   acrescentando-os ao .tar na ordem (distribuicao.c).
+ *
+ *   Com --chaves-densas, a Fase 1 apenas confere se as chaves são 0..N-1;
+ *   se forem, a Fase 2 grava cada pacote direto na sua posição do .tar
+ *   (sem runs) e a Fase 3 acrescenta o padding e o fim-de-tar. Se não
+ *   forem, segue a ordenação externa acima.
+ *
+ *   Com --intervalo A:B, a Fase 1 descarta as chaves fora de [A, B] antes
+ *   de ordenar; com --limite K, só os K primeiros registros saem: as runs
+ *   guardam no máximo K e os merges param depois do K-ésimo, e um K que
+ *   caiba em memória é escolhido por um heap de K, sem runs. Os dois
+ *   valem só para runs + merge.
+ *
+ *   Com --manter-ordenado, quem grava o “grande_sorted.bin” (em qualquer
+ *   dos modos) alimenta também o índice esparso “grande_sorted.idx”, que
+ *   o subcomando “consultar” usa para buscar faixas de chaves sem ler o
+ *   arquivo inteiro.
  * ────────────────────────────────────────────────────────────────────────────
  */
 
-int main(int argc, char *argv[]) {
-    // Checa parâmetros de linha de comando
-    if (argc < 3) {
-        fprintf(stderr,
-                "Uso: %s <arquivo_entrada> <max_blocos_em_memoria>\n"
-                "  <arquivo_entrada>       : ex.: misturado-grande.vet\n"
-                "  <max_blocos_em_memoria> : quantos registros (264 bytes cada)\n"
-                "                            cabem em RAM simultaneamente.\n",
-                argv[0]
-        );
-        return EXIT_FAILURE;
+/*
+ * ➔ abrir_indice:
+ *     Com --manter-ordenado, prepara o índice esparso do “grande_sorted.bin”
+ *     de n_registros registros.
+ *
+ * return  •  0 (em *indice, o índice, ou NULL sem --manter-ordenado)
+ *          • -1 sem memória (mensagem já impressa)
+ */
+static int abrir_indice(const Opcoes *op, uint64_t n_registros, IndiceEsparso *ix,
+                        IndiceEsparso **indice) {
+    *indice = NULL;
+    if (!op->manter_ordenado) return 0;
+    if (indice_criar(ix, n_registros, sizeof(RegistroDisco)) < 0) {
+        fprintf(stderr, "❌ Falha no malloc do índice de “%s”\n", NOME_ORDENADO);
+        return -1;
     }
+    *indice = ix;
+    return 0;
+}
 
-    const char *nome_entrada = argv[1];
-    errno = 0;
-    long tmp = strtol(argv[2], NULL, 10);
-    if (errno != 0 || tmp <= 0) {
-        fprintf(stderr, "Erro: <max_blocos_em_memoria> deve ser inteiro positivo.\n");
-        return EXIT_FAILURE;
+/*
+ * ➔ gravar_indice:
+ *     Grava o índice ao lado do “grande_sorted.bin” já completo e o libera
+ *     (NULL: nada a fazer).
+ *
+ * return  0 em sucesso, -1 em falha (mensagem já impressa)
+ */
+static int gravar_indice(IndiceEsparso *indice) {
+    if (!indice) return 0;
+    int ret = indice_gravar(indice, NOME_ORDENADO);
+    char nome[TAM_NOME_TEMPORARIO];
+    indice_nome(NOME_ORDENADO, nome, sizeof(nome));
+    if (ret < 0) {
+        perror("❌ Erro ao gravar o índice do arquivo ordenado");
+    } else {
+        printf("   • índice esparso “%s”: %llu entradas (uma a cada %zu registros)\n",
+               nome, (unsigned long long) indice->n_entradas, indice->passo);
     }
-    size_t max_blocos = (size_t) tmp;
+    indice_liberar(indice);
+    return ret;
+}
+
+/*
+ * ➔ executar_chaves_densas:
+ *     Fases 2 e 3 do modo --chaves-densas, depois da verificação (Fase 1):
+ *     uma passagem de leitura posiciona os pacotes no .tar, aberto por
+ *     main, e o final do .tar é gravado após o conteúdo.
+ *
+ * return  0 em sucesso, -1 em falha (mensagem já impressa)
+ */
+static int executar_chaves_densas(const Opcoes *op, const MapaDenso *mapa, SaidaTar *tar) {
+    const char *nome_ordenado = op->manter_ordenado ? NOME_ORDENADO : NULL;
 
     mon_timer_start();
 
-    // ──────────── FASE 1: Criação de runs simples ────────────
-    FILE *arquivo_entrada = mon_fopen(nome_entrada, "rb");
-    if (!arquivo_entrada) {
-        perror("❌ Erro ao abrir arquivo de entrada");
-        return EXIT_FAILURE;
+    // ──────────── FASE 2: Posicionamento direto ────────────
+    ArquivoMon *ordenado = nome_ordenado ? mon_fopen(nome_ordenado, "wb") : NULL;
+    if (nome_ordenado && !ordenado) {
+        perror("❌ Erro ao criar “grande_sorted.bin”");
+        return -1;
+    }
+    IndiceEsparso ix, *indice;
+    if (abrir_indice(op, mapa->n, &ix, &indice) < 0) {
+        if (ordenado) mon_fclose(ordenado);
+        return -1;
+    }
+    int ret = posicionar_registros(mapa, op->nome_entrada, tar->arquivo, ordenado, indice);
+    if (ordenado && mon_fclose(ordenado) != 0) ret = -1;
+    if (ret < 0) {
+        fprintf(stderr, "❌ Erro no posicionamento direto dos registros.\n");
+        if (indice) indice_liberar(indice);
+        return -1;
+    }
+    if (gravar_indice(indice) < 0) {
+        return -1;
     }
 
-    // Aloca buffer para até max_blocos registros em memória
-    RegistroDisco *buffer = malloc(max_blocos * sizeof(RegistroDisco));
-    if (!buffer) {
-        perror("❌ Falha no malloc do buffer");
-        mon_fclose(arquivo_entrada);
-        return EXIT_FAILURE;
+    mon_timer_stop_and_log(2);
+
+    printf("✔ Fase 2 concluída: %zu registros posicionados em “%s” sem runs.\n",
+           mapa->n, op->nome_saida);
+
+    mon_timer_start();
+
+    // ──────────── FASE 3: Fechamento do “reconstruido.tar” ────────────
+    // O conteúdo foi gravado com mon_pwrite; tar_fechar grava o final da
+    // mesma forma, logo depois dele
+    tar->total_bytes = (size_t) mapa->total_bytes;
+    tar->posicional  = true;
+    if (tar_fechar(tar) < 0) {
+        perror("❌ Erro ao escrever no .tar de saída");
+        return -1;
     }
 
-    size_t contagem_runs = 0;
-    while (1) {
-        // Lê no máximo max_blocos registros de uma vez
-        size_t lidos = mon_fread(buffer, sizeof(RegistroDisco), max_blocos, arquivo_entrada);
-        if (lidos == 0) break;  // fim de arquivo
-
-        // Ordena em memória pelo campo “chave”
-        //qsort(buffer, lidos, sizeof(RegistroDisco), comparar_registros);
-        quicksort_registros(buffer, 0, (lidos > 0 ? lidos - 1 : 0));
-
-        // Grava run temporária no disco: run_00000.bin, run_00001.bin, etc.
-        char nome_run[64];
-        snprintf(nome_run, sizeof(nome_run), "run_%05zu.bin", contagem_runs);
-        FILE *saida_run = mon_fopen(nome_run, "wb");
-        if (!saida_run) {
-            perror("❌ Erro ao criar run temporário");
-            free(buffer);
-            mon_fclose(arquivo_entrada);
-            return EXIT_FAILURE;
+    mon_timer_stop_and_log(3);
+
+    printf("✔ Fase 3 concluída: “%s” gerado (conteúdo = %zu bytes + padding = %zu bytes).\n",
+           op->nome_saida, tar->total_bytes, tar->padding);
+    printf("✔ Ordenação Externa finalizada com sucesso!\n");
+
+    mon_log_max_fd();
+    mon_log_io_stats();
+    return 0;
+}
+
+/*
+ * ➔ threads_merge_final:
+ *     Threads do merge final: com mais de 1, ele é repartido por faixas de
+ *     chave e grava o “grande_sorted.bin” em paralelo (a Fase 3 monta o
+ *     .tar a partir dele); com 1, alimenta o .tar diretamente. Não vale
+ *     para --somente-chaves, cujo merge final busca os payloads no .vet,
+ *     nem quando threads_merge_paralelo recorreria ao serial (--direto,
+ *     poucos registros, fan-in sem folga) ou quando o .tar vai para o
+ *     stdout (a Fase 3 não poderia gravá-lo em paralelo): gravar e reler o
+ *     arquivo ordenado seria só custo.
+ */
+static size_t threads_merge_final(const Opcoes *op, size_t n_runs, uint64_t total_registros,
+                                  const ParametrosMerge *params) {
+    if (op->somente_chaves || op->distribuicao || strcmp(op->nome_saida, MON_FLUXO) == 0) {
+        return 1;
+    }
+    return threads_merge_paralelo(n_runs, total_registros, params);
+}
+
+/*
+ * ➔ caminho_ordenado:
+ *     Onde o merge final paralelo grava o “grande_sorted.bin”: no diretório
+ *     atual com --manter-ordenado (o arquivo fica), senão no diretório dos
+ *     temporários (a Fase 3 o apaga).
+ */
+static void caminho_ordenado(const Opcoes *op, char *buf, size_t tam) {
+    if (op->manter_ordenado) {
+        snprintf(buf, tam, "%s", NOME_ORDENADO);
+    } else {
+        caminho_temporario(buf, tam, NOME_ORDENADO);
+    }
+}
+
+/*
+ * ➔ gravar_entrada_em_memoria:
+ *     Fase 2 quando a entrada inteira coube em max_blocos: os registros já
+ *     ordenados em memória vão direto para o .tar (e para o arquivo
+ *     ordenado, com --manter-ordenado), sem nenhum temporário.
+ *
+ * return  0 em sucesso, -1 em falha (mensagem já impressa)
+ */
+static int gravar_entrada_em_memoria(const Opcoes *op, const RunMemoria *run, SaidaTar *tar) {
+    int ret = tar_gravar_registros(tar, run->registros, run->n);
+    if (ret == 0 && op->manter_ordenado) {
+        ArquivoMon *ordenado = mon_fopen_temporario(NOME_ORDENADO, "wb");
+        if (!ordenado ||
+            mon_fwrite(run->registros, sizeof(RegistroDisco), run->n, ordenado) != run->n) {
+            ret = -1;
         }
-        if (mon_fwrite(buffer, sizeof(RegistroDisco), lidos, saida_run) != lidos) {
-            perror("❌ Erro ao escrever run temporário");
-            free(buffer);
-            mon_fclose(arquivo_entrada);
-            mon_fclose(saida_run);
-            return EXIT_FAILURE;
+        if (ordenado && mon_fclose(ordenado) != 0) ret = -1;
+    }
+    if (ret < 0) {
+        perror("❌ Erro ao gravar os registros ordenados em memória");
+        return -1;
+    }
+    IndiceEsparso ix, *indice;
+    if (abrir_indice(op, run->n, &ix, &indice) < 0) {
+        return -1;
+    }
+    if (indice) indice_registrar(indice, run->registros, run->n, 0);
+    if (gravar_indice(indice) < 0) {
+        return -1;
+    }
+
+    mon_timer_stop_and_log(2);
+    printf("✔ Fase 2 concluída: %zu registros gravados direto em “%s”.\n",
+           run->n, op->nome_saida);
+    return 0;
+}
+
+/*
+ * ➔ mesclar_runs_geradas:
+ *     Fase 2 da ordenação externa: planeja e executa os merges das runs da
+ *     Fase 1. O último bloco, se ficou em memória, entra no merge final
+ *     como run virtual quando o plano não tem merges intermediários (e
+ *     reduz o orçamento do merge); senão, é gravado como a última run.
+ *
+ * return  0 se o conteúdo foi gravado no .tar, 1 se ficou no
+ *         “grande_sorted.bin” para a Fase 3, -1 em falha
+ */
+static int mesclar_runs_geradas(const Opcoes *op, SaidaTar *tar, size_t contagem_runs,
+                                RunMemoria *ultima) {
+    // O merge usa o mesmo orçamento de memória da Fase 1 (com max_blocos
+    // auto, medido de novo: encolhe se o limite baixou), em registros do
+    // formato das runs (EntradaChave no --somente-chaves)
+    size_t max_blocos = op->max_blocos_auto
+                        ? reavaliar_max_blocos(op->max_blocos, ultima->n, 2)
+                        : op->max_blocos;
+    size_t tam_registro = op->somente_chaves ? sizeof(EntradaChave) : sizeof(RegistroDisco);
+    ParametrosMerge params = {
+        .memoria_registros  = max_blocos * sizeof(RegistroDisco) / tam_registro,
+        .tam_registro       = tam_registro,
+        .leitura_antecipada = op->leitura_antecipada,
+        .threads            = op->threads,
+        .limite             = op->limite_registros
+    };
+
+    // Com --limite, o total (e o índice) é o que o merge final entrega
+    uint64_t total_registros = ultima->n;
+    char nome_run[TAM_NOME_TEMPORARIO];
+    for (size_t i = 0; i < contagem_runs; i++) {
+        nome_temporario(nome_run, sizeof(nome_run), "run", i);
+        total_registros += registros_na_run(nome_run, tam_registro);
+    }
+    if (params.limite && total_registros > params.limite) total_registros = params.limite;
+
+    // Planeja os merges: fan-in pelo orçamento de memória e pelo limite de
+    // descritores; as runs menores são mescladas primeiro (Huffman). O
+    // fan-in só é dividido entre as threads se o merge final (de ao menos
+    // 2 runs) puder mesmo ser repartido
+    PlanoMerge plano;
+    bool gravar_ultima = ultima->n > max_blocos / 2;  // só se o orçamento encolheu
+    if (ultima->n > 0 && !gravar_ultima) {
+        size_t restante = max_blocos - ultima->n;
+        ParametrosMerge previsao = params;
+        previsao.memoria_registros = restante;
+        size_t threads_plano = threads_merge_final(op, 2, total_registros, &previsao);
+        if (planejar_runs_em_disco(contagem_runs + 1, restante, tam_registro,
+                                   op->leitura_antecipada, threads_plano, &plano) < 0) {
+            fprintf(stderr, "❌ Falha ao montar o plano da Fase 2\n");
+            return -1;
+        }
+        if (plano.n_passos == 0) {
+            params.memoria_registros = restante;
+            params.run_memoria       = ultima->registros;
+            params.n_run_memoria     = ultima->n;
+        } else {
+            // Os merges intermediários só leem arquivos: o bloco vira run
+            liberar_plano(&plano);
+            gravar_ultima = true;
         }
-        mon_fclose(saida_run);
+    }
+    if (gravar_ultima) {
+        if (gravar_run_memoria(ultima, contagem_runs) < 0) return -1;
+        printf("   • %s: último bloco gravado como run_%05zu.bin\n",
+               max_blocos < op->max_blocos ? "orçamento reduzido"
+                                           : "o plano tem merges intermediários",
+               contagem_runs);
+        liberar_run_memoria(ultima);
         contagem_runs++;
     }
+    if (!params.run_memoria &&
+        planejar_runs_em_disco(contagem_runs, params.memoria_registros, tam_registro,
+                               op->leitura_antecipada,
+                               threads_merge_final(op, 2, total_registros, &params),
+                               &plano) < 0) {
+        fprintf(stderr, "❌ Falha ao montar o plano da Fase 2\n");
+        return -1;
+    }
+    imprimir_plano(&plano);
+
+    // Merges intermediários, na ordem do plano
+    if (executar_merges_intermediarios(&plano, &params) < 0) {
+        return -1;
+    }
+    if (plano.n_passos > 0) {
+        printf("✔ %zu merges intermediários concluídos: restam %zu runs.\n",
+               plano.n_passos, plano.n_final);
+    }
+
+    const char *nome_ordenado = op->manter_ordenado ? NOME_ORDENADO : NULL;
+
+    // O merge final (serial ou por faixas) ou a coleta dos payloads
+    // alimentam o índice com cada bloco gravado no “grande_sorted.bin”
+    IndiceEsparso ix;
+    if (abrir_indice(op, total_registros, &ix, &params.indice) < 0) {
+        liberar_plano(&plano);
+        return -1;
+    }
+
+    // Com --threads, o merge final também é repartido por faixas de chave
+    // (se compensar, pela mesma conta de mesclar_runs_bloco): grava o
+    // “grande_sorted.bin” e a Fase 3 monta o .tar a partir dele
+    if (threads_merge_final(op, plano.n_final, total_registros, &params) > 1) {
+        char ordenado[TAM_NOME_TEMPORARIO];
+        caminho_ordenado(op, ordenado, sizeof(ordenado));
+        if (executar_merge_final(&plano, ordenado, &params) < 0) {
+            fprintf(stderr, "❌ Erro no merge final de %zu runs.\n", plano.n_final);
+            if (params.indice) indice_liberar(params.indice);
+            liberar_plano(&plano);
+            return -1;
+        }
+        liberar_plano(&plano);
+        if (gravar_indice(params.indice) < 0) {
+            return -1;
+        }
+        mon_timer_stop_and_log(2);
+        printf("✔ Fase 2 concluída: arquivo “%s” gerado.\n", ordenado);
+        return 1;
+    }
+
+    // Último merge (as n_final ≤ fan_in runs restantes) → direto para o .tar.
+    // O “grande_sorted.bin” só é gravado (em paralelo ao .tar) com
+    // --manter-ordenado; a Fase 3 deixa de reler o conjunto inteiro.
+    params.consumidor = tar_gravar_registros;
+    params.contexto   = tar;
+
+    // --somente-chaves: o merge final entrega (chave, offset) e a coleta
+    // busca cada registro no .vet antes de repassá-lo ao .tar
+    ColetaPayload coleta;
+    const char *nome_saida_merge = nome_ordenado;
+    if (op->somente_chaves) {
+        if (coleta_abrir(&coleta, op->nome_entrada, tar, nome_ordenado) < 0) {
+            perror("❌ Erro ao mapear a entrada para a coleta dos payloads");
+            if (params.indice) indice_liberar(params.indice);
+            liberar_plano(&plano);
+            return -1;
+        }
+        coleta.indice     = params.indice;
+        params.indice     = NULL;  // o merge não grava arquivo: a coleta registra
+        params.consumidor = coleta_consumir;
+        params.contexto   = &coleta;
+        nome_saida_merge  = NULL;  // o arquivo ordenado é gravado pela coleta
+    }
+
+    int ret_final = executar_merge_final(&plano, nome_saida_merge, &params);
+    IndiceEsparso *indice = op->somente_chaves ? coleta.indice : params.indice;
+    if (op->somente_chaves && coleta_fechar(&coleta) < 0) ret_final = -1;
+    if (ret_final < 0) {
+        fprintf(stderr, "❌ Erro no merge final de %zu runs.\n", plano.n_final);
+        if (indice) indice_liberar(indice);
+        liberar_plano(&plano);
+        return -1;
+    }
+    liberar_plano(&plano);
+    if (gravar_indice(indice) < 0) {
+        return -1;
+    }
 
-    mon_fclose(arquivo_entrada);
-    free(buffer);
+    mon_timer_stop_and_log(2);
+
+    if (nome_ordenado) {
+        printf("✔ Fase 2 concluída: arquivo “%s” gerado.\n", nome_ordenado);
+    } else {
+        printf("✔ Fase 2 concluída: registros ordenados gravados em “%s”.\n", op->nome_saida);
+    }
+    return 0;
+}
+
+/*
+ * ➔ ordenar_por_merge:
+ *     Fases 1 e 2 da ordenação externa por runs + k-way merge; o merge
+ *     final grava o conteúdo no .tar aberto por main, que fica aberto
+ *     para a Fase 3. Se a entrada inteira couber em max_blocos, é ordenada
+ *     em memória e vai direto para o .tar, sem runs.
+ *
+ * return  0 se o conteúdo foi gravado no .tar, 1 se ficou no
+ *         “grande_sorted.bin” para a Fase 3, -1 em falha (mensagem já
+ *         impressa)
+ */
+static int ordenar_por_merge(const Opcoes *op, SaidaTar *tar) {
+    // ──────────── FASE 1: Criação de runs simples ────────────
+    size_t contagem_runs = 0;
+    RunMemoria ultima;
+    if (gerar_runs(op, &contagem_runs, &ultima) < 0) {
+        return -1;
+    }
 
     mon_timer_stop_and_log(1);
 
-    if (contagem_runs == 0) {
-        fprintf(stderr, "❌ Nenhum registro encontrado em '%s'.\n", nome_entrada);
-        return EXIT_FAILURE;
+    // Com --intervalo, nenhum registro na faixa dá um .tar vazio
+    if (contagem_runs == 0 && ultima.n == 0 && !op->filtrar_chaves) {
+        liberar_run_memoria(&ultima);
+        fprintf(stderr, "❌ Nenhum registro encontrado em '%s'.\n", op->nome_entrada);
+        return -1;
+    }
+    if (contagem_runs == 0 && ultima.n == 0) {
+        printf("✔ Fase 1 concluída: nenhum registro com chave em [%llu, %llu].\n",
+               (unsigned long long) op->chave_inicial, (unsigned long long) op->chave_final);
+    } else if (contagem_runs == 0 && op->limite_registros > 0) {
+        printf("✔ Fase 1 concluída: os %zu primeiros registros ficaram em memória, sem runs.\n",
+               ultima.n);
+    } else if (contagem_runs == 0) {
+        printf("✔ Fase 1 concluída: entrada inteira (%zu registros) ordenada em memória.\n",
+               ultima.n);
+    } else if (ultima.n > 0) {
+        printf("✔ Fase 1 concluída: %zu runs simples geradas + último bloco "
+               "(%zu registros) mantido em memória.\n", contagem_runs, ultima.n);
+    } else {
+        printf("✔ Fase 1 concluída: %zu runs simples geradas.\n", contagem_runs);
     }
-    printf("✔ Fase 1 concluída: %zu runs simples geradas.\n", contagem_runs);
 
     mon_timer_start();
 
-    // ──────────── FASE 2: Mesclagem multi-pass ────────────
-    // Prepara vetor com nomes de runs atuais (“run_00000.bin”, …)
-    char **runs_atuais = malloc(contagem_runs * sizeof(char *));
-    if (!runs_atuais) {
-        fprintf(stderr, "❌ Falha no malloc de runs_atuais\n");
+    // ──────────── FASE 2: Mesclagem multi-pass (ou gravação direta) ────────────
+    int ret = (contagem_runs == 0) ? gravar_entrada_em_memoria(op, &ultima, tar)
+                                   : mesclar_runs_geradas(op, tar, contagem_runs, &ultima);
+    liberar_run_memoria(&ultima);
+    return ret;
+}
+
+/*
+ * ➔ ordenar_por_distribuicao:
+ *     Fases 1 e 2 do modo --distribuicao: a entrada é espalhada em baldes
+ *     por faixa de chave e cada balde é ordenado em memória e acrescentado
+ *     ao .tar aberto por main, que fica aberto para a Fase 3.
+ *
+ * return  0 em sucesso, -1 em falha (mensagem já impressa)
+ */
+static int ordenar_por_distribuicao(const Opcoes *op, SaidaTar *tar) {
+    // ──────────── FASE 1: Distribuição em baldes ────────────
+    Distribuicao dist;
+    if (distribuir_em_baldes(op, &dist) < 0) {
+        return -1;
+    }
+
+    mon_timer_stop_and_log(1);
+
+    printf("✔ Fase 1 concluída: %llu registros distribuídos em %zu baldes "
+           "(amostra de %zu chaves).\n",
+           (unsigned long long) dist.n_registros, dist.n_baldes, dist.n_amostras);
+
+    mon_timer_start();
+
+    // ──────────── FASE 2: Ordenação dos baldes em memória ────────────
+    const char *nome_ordenado = op->manter_ordenado ? NOME_ORDENADO : NULL;
+    ArquivoMon *ordenado = nome_ordenado ? mon_fopen_temporario(nome_ordenado, "wb") : NULL;
+    if (nome_ordenado && !ordenado) {
+        perror("❌ Erro ao criar “grande_sorted.bin”");
+        liberar_distribuicao(&dist);
+        return -1;
+    }
+
+    IndiceEsparso ix, *indice;
+    if (abrir_indice(op, dist.n_registros, &ix, &indice) < 0) {
+        if (ordenado) mon_fclose(ordenado);
+        liberar_distribuicao(&dist);
+        return -1;
+    }
+    int ret = ordenar_baldes(op, &dist, tar, ordenado, indice);
+    if (ordenado && mon_fclose(ordenado) != 0) ret = -1;
+    if (ret < 0) {
+        fprintf(stderr, "❌ Erro na ordenação dos baldes.\n");
+        if (indice) indice_liberar(indice);
+        liberar_distribuicao(&dist);
+        return -1;
+    }
+    if (gravar_indice(indice) < 0) {
+        liberar_distribuicao(&dist);
+        return -1;
+    }
+
+    mon_timer_stop_and_log(2);
+
+    printf("✔ Fase 2 concluída: %zu baldes ordenados e gravados em “%s”.\n",
+           dist.n_baldes, op->nome_saida);
+    liberar_distribuicao(&dist);
+    return 0;
+}
+
+/*
+ * ➔ mesma_saida_que_entrada:
+ *     --saida aponta para o próprio .vet de entrada (mesmo dispositivo e
+ *     inode)? Criar o .tar antes da Fase 1 o truncaria antes da leitura.
+ */
+static bool mesma_saida_que_entrada(const Opcoes *op) {
+    struct stat entrada, saida;
+    if (strcmp(op->nome_entrada, MON_FLUXO) == 0 || strcmp(op->nome_saida, MON_FLUXO) == 0) {
+        return false;
+    }
+    return stat(op->nome_entrada, &entrada) == 0 && stat(op->nome_saida, &saida) == 0 &&
+           entrada.st_dev == saida.st_dev && entrada.st_ino == saida.st_ino;
+}
+
+/*
+ * ➔ descartar_saida:
+ *     Numa falha depois de aberto o .tar: fecha-o (se ainda estiver
+ *     aberto) e apaga o arquivo incompleto; no stdout, só fecha.
+ */
+static void descartar_saida(const Opcoes *op, SaidaTar *tar) {
+    if (tar->arquivo) tar_fechar(tar);
+    if (strcmp(op->nome_saida, MON_FLUXO) != 0) remove(op->nome_saida);
+}
+
+/*
+ * ➔ executar_consulta:
+ *     Subcomando “consultar”: mapeia o arquivo ordenado e o índice e acha
+ *     os registros da faixa pedida (O(log n) páginas tocadas). Lista
+ *     chave, tamanho e offset de cada um no stdout ou, com --saida, grava
+ *     os próprios registros.
+ *
+ * return  EXIT_SUCCESS ou EXIT_FAILURE
+ */
+static int executar_consulta(int argc, char *argv[]) {
+    OpcoesConsulta op;
+    if (analisar_consulta(argc, argv, &op) < 0) {
+        return EXIT_FAILURE;
+    }
+    if (op.nome_saida && strcmp(op.nome_saida, MON_FLUXO) == 0 && mon_reservar_stdout() < 0) {
+        perror("❌ Erro ao reservar o stdout para os registros");
         return EXIT_FAILURE;
     }
-    for (size_t i = 0; i < contagem_runs; i++) {
-        runs_atuais[i] = malloc(32);
-        snprintf(runs_atuais[i], 32, "run_%05zu.bin", i);
-    }
-    size_t qtd_runs_atuais = contagem_runs;
-    size_t passada = 0;
-
-    // Enquanto houver mais runs do que MAX_RUNS_ABERTAS, faz uma passagem de mesclagem
-    while (qtd_runs_atuais > MAX_RUNS_ABERTAS) {
-        // Calcula quantos blocos (chunks) de até MAX_RUNS_ABERTAS serão mesclados
-        size_t n_blocos = (qtd_runs_atuais + MAX_RUNS_ABERTAS - 1) / MAX_RUNS_ABERTAS;
-        char **prox_runs = malloc(n_blocos * sizeof(char *));
-        if (!prox_runs) {
-            fprintf(stderr, "❌ Falha no malloc de prox_runs\n");
-            return EXIT_FAILURE;
-        }
 
-        for (size_t bloco = 0; bloco < n_blocos; bloco++) {
-            // Determina início/fim do bloco de runs a mesclar nesta iteração
-            size_t inicio = bloco * MAX_RUNS_ABERTAS;
-            size_t fim    = inicio + MAX_RUNS_ABERTAS;
-            if (fim > qtd_runs_atuais) fim = qtd_runs_atuais;
-            size_t qtd = fim - inicio;
-
-            // Nomeia run intermediária: runInter_XXXXX.bin (passada * 1000 + bloco)
-            prox_runs[bloco] = malloc(32);
-            snprintf(prox_runs[bloco], 32,
-                     "runInter_%05zu.bin", passada * 1000 + bloco);
-
-            // Faz merge das runs_atuais[inicio..fim-1] em prox_runs[bloco]
-            if (mesclar_runs_bloco(&runs_atuais[inicio], qtd, prox_runs[bloco]) < 0) {
-                fprintf(stderr, "❌ Erro em mesclar_runs_bloco (passada %zu, bloco %zu)\n", passada, bloco);
-                return EXIT_FAILURE;
-            }
+    ConsultaIndice c;
+    if (consulta_abrir(&c, op.nome_ordenado) < 0) {
+        char nome[TAM_NOME_TEMPORARIO];
+        indice_nome(op.nome_ordenado, nome, sizeof(nome));
+        fprintf(stderr, "❌ Erro ao abrir “%s” e o índice “%s”: %s\n",
+                op.nome_ordenado, nome,
+                errno == EINVAL ? "índice inválido ou de outro arquivo" : strerror(errno));
+        return EXIT_FAILURE;
+    }
 
-            // Apaga os arquivos de run antigos já mesclados
-            for (size_t k = inicio; k < fim; k++) {
-                remove(runs_atuais[k]);
-                free(runs_atuais[k]);
-            }
+    uint64_t inicio;
+    uint64_t qtd = consulta_intervalo(&c, op.chave_inicial, op.chave_final, &inicio);
+    int ret = EXIT_SUCCESS;
+    if (op.nome_saida) {
+        ArquivoMon *saida = mon_fopen(op.nome_saida, "wb");
+        if (!saida ||
+            (qtd > 0 && mon_fwrite(c.registros + inicio, sizeof(RegistroDisco), qtd, saida) != qtd)) {
+            ret = EXIT_FAILURE;
         }
+        if (saida && mon_fclose(saida) != 0) ret = EXIT_FAILURE;
+        if (ret != EXIT_SUCCESS) perror("❌ Erro ao gravar os registros consultados");
+    } else {
+        for (uint64_t i = inicio; i < inicio + qtd; i++) {
+            printf("%llu\t%u\t%llu\n", (unsigned long long) c.registros[i].chave,
+                   c.registros[i].tamanho,
+                   (unsigned long long) (i * sizeof(RegistroDisco)));
+        }
+    }
+    fprintf(stderr, "✔ %llu registros com chave em [%llu, %llu], a partir da posição %llu de %llu.\n",
+            (unsigned long long) qtd, (unsigned long long) op.chave_inicial,
+            (unsigned long long) op.chave_final, (unsigned long long) inicio,
+            (unsigned long long) c.n_registros);
+    consulta_fechar(&c);
+    return ret;
+}
 
-        // Prepara o vetor runs_atuais para a próxima passada
-        free(runs_atuais);
-        runs_atuais = prox_runs;
-        qtd_runs_atuais = n_blocos;
-        passada++;
-        printf("✔ Passada %zu concluída: agora %zu runs intermediárias.\n", passada, qtd_runs_atuais);
+int main(int argc, char *argv[]) {
+    // Subcomando “consultar”: busca no arquivo ordenado por faixa de chave
+    if (argc >= 2 && strcmp(argv[1], "consultar") == 0) {
+        return executar_consulta(argc - 1, argv + 1);
     }
 
-    // Último merge (restantes ≤ MAX_RUNS_ABERTAS) → “grande_sorted.bin”
-    const char *nome_ordenado = "grande_sorted.bin";
-    if (mesclar_runs_bloco(runs_atuais, qtd_runs_atuais, nome_ordenado) < 0) {
-        fprintf(stderr, "❌ Erro no merge final de %zu runs.\n", qtd_runs_atuais);
+    // Checa parâmetros de linha de comando
+    Opcoes op;
+    if (analisar_opcoes(argc, argv, &op) < 0) {
         return EXIT_FAILURE;
     }
-    for (size_t i = 0; i < qtd_runs_atuais; i++) {
-        remove(runs_atuais[i]);
-        free(runs_atuais[i]);
+
+    const char *nome_entrada = op.nome_entrada;
+
+    // --intervalo e --limite são aplicados pela Fase 1 das runs e pelos merges
+    if ((op.filtrar_chaves || op.limite_registros > 0) && (op.chaves_densas || op.distribuicao)) {
+        fprintf(stderr, "⚠️ Aviso: --chaves-densas e --distribuicao são ignorados com "
+                        "--intervalo/--limite\n");
+        op.chaves_densas = false;
+        op.distribuicao  = false;
     }
-    free(runs_atuais);
 
-    mon_timer_stop_and_log(2);
+    // --saida -: o .tar vai para o stdout, e as mensagens, para o stderr
+    if (strcmp(op.nome_saida, MON_FLUXO) == 0 && mon_reservar_stdout() < 0) {
+        perror("❌ Erro ao reservar o stdout para o .tar");
+        return EXIT_FAILURE;
+    }
+    if (configurar_temporarios(op.dirs_temporarios, op.n_dirs_temporarios,
+                               op.tmpdir_por_espaco) < 0) {
+        return EXIT_FAILURE;
+    }
+    // Qualquer saída daqui em diante, inclusive por falha, apaga os
+    // temporários já nomeados (na de sucesso, a limpeza final já o fez)
+    atexit(remover_temporarios);
 
-    printf("✔ Fase 2 concluída: arquivo “%s” gerado.\n", nome_ordenado);
+    // max_blocos “auto”: pela folga do cgroup e pelo /proc/meminfo
+    if (op.max_blocos_auto) {
+        op.max_blocos = calcular_max_blocos_auto();
+    }
 
-    mon_timer_start();
+    // Backend de I/O: precisa ser escolhido antes de qualquer mon_fopen
+    if (mon_definir_backend(op.backend_io) < 0) {
+        fprintf(stderr, "⚠️ io_uring indisponível neste sistema; usando %s.\n",
+                mon_nome_backend());
+    }
+    mon_definir_direto(op.io_direto);
+    formato_run_definir(op.compressao);
+    if (merge_vetorial_definir(op.simd) < 0) {
+        fprintf(stderr, "⚠️ A CPU não suporta o --simd pedido; usando %s.\n",
+                merge_vetorial_nome());
+    }
 
-    // ──────────── FASE 3: Reconstrução em “reconstruido.tar” ────────────
-    FILE *arquivo_ordenado = mon_fopen(nome_ordenado, "rb");
-    if (!arquivo_ordenado) {
-        perror("❌ Erro ao abrir “grande_sorted.bin” para reconstrução");
+    // O .tar é criado antes da Fase 1: um --saida inválido falha aqui, e
+    // não depois de toda a ordenação
+    if (mesma_saida_que_entrada(&op)) {
+        fprintf(stderr, "❌ --saida '%s' é o próprio arquivo de entrada.\n", op.nome_saida);
         return EXIT_FAILURE;
     }
-    const char *nome_recon = "reconstruido.tar";
-    FILE *saida_recon = mon_fopen(nome_recon, "wb");
-    if (!saida_recon) {
-        perror("❌ Erro ao criar “reconstruido.tar”");
-        mon_fclose(arquivo_ordenado);
+    SaidaTar tar;
+    if (tar_abrir(&tar, op.nome_saida) < 0) {
+        perror("❌ Erro ao criar o .tar de saída");
         return EXIT_FAILURE;
     }
 
-    // Lê registro a registro de “grande_sorted.bin”
-    RegistroDisco reg_temp;
-    size_t total_bytes = 0;
-    while (mon_fread(&reg_temp, sizeof(RegistroDisco), 1, arquivo_ordenado) == 1) {
-        if (reg_temp.tamanho > 250) {
-            reg_temp.tamanho = 250;  // segurança extra
-        }
-        // Grava apenas pacote[0..tamanho-1] no .tar reconstruído
-        if (mon_fwrite(reg_temp.pacote, 1, reg_temp.tamanho, saida_recon) != reg_temp.tamanho) {
-            perror("❌ Erro ao escrever em “reconstruido.tar”");
-            mon_fclose(arquivo_ordenado);
-            mon_fclose(saida_recon);
+    mon_timer_start();
+
+    // ──────────── FASE 1 (--chaves-densas): Verificação das chaves ────────────
+    // Se a verificação falhar, a passagem de leitura foi o único custo e a
+    // Fase 1 segue (no mesmo cronômetro) com a geração de runs
+    if (op.chaves_densas) {
+        MapaDenso mapa;
+        int densas = verificar_chaves_densas(nome_entrada, op.max_blocos, &mapa);
+        if (densas < 0) {
+            descartar_saida(&op, &tar);
             return EXIT_FAILURE;
         }
-        total_bytes += reg_temp.tamanho;
-    }
-
-    // 1) Padding para fechar o último bloco de 512 bytes
-    size_t resto = total_bytes % 512;
-    size_t pad = (resto == 0) ? 0 : (512 - resto);
-    if (pad > 0) {
-        unsigned char *zeros = calloc(pad, 1);
-        if (!zeros) {
-            perror("❌ Falha no calloc do padding");
-            mon_fclose(arquivo_ordenado);
-            mon_fclose(saida_recon);
-            return EXIT_FAILURE;
+        if (densas == 0) {
+            mon_timer_stop_and_log(1);
+            printf("✔ Fase 1 concluída: chaves densas 0..%zu verificadas (%s).\n",
+                   mapa.n - 1, mapa.prefixo ? "somas parciais dos tamanhos"
+                                            : "todos os pacotes cheios");
+            int ret = executar_chaves_densas(&op, &mapa, &tar);
+            liberar_mapa_denso(&mapa);
+            if (ret < 0) {
+                descartar_saida(&op, &tar);
+                return EXIT_FAILURE;
+            }
+            return EXIT_SUCCESS;
         }
-        mon_fwrite(zeros, 1, pad, saida_recon);
-        free(zeros);
     }
 
-    // 2) Dois blocos de 512 bytes de zeros (fim-de-tar)
-    unsigned char bloco_zero[512] = { 0 };
-    mon_fwrite(bloco_zero, 1, 512, saida_recon);
-    mon_fwrite(bloco_zero, 1, 512, saida_recon);
+    // ──────────── FASES 1 e 2: runs + merge, ou distribuição ────────────
+    int ret_ordenacao = op.distribuicao ? ordenar_por_distribuicao(&op, &tar)
+                                        : ordenar_por_merge(&op, &tar);
+    if (ret_ordenacao < 0) {
+        descartar_saida(&op, &tar);
+        return EXIT_FAILURE;
+    }
 
-    mon_fclose(arquivo_ordenado);
-    mon_fclose(saida_recon);
+    mon_timer_start();
+
+    // ──────────── FASE 3: Fechamento do “reconstruido.tar” ────────────
+    // O conteúdo já foi gravado pelo merge final (ou pelos baldes); resta o padding do
+    // último bloco de 512 bytes e os dois blocos de zeros (fim-de-tar). Depois
+    // do merge final paralelo, o conteúdo vem antes, do “grande_sorted.bin”,
+    // em pedaços gravados em paralelo nas posições dadas pela soma dos tamanhos.
+    if (ret_ordenacao == 1) {
+        size_t max_blocos = op.max_blocos_auto ? reavaliar_max_blocos(op.max_blocos, 0, 3)
+                                               : op.max_blocos;
+        char ordenado[TAM_NOME_TEMPORARIO];
+        caminho_ordenado(&op, ordenado, sizeof(ordenado));
+        int ret_tar = tar_gravar_arquivo(&tar, ordenado, op.threads, max_blocos);
+        if (!op.manter_ordenado) remove(ordenado);
+        if (ret_tar < 0) {
+            perror("❌ Erro ao gravar o .tar de saída");
+            descartar_saida(&op, &tar);
+            return EXIT_FAILURE;
+        }
+    }
+    if (tar_fechar(&tar) < 0) {
+        perror("❌ Erro ao escrever no .tar de saída");
+        descartar_saida(&op, &tar);
+        return EXIT_FAILURE;
+    }
 
     mon_timer_stop_and_log(3);
 
     printf("✔ Fase 3 concluída: “%s” gerado (conteúdo = %zu bytes + padding = %zu bytes).\n",
-           nome_recon, total_bytes, pad + 1024);
+           op.nome_saida, tar.total_bytes, tar.padding);
     printf("✔ Ordenação Externa finalizada com sucesso!\n");
 
     // ──────────── LIMPEZA FINAL: remove arquivos temporários ────────────
-    DIR *dir = opendir(".");
-    if (dir) {
-        struct dirent *entrada;
-        while ((entrada = readdir(dir)) != NULL) {
-            // Apaga tudo que começa com “run_” ou “runInter_”
-            if (strncmp(entrada->d_name, "run_", 4) == 0 ||
-                strncmp(entrada->d_name, "runInter_", 9) == 0) {
-                if (remove(entrada->d_name) != 0) {
-                    fprintf(stderr,
-                            "⚠️ Aviso: falha ao apagar temporário “%s”\n",
-                            entrada->d_name);
-                }
-            }
-        }
-        closedir(dir);
-    }
+    // Só os temporários que esta execução nomeou (nome_temporario): nada
+    // mais nos diretórios é tocado
+    remover_temporarios();
 
     mon_log_max_fd();
     mon_log_io_stats();
+    formato_run_log();
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
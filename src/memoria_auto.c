@@ -0,0 +1,225 @@
+// Para expor sysconf(_SC_AVPHYS_PAGES)
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "memoria_auto.h"
+#include "registro.h"
+#include "ordena_chaves.h"
+
+// ► Raízes dos cgroups: v2 (hierarquia unificada) e controlador memory do v1
+#define RAIZ_CGROUP_V2 "/sys/fs/cgroup"
+#define RAIZ_CGROUP_V1 "/sys/fs/cgroup/memory"
+// ► No v1, “sem limite” é um valor próximo de 2^63 (arredondado à página)
+#define LIMITE_V1_INFINITO (UINT64_C(1) << 62)
+// ► Folga mínima deixada fora do orçamento (bytes)
+#define FOLGA_MINIMA ((uint64_t) 64 << 20)
+// ► Custo de um registro do orçamento na Fase 1: o registro e os pares
+//   (chave, índice) do bloco, mais o vetor auxiliar do radix sort
+#define BYTES_POR_REGISTRO (sizeof(RegistroDisco) + 2 * sizeof(ParChave))
+// ► Menor orçamento escolhido pelo modo “auto” (registros)
+#define MAX_BLOCOS_AUTO_MINIMO 1024
+// ► Orçamento usado quando a memória não pôde ser medida (registros)
+#define MAX_BLOCOS_AUTO_PADRAO 50000
+
+/*
+ * ➔ ler_valor:
+ *     Lê o inteiro de um arquivo de uma linha do cgroup; “max” (v2) vira
+ *     UINT64_MAX.
+ *
+ * return  0 em sucesso, -1 se o arquivo não existir ou não for numérico
+ */
+static int ler_valor(const char *caminho, uint64_t *valor) {
+    FILE *f = fopen(caminho, "r");
+    if (!f) return -1;
+    char linha[64];
+    int ret = -1;
+    if (fgets(linha, sizeof linha, f)) {
+        if (strncmp(linha, "max", 3) == 0) {
+            *valor = UINT64_MAX;
+            ret = 0;
+        } else {
+            char *fim = NULL;
+            unsigned long long v = strtoull(linha, &fim, 10);
+            if (fim != linha) {
+                *valor = (uint64_t) v;
+                ret = 0;
+            }
+        }
+    }
+    fclose(f);
+    return ret;
+}
+
+/*
+ * ➔ caminho_cgroup:
+ *     Procura em /proc/self/cgroup a linha do cgroup v2 (“0::/caminho”)
+ *     ou, com v2 = false, a do controlador memory do v1
+ *     (“N:...memory...:/caminho”) e copia o caminho.
+ *
+ * return  0 se encontrou, -1 caso contrário
+ */
+static int caminho_cgroup(bool v2, char *saida, size_t tam) {
+    FILE *f = fopen("/proc/self/cgroup", "r");
+    if (!f) return -1;
+    char linha[1024];
+    int ret = -1;
+    while (ret < 0 && fgets(linha, sizeof linha, f)) {
+        char *c1 = strchr(linha, ':');
+        char *c2 = c1 ? strchr(c1 + 1, ':') : NULL;
+        if (!c2) continue;
+        *c2 = '\0';
+        const char *controladores = c1 + 1;
+        bool achou = v2 ? (strncmp(linha, "0:", 2) == 0 && *controladores == '\0')
+                        : (strstr(controladores, "memory") != NULL);
+        if (!achou) continue;
+        char *caminho = c2 + 1;
+        caminho[strcspn(caminho, "\n")] = '\0';
+        if (strlen(caminho) < tam) {
+            strcpy(saida, caminho);
+            ret = 0;
+        }
+    }
+    fclose(f);
+    return ret;
+}
+
+/*
+ * ➔ folga_hierarquia:
+ *     Percorre o cgroup do processo e os seus ancestrais (um limite num
+ *     ancestral também vale para o processo) e guarda, entre os níveis com
+ *     limite, o de menor folga (limite − uso). Dentro de um contêiner, o
+ *     caminho de /proc/self/cgroup pode não existir sob a raiz montada;
+ *     os níveis ausentes são só pulados, até chegar à própria raiz.
+ *
+ * return  true se algum nível com limite foi encontrado
+ */
+static bool folga_hierarquia(bool v2, MedidaMemoria *m) {
+    char caminho[1024];
+    if (caminho_cgroup(v2, caminho, sizeof caminho) < 0) return false;
+
+    const char *raiz    = v2 ? RAIZ_CGROUP_V2 : RAIZ_CGROUP_V1;
+    const char *arq_max = v2 ? "memory.max" : "memory.limit_in_bytes";
+    const char *arq_uso = v2 ? "memory.current" : "memory.usage_in_bytes";
+
+    bool achou = false;
+    uint64_t menor_folga = UINT64_MAX;
+    for (;;) {
+        char arquivo[1200];
+        uint64_t limite, uso;
+        snprintf(arquivo, sizeof arquivo, "%s%s/%s", raiz, caminho, arq_max);
+        if (ler_valor(arquivo, &limite) == 0 && limite != UINT64_MAX &&
+            (v2 || limite < LIMITE_V1_INFINITO)) {
+            snprintf(arquivo, sizeof arquivo, "%s%s/%s", raiz, caminho, arq_uso);
+            if (ler_valor(arquivo, &uso) < 0) uso = 0;
+            uint64_t folga = limite > uso ? limite - uso : 0;
+            if (folga < menor_folga) {
+                menor_folga      = folga;
+                m->limite_cgroup = limite;
+                m->uso_cgroup    = uso;
+                achou = true;
+            }
+        }
+        // Sobe um nível (“/a/b” → “/a” → “”); a raiz é o último
+        char *barra = strrchr(caminho, '/');
+        if (!barra || caminho[0] == '\0') break;
+        *barra = '\0';
+    }
+    return achou;
+}
+
+/*
+ * ➔ memoria_disponivel_sistema:
+ *     MemAvailable do /proc/meminfo (memória livre mais o cache que pode
+ *     ser descartado); sem ele, as páginas livres de sysconf.
+ *
+ * return  0 em sucesso, -1 se nenhuma das duas fontes funcionar
+ */
+static int memoria_disponivel_sistema(uint64_t *bytes) {
+    FILE *f = fopen("/proc/meminfo", "r");
+    if (f) {
+        char linha[256];
+        unsigned long long kb;
+        while (fgets(linha, sizeof linha, f)) {
+            if (sscanf(linha, "MemAvailable: %llu kB", &kb) == 1) {
+                fclose(f);
+                *bytes = (uint64_t) kb * 1024;
+                return 0;
+            }
+        }
+        fclose(f);
+    }
+    long paginas = sysconf(_SC_AVPHYS_PAGES);
+    long tam_pagina = sysconf(_SC_PAGESIZE);
+    if (paginas <= 0 || tam_pagina <= 0) return -1;
+    *bytes = (uint64_t) paginas * (uint64_t) tam_pagina;
+    return 0;
+}
+
+int medir_memoria(MedidaMemoria *m) {
+    m->limite_cgroup      = UINT64_MAX;
+    m->uso_cgroup         = 0;
+    m->disponivel_sistema = UINT64_MAX;
+
+    bool cgroup = folga_hierarquia(true, m) || folga_hierarquia(false, m);
+    bool sistema = memoria_disponivel_sistema(&m->disponivel_sistema) == 0;
+    if (!cgroup && !sistema) return -1;
+
+    uint64_t folga_cgroup = UINT64_MAX;
+    if (cgroup) {
+        folga_cgroup = m->limite_cgroup > m->uso_cgroup
+                       ? m->limite_cgroup - m->uso_cgroup : 0;
+    }
+    m->disponivel = folga_cgroup < m->disponivel_sistema ? folga_cgroup
+                                                         : m->disponivel_sistema;
+    return 0;
+}
+
+size_t max_blocos_para(uint64_t disponivel) {
+    uint64_t folga = disponivel / 4 > FOLGA_MINIMA ? disponivel / 4 : FOLGA_MINIMA;
+    uint64_t utilizavel = disponivel > folga ? disponivel - folga : 0;
+    uint64_t registros = utilizavel / BYTES_POR_REGISTRO;
+    if (registros > SIZE_MAX / sizeof(RegistroDisco)) {
+        registros = SIZE_MAX / sizeof(RegistroDisco);
+    }
+    return registros < MAX_BLOCOS_AUTO_MINIMO ? MAX_BLOCOS_AUTO_MINIMO : (size_t) registros;
+}
+
+size_t calcular_max_blocos_auto(void) {
+    MedidaMemoria m;
+    if (medir_memoria(&m) < 0) {
+        fprintf(stderr, "⚠️ Memória disponível não pôde ser medida; max_blocos = %d.\n",
+                MAX_BLOCOS_AUTO_PADRAO);
+        return MAX_BLOCOS_AUTO_PADRAO;
+    }
+
+    size_t max_blocos = max_blocos_para(m.disponivel);
+    printf("➔ max_blocos auto: %zu registros (%.1f MB) de %.1f MB disponíveis",
+           max_blocos, max_blocos * (double) sizeof(RegistroDisco) / (1 << 20),
+           m.disponivel / (double) (1 << 20));
+    if (m.limite_cgroup != UINT64_MAX) {
+        printf(" (cgroup: limite %.1f MB, em uso %.1f MB)\n",
+               m.limite_cgroup / (double) (1 << 20), m.uso_cgroup / (double) (1 << 20));
+    } else {
+        printf(" (/proc/meminfo, sem limite de cgroup)\n");
+    }
+    return max_blocos;
+}
+
+size_t reavaliar_max_blocos(size_t atual, size_t em_uso, int fase) {
+    MedidaMemoria m;
+    if (medir_memoria(&m) < 0) return atual;
+
+    // Os registros ainda ocupados (o último bloco da Fase 1, só os
+    // RegistroDisco, sem os pares) já estão no uso medido: voltam ao orçamento
+    uint64_t disponivel = m.disponivel + (uint64_t) em_uso * sizeof(RegistroDisco);
+    size_t novo = max_blocos_para(disponivel);
+    if (novo >= atual) return atual;
+
+    fprintf(stderr, "⚠️ Memória disponível caiu para %.1f MB: max_blocos da Fase %d "
+                    "reduzido de %zu para %zu registros.\n",
+            m.disponivel / (double) (1 << 20), fase, atual, novo);
+    return novo;
+}
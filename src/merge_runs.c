@@ -1,10 +1,22 @@
+// Para expor pread e fstat
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
 #include "merge_runs.h"
 #include "leitor_run.h"
-#include "heap_minimo.h"
+#include "arvore_perdedores.h"
+#include "merge_vetorial.h"
 #include "monitor.h"
+#include "planejador.h"
+#include "temporarios.h"
+#include "formato_run.h"
 
 /*
  * ➔ comparar_registros:
@@ -26,95 +38,628 @@ int comparar_registros(const void *a, const void *b) {
 }
 
 /*
- * ➔ mesclar_runs_bloco:
- *     Realiza merge k-way de até MAX_RUNS_ABERTAS arquivos de run em disco.
- *
- * Passos:
- * 1) Se n_runs == 0, retorna erro imediatamente.
- * 2) Aloca um array de LeitorRun com n_runs elementos.
- * 3) Para cada run, chama inicializa_leitor() e insere o primeiro registro
- *    disponível no heap (contendo registro + id_run).
- * 4) Abre o arquivo de saída (nome_saida) em “wb”.
- * 5) Enquanto o heap não estiver vazio:
- *       • remover_raiz_heap() → nó com menor chave
- *       • grava registro (menor.registro) no arquivo de saída
- *       • avança o leitor correspondente (id_run) e, se ele ainda
- *         tiver registro, insere novo nó no heap
- * 6) Fecha o arquivo de saída e libera memória.
- *
- * param runs_entrada  Vetor de strings com nomes dos arquivos run_xxxxx.bin
- * param n_runs        Quantidade de runs a mesclar (≤ MAX_RUNS_ABERTAS)
- * param nome_saida    Nome do arquivo de saída (ex.: “runInter_00001.bin”)
- * return              •  0 em sucesso
- *                      • -1 em caso de falha (n_runs == 0, malloc, fopen, fwrite etc.)
+ * ➔ libera_merge:
+ *     Fecha os leitores ainda abertos, encerra o read-ahead e libera os
+ *     vetores de um merge.
  */
-int mesclar_runs_bloco(char **runs_entrada, size_t n_runs, const char *nome_saida) {
-    // 1) Se não houver runs para mesclar, aborta cedo
-    if (n_runs == 0) {
+static void libera_merge(LeitorRun *leitores, size_t n_runs, LeituraAntecipada *la,
+                         ArvorePerdedores *arvore, unsigned char *bloco_saida) {
+    if (leitores) {
+        for (size_t i = 0; i < n_runs; i++) {
+            fechar_leitor(&leitores[i]);
+        }
+    }
+    leitura_antecipada_destruir(la);
+    if (arvore) arvore_destruir(arvore);
+    free(bloco_saida);
+    free(leitores);
+}
+
+/*
+ * ➔ emitir_bloco:
+ *     Entrega um bloco de saída ao arquivo (se houver) e ao consumidor
+ *     (se houver). Com “posicao” (em registros), o bloco é gravado nessa
+ *     posição com escritor_run_gravar_em, e ela avança; sem ela, é
+ *     acrescentado com escritor_run_gravar. O bloco gravado passa também
+ *     pelo índice do arquivo, se houver.
+ */
+static int emitir_bloco(const unsigned char *bloco, size_t n, EscritorRun *saida,
+                        uint64_t *posicao, const ParametrosMerge *params) {
+    if (saida && params->indice) {
+        if (posicao) indice_registrar(params->indice, bloco, n, *posicao);
+        else         indice_acrescentar(params->indice, bloco, n);
+    }
+    if (saida && posicao) {
+        if (escritor_run_gravar_em(saida, bloco, n, *posicao) < 0) return -1;
+        *posicao += n;
+    } else if (saida && escritor_run_gravar(saida, bloco, n) < 0) {
+        return -1;
+    }
+    if (params->consumidor && params->consumidor(params->contexto, bloco, n) < 0) {
         return -1;
     }
+    return 0;
+}
 
-    // 2) Aloca um array de LeitorRun com n_runs elementos
-    LeitorRun *leitores = malloc(n_runs * sizeof(LeitorRun));
-    if (!leitores) return -1;
+/*
+ * ➔ lote_vencedor:
+ *     Quantos registros seguidos do bloco ativo da run vencedora “id” saem
+ *     antes da segunda colocada (chave menor, ou igual com a vencedora de
+ *     índice menor), até “maximo”: todos vão para a saída sem refazer o
+ *     torneio. O registro atual já venceu, então o lote tem ao menos 1.
+ */
+static size_t lote_vencedor(const TorneioVetorial *t, const LeitorRun *lr, size_t id,
+                            size_t segundo, size_t maximo) {
+    size_t n = leitor_disponiveis(lr);
+    if (n > maximo) n = maximo;
+    if (segundo >= t->k) return n;  // única run ativa
 
-    // Inicializa leitores para cada arquivo de run
-    for (size_t i = 0; i < n_runs; i++) {
-        inicializa_leitor(&leitores[i], runs_entrada[i]);
+    uint64_t limite = torneio_chave(t, segundo);
+    if (id < segundo) {
+        if (limite == UINT64_MAX) return n;
+        limite++;  // o empate também sai antes
     }
+    // Com runs bem intercaladas o lote quase sempre é de 1: confere o
+    // próximo registro antes de chamar o núcleo
+    if (n == 1) return 1;
+    uint64_t proxima;
+    memcpy(&proxima, lr->registro + lr->tam_registro, sizeof(proxima));
+    if (proxima >= limite) return 1;
+    return 2 + contar_abaixo(lr->registro + 2 * lr->tam_registro, lr->tam_registro, n - 2, limite);
+}
+
+/*
+ * ➔ mesclar_faixa:
+ *     O k-way merge propriamente dito, sobre as runs inteiras (inicio ==
+ *     NULL) ou só sobre os registros [inicio[i], inicio[i] + quantidade[i])
+ *     de cada run i.
+ *
+ * Passos:
+ * 1) Reparte o orçamento de memória: n_runs blocos de leitura (dois por
+ *    leitor com read-ahead) mais um bloco de saída, todos do mesmo tamanho.
+ * 2) Para cada run, chama inicializa_leitor_faixa() e monta a árvore de
+ *    perdedores com a chave do primeiro registro de cada run — ou, com
+ *    até FANIN_VETORIAL runs, o torneio vetorial (merge_vetorial.h).
+ * 3) Enquanto houver vencedor (run não esgotada):
+ *       • copia o registro atual do leitor vencedor para o bloco de saída
+ *         (gravado com uma única escrita e/ou entregue ao consumidor
+ *         quando enche); no torneio vetorial, copia de uma vez o lote de
+ *         registros seguidos que vencem a segunda colocada
+ *       • avança esse leitor e substitui a chave dele na árvore (uma
+ *         subida folha → raiz; o payload fica no bloco do leitor)
+ *    Com params->limite, o laço termina quando esse número de registros
+ *    saiu, sem ler o resto das runs: a raiz da árvore já passou de todos
+ *    os registros que importam.
+ * 4) Grava o resto do bloco de saída e libera memória.
+ *
+ * A run virtual de params (se houver) entra como a run de índice
+ * n_arquivos, depois das runs em arquivo.
+ *
+ * param saida     Arquivo de saída já aberto, ou NULL (só consumidor)
+ * param posicao   Registro onde gravar com escritor_run_gravar_em, ou NULL
+ *                 (gravação sequencial)
+ * param memoria   Orçamento deste merge, em registros
+ * return          0 em sucesso, -1 em falha
+ */
+static int mesclar_faixa(char **runs_entrada, size_t n_arquivos, const uint64_t *inicio,
+                         const uint64_t *quantidade, EscritorRun *saida, uint64_t *posicao,
+                         size_t memoria, const ParametrosMerge *params) {
+    size_t n_runs = n_arquivos + (params->run_memoria ? 1 : 0);
+
+    // 1) Tamanho de cada bloco: orçamento, menos os buffers próprios do
+    //    backend nos arquivos abertos, / (blocos de leitura + saída)
+    size_t blocos_por_leitor = params->leitura_antecipada ? 2 : 1;
+    size_t extra = registros_de_buffers_io(saida ? 1 : 0, n_arquivos, params->tam_registro);
+    memoria = memoria > extra ? memoria - extra : 0;
+    size_t por_bloco = memoria / (n_runs * blocos_por_leitor + 1);
+    if (por_bloco == 0) por_bloco = 1;
 
-    // 3) Aloca heap (array de NoHeap) de tamanho n_runs
-    NoHeap *heap = malloc(n_runs * sizeof(NoHeap));
-    if (!heap) {
+    LeitorRun *leitores = calloc(n_runs, sizeof(LeitorRun));
+    uint64_t  *chaves   = malloc(n_runs * sizeof(uint64_t));
+    bool      *ativas   = malloc(n_runs * sizeof(bool));
+    size_t tam = params->tam_registro;
+    unsigned char *bloco_saida = malloc(por_bloco * tam);
+    LeituraAntecipada *la = NULL;
+    if (params->leitura_antecipada && leitores) {
+        la = leitura_antecipada_criar(n_runs);
+    }
+    if (!leitores || !chaves || !ativas || !bloco_saida ||
+        (params->leitura_antecipada && !la)) {
+        free(chaves);
+        free(ativas);
+        libera_merge(NULL, 0, la, NULL, bloco_saida);
         free(leitores);
         return -1;
     }
-    size_t tamanho_heap = 0;
-    inicializa_heap(heap, &tamanho_heap);
 
-    // Insere o primeiro registro de cada leitor no heap
+    // 2) Inicializa leitores para cada arquivo de run
+    int ok = 0;
     for (size_t i = 0; i < n_runs; i++) {
-        if (leitores[i].tem_reg) {
-            NoHeap no = { .registro = leitores[i].registro, .id_run = i };
-            inserir_heap(heap, &tamanho_heap, no);
+        uint64_t primeiro = inicio ? inicio[i] : 0;
+        uint64_t qtd      = inicio ? quantidade[i] : UINT64_MAX;
+        if (i == n_arquivos) {
+            // Run virtual: lida direto da memória
+            if (!inicio) qtd = params->n_run_memoria;
+            inicializa_leitor_memoria(&leitores[i],
+                                      (const unsigned char *) params->run_memoria + primeiro * tam,
+                                      (size_t) qtd, tam);
+        } else if (inicializa_leitor_faixa(&leitores[i], runs_entrada[i], tam, por_bloco, la,
+                                    primeiro, qtd) < 0) {
+            ok = -1;
         }
+        chaves[i] = leitores[i].tem_reg ? leitor_chave(&leitores[i]) : 0;
+        ativas[i] = leitores[i].tem_reg;
     }
 
-    // 4) Abre arquivo de saída para gravação binária
-    FILE *saida = mon_fopen(nome_saida, "wb");
-    if (!saida) {
-        free(heap);
-        free(leitores);
+    // Monta a árvore de perdedores (ou o torneio vetorial, com fan-in
+    // pequeno) com a primeira chave de cada run
+    bool vetorial = n_runs <= FANIN_VETORIAL;
+    ArvorePerdedores arvore;
+    TorneioVetorial torneio;
+    if (ok == 0 && vetorial) {
+        torneio_inicializar(&torneio, chaves, ativas, n_runs);
+    } else if (ok == 0) {
+        ok = arvore_inicializar(&arvore, chaves, ativas, n_runs);
+    }
+    free(chaves);
+    free(ativas);
+    if (ok < 0) {
+        libera_merge(leitores, n_runs, la, NULL, bloco_saida);
         return -1;
     }
+    ArvorePerdedores *a = vetorial ? NULL : &arvore;
 
-    // 5) Loop principal: retira o menor elemento e grava no arquivo de saída
-    while (tamanho_heap > 0) {
-        // Remove raiz (menor chave)
-        NoHeap menor = remover_raiz_heap(heap, &tamanho_heap);
+    // 3) Loop principal: copia o registro (ou o lote) da run vencedora e
+    //    refaz o torneio, até “faltam” registros terem saído
+    size_t na_saida = 0;
+    uint64_t faltam = params->limite ? params->limite : UINT64_MAX;
+    while (1) {
+        size_t id, n = 1;
+        if (vetorial) {
+            size_t segundo;
+            id = torneio_vencedor(&torneio, &segundo);
+            if (id >= n_runs) break;
+            size_t maximo = por_bloco - na_saida;
+            if (maximo > faltam) maximo = (size_t) faltam;
+            n = lote_vencedor(&torneio, &leitores[id], id, segundo, maximo);
+        } else {
+            id = arvore_vencedor(&arvore);
+            if (id >= n_runs) break;
+        }
+        memcpy(bloco_saida + na_saida * tam, leitores[id].registro, n * tam);
+        na_saida += n;
+        faltam   -= n;
+        if (na_saida == por_bloco) {
+            if (emitir_bloco(bloco_saida, na_saida, saida, posicao, params) < 0) {
+                libera_merge(leitores, n_runs, la, a, bloco_saida);
+                return -1;
+            }
+            na_saida = 0;
+        }
+        if (faltam == 0) break;  // sem avançar o leitor: nada mais é lido
 
-        // Grava registro no arquivo de saída
-        if (mon_fwrite(&menor.registro, sizeof(RegistroDisco), 1, saida) != 1) {
-            mon_fclose(saida);
-            free(heap);
-            free(leitores);
+        // Avança o leitor da run de origem e recoloca sua chave na árvore;
+        // um leitor que fechou por erro de leitura (e não pelo fim da run)
+        // aborta o merge em vez de truncar a saída
+        avancar_leitor_varios(&leitores[id], n);
+        if (!leitores[id].tem_reg && leitores[id].erro != 0) {
+            errno = leitores[id].erro;
+            perror("❌ Erro de leitura numa run do merge");
+            libera_merge(leitores, n_runs, la, a, bloco_saida);
             return -1;
         }
+        uint64_t chave = leitores[id].tem_reg ? leitor_chave(&leitores[id]) : 0;
+        if (vetorial) {
+            torneio_substituir(&torneio, id, chave, leitores[id].tem_reg);
+        } else {
+            arvore_substituir(&arvore, chave, leitores[id].tem_reg);
+        }
+    }
+
+    // 4) Grava o resto do bloco de saída e libera recursos
+    int ret = 0;
+    if (na_saida > 0 && emitir_bloco(bloco_saida, na_saida, saida, posicao, params) < 0) {
+        ret = -1;
+    }
+    libera_merge(leitores, n_runs, la, a, bloco_saida);
+    return ret;
+}
+
+// ───────────────────────────── Merge paralelo ─────────────────────────────
 
-        // Avança o leitor da run de origem
-        size_t id = menor.id_run;
-        avancar_leitor(&leitores[id]);
+// ► Menor quantidade de registros por thread que justifica repartir um merge
+#define REGISTROS_MINIMOS_POR_FAIXA 4096
+
+/*
+ * ▪ RunCorte:
+ *   Run aberta só para localizar os limites das faixas: cada consulta da
+ *   busca binária lê uma chave com pread, sem mapear o arquivo (as páginas
+ *   tocadas pelas buscas somariam ao RSS quase a run inteira). A run
+ *   virtual é consultada direto na memória.
+ */
+typedef struct {
+    int                  fd;       // ➔ -1 na run virtual
+    const unsigned char *memoria;  // ➔ registros da run virtual (ou NULL)
+    uint64_t             n;        // ➔ registros
+    int                  erro;     // ➔ errno da primeira leitura que falhou
+} RunCorte;
+
+static inline uint64_t chave_em(RunCorte *r, uint64_t i, size_t tam) {
+    uint64_t chave = 0;
+    if (r->memoria) {
+        memcpy(&chave, r->memoria + i * tam, sizeof(chave));
+    } else if (pread(r->fd, &chave, sizeof(chave), (off_t) (i * tam)) != (ssize_t) sizeof(chave)
+               && r->erro == 0) {
+        r->erro = errno ? errno : EIO;
+    }
+    return chave;
+}
+
+/*
+ * ➔ contar_chaves:
+ *     Registros da run com chave < k (menores == true) ou ≤ k (false).
+ */
+static uint64_t contar_chaves(RunCorte *r, uint64_t k, bool menores, size_t tam) {
+    uint64_t lo = 0, hi = r->n;
+    size_t consultas = 0;
+    while (lo < hi) {
+        uint64_t meio = lo + (hi - lo) / 2;
+        uint64_t c = chave_em(r, meio, tam);
+        if (menores ? (c < k) : (c <= k)) lo = meio + 1;
+        else                              hi = meio;
+        consultas++;
+    }
+    if (!r->memoria) mon_contar_bytes_lidos(consultas * sizeof(uint64_t));
+    return lo;
+}
 
-        // Se o leitor ainda tiver registro, insere novo nó no heap
-        if (leitores[id].tem_reg) {
-            NoHeap novo = { .registro = leitores[id].registro, .id_run = id };
-            inserir_heap(heap, &tamanho_heap, novo);
+/*
+ * ➔ cortar_no_posto:
+ *     Limites exatos das runs para que os registros antes deles sejam os
+ *     “posto” primeiros da saída do merge serial: acha a menor chave K com
+ *     ao menos “posto” registros ≤ K e reparte as cópias de K entre as runs
+ *     na ordem delas, como a árvore de perdedores (empate → menor run).
+ */
+static void cortar_no_posto(RunCorte *runs, size_t n_runs, size_t tam,
+                            uint64_t posto, uint64_t *corte) {
+    uint64_t lo = 0, hi = UINT64_MAX;
+    while (lo < hi) {
+        uint64_t meio = lo + (hi - lo) / 2;
+        uint64_t ate = 0;
+        for (size_t r = 0; r < n_runs && ate < posto; r++) {
+            ate += contar_chaves(&runs[r], meio, false, tam);
         }
+        if (ate >= posto) hi = meio;
+        else              lo = meio + 1;
     }
 
-    // 6) Libera recursos
-    mon_fclose(saida);
-    free(heap);
-    free(leitores);
+    uint64_t faltam = posto;
+    for (size_t r = 0; r < n_runs; r++) {
+        corte[r] = contar_chaves(&runs[r], lo, true, tam);
+        faltam -= corte[r];
+    }
+    for (size_t r = 0; r < n_runs && faltam > 0; r++) {
+        uint64_t iguais = contar_chaves(&runs[r], lo, false, tam) - corte[r];
+        uint64_t pega = iguais < faltam ? iguais : faltam;
+        corte[r] += pega;
+        faltam   -= pega;
+    }
+}
+
+/*
+ * ➔ abrir_runs_corte:
+ *     Abre as runs para as consultas de cortar_no_posto; retorna o total
+ *     de registros, ou UINT64_MAX em falha (nada fica aberto).
+ */
+static uint64_t abrir_runs_corte(char **nomes, size_t n_runs, size_t tam, RunCorte *runs) {
+    uint64_t total = 0;
+    for (size_t r = 0; r < n_runs; r++) {
+        runs[r] = (RunCorte) { open(nomes[r], O_RDONLY), NULL, 0, 0 };
+        struct stat st;
+        if (runs[r].fd < 0 || fstat(runs[r].fd, &st) != 0 || st.st_size < 0) {
+            for (size_t j = 0; j <= r; j++) {
+                if (runs[j].fd >= 0) close(runs[j].fd);
+            }
+            return UINT64_MAX;
+        }
+        runs[r].n = (uint64_t) st.st_size / tam;
+        total += runs[r].n;
+    }
+    return total;
+}
+
+/*
+ * ➔ fechar_runs_corte:
+ *     Fecha as runs abertas por abrir_runs_corte e libera o vetor.
+ */
+static void fechar_runs_corte(RunCorte *runs, size_t n_arquivos) {
+    for (size_t r = 0; r < n_arquivos; r++) close(runs[r].fd);
+    free(runs);
+}
+
+/*
+ * ▪ TrabalhoFaixa:
+ *   Uma faixa de chaves do merge paralelo: os registros [inicio[r],
+ *   inicio[r] + quantidade[r]) de cada run r, gravados a partir do
+ *   registro “posicao” do arquivo de saída.
+ */
+typedef struct {
+    char                  **runs;
+    size_t                  n_runs;       // ➔ runs em arquivo (+ a virtual de params)
+    const uint64_t         *inicio;
+    const uint64_t         *quantidade;
+    EscritorRun            *saida;
+    uint64_t                posicao;      // ➔ em registros
+    size_t                  memoria;
+    const ParametrosMerge  *params;
+    int                     ret;
+} TrabalhoFaixa;
+
+static void *thread_faixa(void *arg) {
+    TrabalhoFaixa *t = arg;
+    t->ret = mesclar_faixa(t->runs, t->n_runs, t->inicio, t->quantidade, t->saida,
+                           &t->posicao, t->memoria, t->params);
+    return NULL;
+}
+
+size_t threads_merge_paralelo(size_t n_runs, uint64_t total_registros,
+                              const ParametrosMerge *params) {
+    // Runs comprimidas não se leem por faixas nem se gravam por posição
+    if (params->threads < 2 || n_runs == 0 || !mon_temporarios_com_pwrite() ||
+        formato_run_compressao() != COMPRESSAO_NENHUMA) {
+        return 1;
+    }
+    size_t k = calcular_fan_in(params->memoria_registros, params->tam_registro,
+                               params->leitura_antecipada, NULL);
+    size_t n_threads = params->threads;
+    if (n_threads > k / n_runs) n_threads = k / n_runs;
+    if (n_threads > total_registros / REGISTROS_MINIMOS_POR_FAIXA) {
+        n_threads = (size_t) (total_registros / REGISTROS_MINIMOS_POR_FAIXA);
+    }
+    return n_threads < 2 ? 1 : n_threads;
+}
+
+/*
+ * ➔ mesclar_paralelo:
+ *     Reparte o merge em T faixas de chave com o mesmo número de registros
+ *     (limites exatos, ver cortar_no_posto) e mescla cada uma numa thread,
+ *     gravando-a na sua região do arquivo de saída com mon_pwrite. A saída
+ *     é idêntica, byte a byte, à do merge serial.
+ *
+ *     T vem de threads_merge_paralelo: cada thread abre as n_runs runs e
+ *     recebe 1/T da memória, já descontados os buffers do backend.
+ *
+ * return  0 em sucesso, -1 em falha, 1 se não compensa repartir (o
+ *         chamador faz o merge serial)
+ */
+static int mesclar_paralelo(char **runs_entrada, size_t n_arquivos, const char *nome_saida,
+                            const ParametrosMerge *params) {
+    size_t n_runs = n_arquivos + (params->run_memoria ? 1 : 0);
+    size_t tam = params->tam_registro;
+
+    RunCorte *runs = malloc(n_runs * sizeof(RunCorte));
+    uint64_t total = runs ? abrir_runs_corte(runs_entrada, n_arquivos, tam, runs) : UINT64_MAX;
+    if (total == UINT64_MAX) {
+        free(runs);
+        return 1;
+    }
+    if (params->run_memoria) {
+        runs[n_arquivos] = (RunCorte) { -1, params->run_memoria, params->n_run_memoria, 0 };
+        total += params->n_run_memoria;
+    }
+    if (params->limite && params->limite < total) total = params->limite;
+    size_t n_threads = threads_merge_paralelo(n_runs, total, params);
+
+    // cortes[t × n_runs + r]: 1º registro da run r que pertence à faixa t
+    uint64_t *cortes = NULL;
+    uint64_t *quantidades = NULL;
+    TrabalhoFaixa *trabalhos = NULL;
+    pthread_t *threads = NULL;
+    if (n_threads >= 2) {
+        cortes      = malloc((n_threads + 1) * n_runs * sizeof(uint64_t));
+        quantidades = malloc(n_threads * n_runs * sizeof(uint64_t));
+        trabalhos   = calloc(n_threads, sizeof(TrabalhoFaixa));
+        threads     = malloc(n_threads * sizeof(pthread_t));
+    }
+    if (!cortes || !quantidades || !trabalhos || !threads) {
+        fechar_runs_corte(runs, n_arquivos);
+        free(cortes);
+        free(quantidades);
+        free(trabalhos);
+        free(threads);
+        return 1;
+    }
+
+    // Com --limite, a última faixa termina no registro de número limite
+    for (size_t r = 0; r < n_runs; r++) {
+        cortes[r] = 0;
+        cortes[n_threads * n_runs + r] = runs[r].n;
+    }
+    if (params->limite == total) {
+        cortar_no_posto(runs, n_runs, tam, total, &cortes[n_threads * n_runs]);
+    }
+    for (size_t t = 1; t < n_threads; t++) {
+        cortar_no_posto(runs, n_runs, tam, total * t / n_threads, &cortes[t * n_runs]);
+    }
+    int erro = 0;
+    for (size_t r = 0; r < n_arquivos && erro == 0; r++) erro = runs[r].erro;
+    fechar_runs_corte(runs, n_arquivos);
+
+    // A saída é aberta só depois dos cortes: threads_merge_paralelo já
+    // garantiu que os temporários têm mon_pwrite (sem O_DIRECT) e que as
+    // runs não são comprimidas
+    EscritorRun *saida = NULL;
+    if (erro != 0) {
+        errno = erro;
+        perror("❌ Erro de leitura numa run do merge");
+    } else {
+        saida = escritor_run_abrir(nome_saida, tam, COMPRESSAO_NENHUMA);
+    }
+    if (!saida) {
+        free(cortes);
+        free(quantidades);
+        free(trabalhos);
+        free(threads);
+        return -1;
+    }
+
+    // Cada thread grava a partir da soma dos registros das faixas anteriores
+    int ret = 0;
+    size_t iniciadas = 0;
+    for (size_t t = 0; t < n_threads; t++) {
+        TrabalhoFaixa *tf = &trabalhos[t];
+        uint64_t antes = 0;
+        for (size_t r = 0; r < n_runs; r++) {
+            quantidades[t * n_runs + r] = cortes[(t + 1) * n_runs + r] - cortes[t * n_runs + r];
+            antes += cortes[t * n_runs + r];
+        }
+        *tf = (TrabalhoFaixa) {
+            .runs       = runs_entrada,
+            .n_runs     = n_arquivos,
+            .inicio     = &cortes[t * n_runs],
+            .quantidade = &quantidades[t * n_runs],
+            .saida      = saida,
+            .posicao    = antes,
+            .memoria    = params->memoria_registros / n_threads,
+            .params     = params,
+        };
+        if (pthread_create(&threads[t], NULL, thread_faixa, tf) != 0) {
+            ret = -1;
+            break;
+        }
+        iniciadas++;
+    }
+    for (size_t t = 0; t < iniciadas; t++) {
+        pthread_join(threads[t], NULL);
+        if (trabalhos[t].ret < 0) ret = -1;
+    }
+    if (escritor_run_fechar(saida) != 0) ret = -1;
+
+    free(cortes);
+    free(quantidades);
+    free(trabalhos);
+    free(threads);
+    return ret;
+}
+
+/*
+ * ➔ mesclar_runs_bloco:
+ *     Realiza merge k-way de até fan-in arquivos de run em disco: em
+ *     paralelo por faixas de chave quando params->threads > 1 e não há
+ *     consumidor (mesclar_paralelo), senão com mesclar_faixa sobre as runs
+ *     inteiras.
+ *
+ * param runs_entrada  Vetor de strings com nomes dos arquivos run_xxxxx.bin
+ * param n_runs        Quantidade de runs em arquivo (a virtual de params, se
+ *                     houver, é mesclada depois delas)
+ * param nome_saida    Nome do arquivo de saída (ex.: “runInter_00001.bin”)
+ *                     ou NULL, se params->consumidor receber a saída
+ * param params        Orçamento de memória e modo de leitura
+ * return              •  0 em sucesso
+ *                      • -1 em caso de falha (n_runs == 0, malloc, fopen, fwrite etc.)
+ */
+int mesclar_runs_bloco(char **runs_entrada, size_t n_runs, const char *nome_saida,
+                       const ParametrosMerge *params) {
+    // Se não houver runs para mesclar (ou destino), aborta cedo
+    if ((n_runs == 0 && !params->run_memoria) || (!nome_saida && !params->consumidor)) {
+        return -1;
+    }
+
+    // A ordem de entrega ao consumidor é serial: só merges sem ele são repartidos
+    if (params->threads > 1 && nome_saida && !params->consumidor) {
+        int ret = mesclar_paralelo(runs_entrada, n_runs, nome_saida, params);
+        if (ret <= 0) return ret;
+    }
+
+    // Só as runs (runInter_) saem no formato de --compressao; o arquivo
+    // ordenado do merge final é sempre o vetor de registros
+    EscritorRun *saida = NULL;
+    if (nome_saida) {
+        saida = escritor_run_abrir(nome_saida, params->tam_registro,
+                                   params->saida_run ? formato_run_compressao()
+                                                     : COMPRESSAO_NENHUMA);
+        if (!saida) return -1;
+    }
+    int ret = mesclar_faixa(runs_entrada, n_runs, NULL, NULL, saida, NULL,
+                            params->memoria_registros, params);
+    if (saida && escritor_run_fechar(saida) != 0) ret = -1;
+    return ret;
+}
+
+/*
+ * ➔ alocar_nomes:
+ *     Vetor de qtd nomes de run, num único bloco (liberar com free).
+ */
+static char **alocar_nomes(size_t qtd) {
+    size_t tam = tam_maximo_temporario();
+    char **nomes = malloc(qtd * (sizeof(char *) + tam));
+    if (!nomes) return NULL;
+    char *buf = (char *) (nomes + qtd);
+    for (size_t i = 0; i < qtd; i++) nomes[i] = buf + tam * i;
+    return nomes;
+}
+
+int executar_merges_intermediarios(const PlanoMerge *plano, const ParametrosMerge *params) {
+    if (plano->n_passos == 0) return 0;
+    size_t tam_nome = tam_maximo_temporario();
+    char **nomes = alocar_nomes(plano->fan_in);
+    if (!nomes) {
+        fprintf(stderr, "❌ Falha no malloc dos nomes de runs\n");
+        return -1;
+    }
+
+    // Os merges intermediários só gravam runInter_: o consumidor é do final
+    ParametrosMerge intermediario = *params;
+    intermediario.consumidor    = NULL;
+    intermediario.contexto      = NULL;
+    intermediario.run_memoria   = NULL;
+    intermediario.n_run_memoria = 0;
+    intermediario.saida_run     = true;
+
+    char nome_saida[TAM_NOME_TEMPORARIO];
+    for (size_t i = 0; i < plano->n_passos; i++) {
+        const PassoMerge *passo = &plano->passos[i];
+        for (size_t j = 0; j < passo->qtd; j++) {
+            nome_run_plano(plano, plano->entradas[passo->primeira + j], nomes[j], tam_nome);
+        }
+        nome_run_plano(plano, passo->saida, nome_saida, sizeof(nome_saida));
+
+        if (mesclar_runs_bloco(nomes, passo->qtd, nome_saida, &intermediario) < 0) {
+            fprintf(stderr, "❌ Erro em mesclar_runs_bloco (merge %zu de %zu)\n",
+                    i + 1, plano->n_passos);
+            free(nomes);
+            return -1;
+        }
+
+        // Apaga os arquivos de run já mesclados
+        for (size_t j = 0; j < passo->qtd; j++) {
+            remove(nomes[j]);
+        }
+    }
+    free(nomes);
     return 0;
 }
+
+int executar_merge_final(const PlanoMerge *plano, const char *nome_saida,
+                         const ParametrosMerge *params) {
+    size_t tam_nome = tam_maximo_temporario();
+    char **nomes = alocar_nomes(plano->n_final);
+    if (!nomes) {
+        fprintf(stderr, "❌ Falha no malloc dos nomes de runs\n");
+        return -1;
+    }
+    // A run virtual (último id do plano) não tem arquivo
+    size_t n_arquivos = plano->n_final - (params->run_memoria ? 1 : 0);
+    for (size_t j = 0; j < n_arquivos; j++) {
+        nome_run_plano(plano, plano->final[j], nomes[j], tam_nome);
+    }
+
+    int ret = mesclar_runs_bloco(nomes, n_arquivos, nome_saida, params);
+    if (ret == 0) {
+        for (size_t j = 0; j < n_arquivos; j++) {
+            remove(nomes[j]);
+        }
+    }
+    free(nomes);
+    return ret;
+}
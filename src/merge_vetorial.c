@@ -0,0 +1,317 @@
+#include <string.h>
+#include "merge_vetorial.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define MERGE_VETORIAL_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * Cada nível tem dois núcleos:
+ *   • minimos: máscara das posições de TorneioVetorial.chaves que têm a
+ *     menor chave (bit i = chaves[i] é mínima) e, em *segundas, as que têm
+ *     a menor chave entre as demais — numa só passada, sem sair dos
+ *     registradores
+ *   • gravar:  troca chaves[run], lendo e gravando o vetor inteiro que a
+ *     contém
+ *   • contar:  contar_abaixo
+ * As chaves do torneio já vêm com o sinal invertido (comparação com
+ * sinal); as dos registros, não: o contar do SSE4.2 e do AVX2 as inverte.
+ */
+typedef uint32_t (*NucleoMinimos)(const int64_t *chaves, uint32_t *segundas);
+typedef void (*NucleoGravar)(int64_t *chaves, size_t run, int64_t chave);
+typedef size_t (*NucleoContar)(const unsigned char *registros, size_t tam, size_t n,
+                               uint64_t limite);
+
+_Static_assert(FANIN_VETORIAL == 16, "os núcleos vetoriais supõem 16 chaves");
+
+// ─────────────────────────────── Escalar ───────────────────────────────
+
+static uint32_t minimos_escalar(const int64_t *chaves, uint32_t *segundas) {
+    int64_t m1 = INT64_MAX, m2 = INT64_MAX;
+    for (size_t i = 0; i < FANIN_VETORIAL; i++) {
+        if (chaves[i] < m1) {
+            m2 = m1;
+            m1 = chaves[i];
+        } else if (chaves[i] > m1 && chaves[i] < m2) {
+            m2 = chaves[i];
+        }
+    }
+    uint32_t mascara = 0, mascara2 = 0;
+    for (size_t i = 0; i < FANIN_VETORIAL; i++) {
+        if (chaves[i] == m1) mascara |= UINT32_C(1) << i;
+        else if (chaves[i] == m2) mascara2 |= UINT32_C(1) << i;
+    }
+    *segundas = mascara2;
+    return mascara;
+}
+
+static void gravar_escalar(int64_t *chaves, size_t run, int64_t chave) {
+    chaves[run] = chave;
+}
+
+static size_t contar_escalar(const unsigned char *registros, size_t tam, size_t n,
+                             uint64_t limite) {
+    size_t i = 0;
+    for (; i < n; i++) {
+        uint64_t chave;
+        memcpy(&chave, registros + i * tam, sizeof(chave));
+        if (chave >= limite) break;
+    }
+    return i;
+}
+
+#ifdef MERGE_VETORIAL_X86
+
+// ─────────────────────────────── SSE4.2 ────────────────────────────────
+
+__attribute__((target("sse4.2")))
+static inline __m128i min_sse42(__m128i a, __m128i b) {
+    return _mm_blendv_epi8(a, b, _mm_cmpgt_epi64(a, b));
+}
+
+__attribute__((target("sse4.2")))
+static inline __m128i reduzir_sse42(__m128i a, __m128i b, __m128i c, __m128i d,
+                                    __m128i e, __m128i f, __m128i g, __m128i h) {
+    __m128i m = min_sse42(min_sse42(min_sse42(a, b), min_sse42(c, d)),
+                          min_sse42(min_sse42(e, f), min_sse42(g, h)));
+    return min_sse42(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+// Bits das posições de v iguais a m, a partir do bit “desloc”
+#define IGUAIS_SSE42(v, m, desloc) \
+    ((uint32_t) _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64((v), (m)))) << (desloc))
+
+__attribute__((target("sse4.2")))
+static uint32_t minimos_sse42(const int64_t *chaves, uint32_t *segundas) {
+    const __m128i *p = (const __m128i *) chaves;
+    __m128i a = _mm_load_si128(p),     b = _mm_load_si128(p + 1);
+    __m128i c = _mm_load_si128(p + 2), d = _mm_load_si128(p + 3);
+    __m128i e = _mm_load_si128(p + 4), f = _mm_load_si128(p + 5);
+    __m128i g = _mm_load_si128(p + 6), h = _mm_load_si128(p + 7);
+    __m128i m = reduzir_sse42(a, b, c, d, e, f, g, h);
+    uint32_t mascara = IGUAIS_SSE42(a, m, 0)  | IGUAIS_SSE42(b, m, 2)  |
+                       IGUAIS_SSE42(c, m, 4)  | IGUAIS_SSE42(d, m, 6)  |
+                       IGUAIS_SSE42(e, m, 8)  | IGUAIS_SSE42(f, m, 10) |
+                       IGUAIS_SSE42(g, m, 12) | IGUAIS_SSE42(h, m, 14);
+
+    // As posições mínimas viram a maior chave (INT64_MAX) e uma segunda
+    // redução dá a menor chave das demais
+    const __m128i maior = _mm_set1_epi64x(INT64_MAX);
+    a = _mm_blendv_epi8(a, maior, _mm_cmpeq_epi64(a, m));
+    b = _mm_blendv_epi8(b, maior, _mm_cmpeq_epi64(b, m));
+    c = _mm_blendv_epi8(c, maior, _mm_cmpeq_epi64(c, m));
+    d = _mm_blendv_epi8(d, maior, _mm_cmpeq_epi64(d, m));
+    e = _mm_blendv_epi8(e, maior, _mm_cmpeq_epi64(e, m));
+    f = _mm_blendv_epi8(f, maior, _mm_cmpeq_epi64(f, m));
+    g = _mm_blendv_epi8(g, maior, _mm_cmpeq_epi64(g, m));
+    h = _mm_blendv_epi8(h, maior, _mm_cmpeq_epi64(h, m));
+    m = reduzir_sse42(a, b, c, d, e, f, g, h);
+    uint32_t mascara2 = IGUAIS_SSE42(a, m, 0)  | IGUAIS_SSE42(b, m, 2)  |
+                        IGUAIS_SSE42(c, m, 4)  | IGUAIS_SSE42(d, m, 6)  |
+                        IGUAIS_SSE42(e, m, 8)  | IGUAIS_SSE42(f, m, 10) |
+                        IGUAIS_SSE42(g, m, 12) | IGUAIS_SSE42(h, m, 14);
+    *segundas = mascara2 & ~mascara;
+    return mascara;
+}
+
+__attribute__((target("sse4.2")))
+static void gravar_sse42(int64_t *chaves, size_t run, int64_t chave) {
+    __m128i *p = (__m128i *) chaves + run / 2;
+    __m128i posicao = _mm_cmpeq_epi64(_mm_set1_epi64x((long long) (run % 2)), _mm_set_epi64x(1, 0));
+    _mm_store_si128(p, _mm_blendv_epi8(_mm_load_si128(p), _mm_set1_epi64x(chave), posicao));
+}
+
+__attribute__((target("sse4.2")))
+static size_t contar_sse42(const unsigned char *registros, size_t tam, size_t n,
+                           uint64_t limite) {
+    const __m128i sinal = _mm_set1_epi64x(INT64_MIN);
+    const __m128i lim = _mm_xor_si128(_mm_set1_epi64x((long long) limite), sinal);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        uint64_t c0, c1;
+        memcpy(&c0, registros + i * tam, sizeof(c0));
+        memcpy(&c1, registros + (i + 1) * tam, sizeof(c1));
+        __m128i c = _mm_xor_si128(_mm_set_epi64x((long long) c1, (long long) c0), sinal);
+        int abaixo = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(lim, c)));
+        if (abaixo != 0x3) return i + (size_t) __builtin_ctz((unsigned) ~abaixo);
+    }
+    return i + contar_escalar(registros + i * tam, tam, n - i, limite);
+}
+
+// ──────────────────────────────── AVX2 ─────────────────────────────────
+
+__attribute__((target("avx2")))
+static inline __m256i min_avx2(__m256i a, __m256i b) {
+    return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i reduzir_avx2(__m256i a, __m256i b, __m256i c, __m256i d) {
+    __m256i m = min_avx2(min_avx2(a, b), min_avx2(c, d));
+    // Redução horizontal: troca as metades de 128 bits e depois as chaves
+    // de cada metade; no fim todas as posições têm o mínimo
+    m = min_avx2(m, _mm256_permute4x64_epi64(m, _MM_SHUFFLE(1, 0, 3, 2)));
+    return min_avx2(m, _mm256_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+#define IGUAIS_AVX2(v, m, desloc) \
+    ((uint32_t) _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64((v), (m)))) << (desloc))
+
+__attribute__((target("avx2")))
+static uint32_t minimos_avx2(const int64_t *chaves, uint32_t *segundas) {
+    const __m256i *p = (const __m256i *) chaves;
+    __m256i a = _mm256_load_si256(p),     b = _mm256_load_si256(p + 1);
+    __m256i c = _mm256_load_si256(p + 2), d = _mm256_load_si256(p + 3);
+    __m256i m = reduzir_avx2(a, b, c, d);
+    uint32_t mascara = IGUAIS_AVX2(a, m, 0) | IGUAIS_AVX2(b, m, 4) |
+                       IGUAIS_AVX2(c, m, 8) | IGUAIS_AVX2(d, m, 12);
+
+    // Como no SSE4.2: as mínimas viram INT64_MAX para a segunda redução
+    const __m256i maior = _mm256_set1_epi64x(INT64_MAX);
+    a = _mm256_blendv_epi8(a, maior, _mm256_cmpeq_epi64(a, m));
+    b = _mm256_blendv_epi8(b, maior, _mm256_cmpeq_epi64(b, m));
+    c = _mm256_blendv_epi8(c, maior, _mm256_cmpeq_epi64(c, m));
+    d = _mm256_blendv_epi8(d, maior, _mm256_cmpeq_epi64(d, m));
+    m = reduzir_avx2(a, b, c, d);
+    uint32_t mascara2 = IGUAIS_AVX2(a, m, 0) | IGUAIS_AVX2(b, m, 4) |
+                        IGUAIS_AVX2(c, m, 8) | IGUAIS_AVX2(d, m, 12);
+    *segundas = mascara2 & ~mascara;
+    return mascara;
+}
+
+__attribute__((target("avx2")))
+static void gravar_avx2(int64_t *chaves, size_t run, int64_t chave) {
+    __m256i *p = (__m256i *) chaves + run / 4;
+    __m256i posicao = _mm256_cmpeq_epi64(_mm256_set1_epi64x((long long) (run % 4)),
+                                         _mm256_set_epi64x(3, 2, 1, 0));
+    _mm256_store_si256(p, _mm256_blendv_epi8(_mm256_load_si256(p), _mm256_set1_epi64x(chave),
+                                             posicao));
+}
+
+__attribute__((target("avx2")))
+static size_t contar_avx2(const unsigned char *registros, size_t tam, size_t n,
+                          uint64_t limite) {
+    const __m256i sinal = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i lim = _mm256_xor_si256(_mm256_set1_epi64x((long long) limite), sinal);
+    // As chaves de 4 registros seguidos, separadas por tam bytes, num gather
+    const __m256i desloc = _mm256_set_epi64x((long long) (3 * tam), (long long) (2 * tam),
+                                             (long long) tam, 0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i c = _mm256_i64gather_epi64((const long long *) (registros + i * tam), desloc, 1);
+        c = _mm256_xor_si256(c, sinal);
+        int abaixo = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(lim, c)));
+        if (abaixo != 0xF) return i + (size_t) __builtin_ctz((unsigned) ~abaixo);
+    }
+    return i + contar_escalar(registros + i * tam, tam, n - i, limite);
+}
+
+#endif // MERGE_VETORIAL_X86
+
+// ────────────────────────────── Despacho ───────────────────────────────
+
+static NucleoMinimos g_minimos = minimos_escalar;
+static NucleoGravar  g_gravar  = gravar_escalar;
+static NucleoContar  g_contar  = contar_escalar;
+static const char   *g_nome    = "escalar";
+
+/*
+ * ➔ usar:
+ *     Liga os núcleos do nível (já conferido contra a CPU).
+ */
+static void usar(NivelSimd nivel) {
+    switch (nivel) {
+#ifdef MERGE_VETORIAL_X86
+        case SIMD_AVX2:
+            g_minimos = minimos_avx2;
+            g_gravar  = gravar_avx2;
+            g_contar  = contar_avx2;
+            g_nome    = "avx2";
+            return;
+        case SIMD_SSE42:
+            g_minimos = minimos_sse42;
+            g_gravar  = gravar_sse42;
+            g_contar  = contar_sse42;
+            g_nome    = "sse4.2";
+            return;
+#endif
+        default:
+            g_minimos = minimos_escalar;
+            g_gravar  = gravar_escalar;
+            g_contar  = contar_escalar;
+            g_nome    = "escalar";
+            return;
+    }
+}
+
+/*
+ * ➔ melhor_nivel:
+ *     return  O nível mais largo que a CPU suporta
+ */
+static NivelSimd melhor_nivel(void) {
+#ifdef MERGE_VETORIAL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse4.2")) return SIMD_SSE42;
+#endif
+    return SIMD_ESCALAR;
+}
+
+int merge_vetorial_definir(NivelSimd nivel) {
+    NivelSimd melhor = melhor_nivel();
+    if (nivel == SIMD_AUTO) nivel = melhor;
+    // Os níveis vão do mais largo (AVX2) ao escalar: o pedido tem de ser
+    // igual ou mais estreito que o melhor suportado
+    if (nivel < melhor) {
+        usar(melhor);
+        return -1;
+    }
+    usar(nivel);
+    return 0;
+}
+
+const char *merge_vetorial_nome(void) {
+    return g_nome;
+}
+
+// ─────────────────────────────── Torneio ───────────────────────────────
+
+void torneio_inicializar(TorneioVetorial *t, const uint64_t *chaves, const bool *ativas,
+                         size_t k) {
+    t->k = k;
+    t->ativas = 0;
+    for (size_t i = 0; i < FANIN_VETORIAL; i++) {
+        torneio_substituir(t, i, i < k ? chaves[i] : 0, i < k && ativas[i]);
+    }
+}
+
+void torneio_substituir(TorneioVetorial *t, size_t run, uint64_t chave, bool ativa) {
+    g_gravar(t->chaves, run, (int64_t) ((ativa ? chave : UINT64_MAX) ^ (UINT64_C(1) << 63)));
+    if (ativa) t->ativas |= UINT32_C(1) << run;
+    else       t->ativas &= ~(UINT32_C(1) << run);
+}
+
+size_t torneio_vencedor(const TorneioVetorial *t, size_t *segundo) {
+    uint32_t segundas;
+    uint32_t empatadas = g_minimos(t->chaves, &segundas) & t->ativas;
+    if (empatadas == 0) {
+        *segundo = t->k;
+        return t->k;  // todas esgotadas
+    }
+    size_t vencedor = (size_t) __builtin_ctz(empatadas);
+
+    // Outra run com a mesma chave é a segunda (desempate pela menor run);
+    // senão, a menor run com a menor chave das outras. Posições esgotadas
+    // (a maior chave) só aparecem nas máscaras quando não sobra chave menor,
+    // e “ativas” as descarta
+    empatadas &= empatadas - 1;
+    if (empatadas == 0) empatadas = segundas & t->ativas;
+    *segundo = empatadas ? (size_t) __builtin_ctz(empatadas) : t->k;
+    return vencedor;
+}
+
+size_t contar_abaixo(const unsigned char *registros, size_t tam_registro, size_t n,
+                     uint64_t limite) {
+    return g_contar(registros, tam_registro, n, limite);
+}
@@ -1,49 +1,178 @@
-// Para expor clock_gettime e CLOCK_MONOTONIC (funcionalidades POSIX)
-#define _POSIX_C_SOURCE 199309L
-// Poderia também usar 200809L para uma versão mais recente do POSIX
+// Para expor clock_gettime e CLOCK_MONOTONIC (funcionalidades POSIX) e
+// madvise com MADV_WILLNEED/MADV_DONTNEED (fora do POSIX)
+#define _DEFAULT_SOURCE
 
 #include "monitor.h"
+#include "backend_io.h"
 #include <stdio.h>
-#include <time.h> // Este deve vir DEPOIS da definição de _POSIX_C_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h> // Este deve vir DEPOIS da definição de _DEFAULT_SOURCE
 
 /*
  * Implementação da biblioteca de monitoramento.
- * As variáveis de contagem são estáticas para serem privadas a este arquivo.
+ * As variáveis de contagem são estáticas para serem privadas a este arquivo
+ * e atômicas, pois as threads da Fase 1 abrem/gravam runs concorrentemente.
  */
 
 // --- Estado Interno do Monitor de Arquivos ---
-static int g_fd_count = 0;
-static int g_max_fd = 0;
+static atomic_int g_fd_count = 0;
+static atomic_int g_max_fd = 0;
+
+// Backend de I/O em uso e handle devolvido por mon_fopen
+static const OperacoesIO *g_backend = &OPERACOES_STDIO;
+// I/O direto nos temporários (mon_fopen_temporario)
+static bool g_direto = false;
+static atomic_flag g_aviso_direto = ATOMIC_FLAG_INIT;
+
+struct ArquivoMon {
+    const OperacoesIO *ops;     // ➔ backend que abriu o arquivo
+    void              *estado;  // ➔ estado privado do backend
+};
 
 // --- Estado Interno do Monitor de Tempo ---
 static struct timespec g_timer_start_ts;
 
+// Tempos ocupados dos estágios da fase atual (ver mon_registrar_estagios)
+static int    g_estagios_registrados = 0;
+static double g_estagio_leitura = 0.0;
+static double g_estagio_ordenacao = 0.0;
+static double g_estagio_escrita = 0.0;
+
 
 // --- Implementação das Funções ---
 
-FILE *mon_fopen(const char *pathname, const char *mode) {
-    FILE *f = fopen(pathname, mode);
-    if (f != NULL) {
-        g_fd_count++;
-        if (g_fd_count > g_max_fd) {
-            g_max_fd = g_fd_count;
-        }
+int mon_definir_backend(BackendIO backend) {
+    switch (backend) {
+        case MON_IO_POSIX:
+            g_backend = &OPERACOES_POSIX;
+            return 0;
+        case MON_IO_URING:
+            if (uring_inicializar() == 0) {
+                g_backend = &OPERACOES_URING;
+                return 0;
+            }
+            g_backend = &OPERACOES_POSIX;
+            return -1;
+        case MON_IO_STDIO:
+        default:
+            g_backend = &OPERACOES_STDIO;
+            return 0;
+    }
+}
+
+const char *mon_nome_backend(void) {
+    return g_backend->nome;
+}
+
+void mon_definir_direto(bool ligado) {
+    g_direto = ligado;
+}
+
+/*
+ * ➔ registrar_abertura:
+ *     Conta o descritor recém-aberto e atualiza o pico.
+ */
+static void registrar_abertura(void) {
+    int atual = atomic_fetch_add(&g_fd_count, 1) + 1;
+    int maximo = atomic_load(&g_max_fd);
+    while (atual > maximo &&
+           !atomic_compare_exchange_weak(&g_max_fd, &maximo, atual)) {
+        // maximo foi atualizado pelo CAS; tenta de novo
+    }
+}
+
+/*
+ * ➔ abrir_com:
+ *     Abre o arquivo com o backend indicado e monta o handle; a leitura
+ *     começa no offset “inicio”.
+ */
+static ArquivoMon *abrir_com(const OperacoesIO *ops, const char *pathname, const char *mode,
+                             uint64_t inicio) {
+    bool escrita = (mode[0] == 'w');
+    ArquivoMon *f = malloc(sizeof(ArquivoMon));
+    if (!f) return NULL;
+    f->ops = ops;
+    f->estado = ops->abrir(pathname, escrita, escrita ? 0 : inicio);
+    if (!f->estado) {
+        free(f);
+        return NULL;
     }
+    registrar_abertura();
     return f;
 }
 
-int mon_fclose(FILE *stream) {
-    // A contagem só deve ser decrementada se fclose for bem-sucedido (retorna 0)
-    int ret = fclose(stream);
-    if (ret == 0) {
-        g_fd_count--;
+ArquivoMon *mon_fopen(const char *pathname, const char *mode) {
+    // “-”: stdin ou stdout, que podem ser pipes; sempre sequenciais
+    if (strcmp(pathname, MON_FLUXO) == 0) {
+        return abrir_com(&OPERACOES_FLUXO, pathname, mode, 0);
     }
+    return abrir_com(g_backend, pathname, mode, 0);
+}
+
+int mon_reservar_stdout(void) {
+    fflush(stdout);
+    int fd = dup(STDOUT_FILENO);
+    if (fd < 0) return -1;
+    if (dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+        close(fd);
+        return -1;
+    }
+    fluxo_definir_saida(fd);
+    return 0;
+}
+
+ArquivoMon *mon_fopen_temporario(const char *pathname, const char *mode) {
+    return mon_fopen_temporario_em(pathname, mode, 0);
+}
+
+ArquivoMon *mon_fopen_temporario_em(const char *pathname, const char *mode, uint64_t inicio) {
+    if (g_direto) {
+        ArquivoMon *f = abrir_com(&OPERACOES_DIRETO, pathname, mode, inicio);
+        if (f || errno != EINVAL) return f;
+        if (!atomic_flag_test_and_set(&g_aviso_direto)) {
+            fprintf(stderr, "⚠️ O_DIRECT não suportado para '%s'; usando %s.\n",
+                    pathname, g_backend->nome);
+        }
+    }
+    return abrir_com(g_backend, pathname, mode, inicio);
+}
+
+bool mon_suporta_pwrite(const ArquivoMon *stream) {
+    return stream->ops->escrever_em != NULL;
+}
+
+bool mon_temporarios_com_pwrite(void) {
+    return !g_direto || OPERACOES_DIRETO.escrever_em != NULL;
+}
+
+int mon_erro_leitura(const ArquivoMon *stream) {
+    return stream->ops->erro_leitura(stream->estado);
+}
+
+size_t mon_buffer_por_arquivo(bool escrita, bool temporario) {
+    const OperacoesIO *ops = (temporario && g_direto) ? &OPERACOES_DIRETO : g_backend;
+    return escrita ? ops->buffer_escrita : ops->buffer_leitura;
+}
+
+int mon_fclose(ArquivoMon *stream) {
+    // O descritor é liberado mesmo quando uma escrita pendente falha,
+    // então a contagem é sempre decrementada
+    int ret = stream->ops->fechar(stream->estado);
+    atomic_fetch_sub(&g_fd_count, 1);
+    free(stream);
     return ret;
 }
 
 void mon_log_max_fd(void) {
     // Adiciona os 3 descritores padrão (stdin, stdout, stderr) que estão sempre abertos.
-    fprintf(stderr, "METRICA_MAX_FD: %d\n", g_max_fd + 3);
+    fprintf(stderr, "METRICA_MAX_FD: %d\n", atomic_load(&g_max_fd) + 3);
 }
 
 void mon_timer_start(void) {
@@ -58,32 +187,158 @@ void mon_timer_stop_and_log(int phase_num) {
                         (double)(timer_end_ts.tv_nsec - g_timer_start_ts.tv_nsec) / 1e9;
 
     fprintf(stderr, "METRICA_TEMPO_FASE%d: %.4f\n", phase_num, time_taken);
+
+    if (g_estagios_registrados) {
+        double soma = g_estagio_leitura + g_estagio_ordenacao + g_estagio_escrita;
+        double maior = g_estagio_leitura;
+        if (g_estagio_ordenacao > maior) maior = g_estagio_ordenacao;
+        if (g_estagio_escrita > maior) maior = g_estagio_escrita;
+
+        // Fração do tempo “escondível” (soma − maior) que de fato se sobrepôs
+        double sobreposicao = 0.0;
+        if (soma - maior > 1e-9) {
+            sobreposicao = (soma - time_taken) / (soma - maior) * 100.0;
+            if (sobreposicao < 0.0) sobreposicao = 0.0;
+            if (sobreposicao > 100.0) sobreposicao = 100.0;
+        }
+
+        fprintf(stderr, "METRICA_ESTAGIOS_FASE%d: leitura=%.4f ordenacao=%.4f escrita=%.4f\n",
+                phase_num, g_estagio_leitura, g_estagio_ordenacao, g_estagio_escrita);
+        fprintf(stderr, "METRICA_SOBREPOSICAO_FASE%d: %.1f%%\n", phase_num, sobreposicao);
+        g_estagios_registrados = 0;
+    }
+}
+
+double mon_agora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+void mon_registrar_estagios(double leitura, double ordenacao, double escrita) {
+    g_estagio_leitura = leitura;
+    g_estagio_ordenacao = ordenacao;
+    g_estagio_escrita = escrita;
+    g_estagios_registrados = 1;
 }
 
 
 // Em monitor.c, no topo com as outras variáveis estáticas:
-static size_t g_bytes_lidos = 0;
-static size_t g_bytes_escritos = 0;
+static atomic_size_t g_bytes_lidos = 0;
+static atomic_size_t g_bytes_escritos = 0;
 
 // Implementação das novas funções:
-size_t mon_fread(void *ptr, size_t size, size_t nmemb, FILE *stream) {
-    size_t lidos = fread(ptr, size, nmemb, stream);
+size_t mon_fread(void *ptr, size_t size, size_t nmemb, ArquivoMon *stream) {
+    if (size == 0 || nmemb == 0) return 0;
+    size_t lidos = stream->ops->ler(stream->estado, ptr, size * nmemb) / size;
     if (lidos > 0) {
-        g_bytes_lidos += lidos * size;
+        atomic_fetch_add(&g_bytes_lidos, lidos * size);
     }
     return lidos;
 }
 
-size_t mon_fwrite(const void *ptr, size_t size, size_t nmemb, FILE *stream) {
-    size_t escritos = fwrite(ptr, size, nmemb, stream);
+size_t mon_fwrite(const void *ptr, size_t size, size_t nmemb, ArquivoMon *stream) {
+    if (size == 0 || nmemb == 0) return 0;
+    size_t escritos = stream->ops->escrever(stream->estado, ptr, size * nmemb) / size;
     if (escritos > 0) {
-        g_bytes_escritos += escritos * size;
+        atomic_fetch_add(&g_bytes_escritos, escritos * size);
     }
     return escritos;
 }
 
+size_t mon_pwrite(const void *ptr, size_t bytes, uint64_t offset, ArquivoMon *stream) {
+    if (bytes == 0 || !stream->ops->escrever_em) return 0;
+    size_t escritos = stream->ops->escrever_em(stream->estado, ptr, bytes, offset);
+    if (escritos > 0) {
+        atomic_fetch_add(&g_bytes_escritos, escritos);
+    }
+    return escritos;
+}
+
+void mon_contar_bytes_lidos(size_t bytes) {
+    atomic_fetch_add(&g_bytes_lidos, bytes);
+}
+
+// Bytes mapeados por mon_mmap: no total, agora e no pico
+static atomic_size_t g_bytes_mapeados = 0;
+static atomic_size_t g_mapeados_agora = 0;
+static atomic_size_t g_pico_mapeado = 0;
+
+const void *mon_mmap(const char *pathname, size_t *tamanho, AcessoMapa acesso) {
+    int fd = open(pathname, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+    void *mapa = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // o mapeamento continua válido sem o descritor
+    if (mapa == MAP_FAILED) return NULL;
+    madvise(mapa, (size_t) st.st_size,
+            acesso == MON_MAPA_SEQUENCIAL ? MADV_SEQUENTIAL : MADV_RANDOM);
+
+    *tamanho = (size_t) st.st_size;
+    atomic_fetch_add(&g_bytes_mapeados, *tamanho);
+    size_t agora = atomic_fetch_add(&g_mapeados_agora, *tamanho) + *tamanho;
+    size_t pico = atomic_load(&g_pico_mapeado);
+    while (agora > pico && !atomic_compare_exchange_weak(&g_pico_mapeado, &pico, agora)) {
+        // pico foi atualizado pelo CAS; tenta de novo
+    }
+    return mapa;
+}
+
+/*
+ * ➔ paginas_inteiras:
+ *     Restringe [inicio, inicio + bytes) às páginas inteiramente contidas
+ *     nele e no mapeamento; return false se não sobrar nenhuma.
+ */
+static bool paginas_inteiras(size_t tamanho, size_t *inicio, size_t *bytes) {
+    size_t pagina = (size_t) sysconf(_SC_PAGESIZE);
+    size_t fim = *inicio + *bytes;
+    if (fim > tamanho) fim = tamanho;
+    size_t a = (*inicio + pagina - 1) / pagina * pagina;
+    size_t b = fim / pagina * pagina;
+    if (b <= a) return false;
+    *inicio = a;
+    *bytes = b - a;
+    return true;
+}
+
+void mon_mmap_antecipar(const void *mapa, size_t tamanho, size_t inicio, size_t bytes) {
+    if (inicio >= tamanho) return;
+    // WILLNEED pode começar no meio de uma página: arredonda para trás
+    size_t pagina = (size_t) sysconf(_SC_PAGESIZE);
+    size_t a = inicio / pagina * pagina;
+    if (bytes > tamanho - inicio) bytes = tamanho - inicio;
+    madvise((unsigned char *) mapa + a, bytes + (inicio - a), MADV_WILLNEED);
+}
+
+void mon_mmap_descartar(const void *mapa, size_t tamanho, size_t inicio, size_t bytes) {
+    // Só páginas inteiras: as das pontas ainda podem ser de outro bloco
+    if (!paginas_inteiras(tamanho, &inicio, &bytes)) return;
+    madvise((unsigned char *) mapa + inicio, bytes, MADV_DONTNEED);
+}
+
+void mon_munmap(const void *mapa, size_t tamanho) {
+    munmap((void *) mapa, tamanho);
+    atomic_fetch_sub(&g_mapeados_agora, tamanho);
+}
+
 void mon_log_io_stats(void) {
     // Imprime em MB para facilitar a leitura
-    fprintf(stderr, "METRICA_IO_LIDO_MB: %.2f\n", (double)g_bytes_lidos / 1024 / 1024);
-    fprintf(stderr, "METRICA_IO_ESCRITO_MB: %.2f\n", (double)g_bytes_escritos / 1024 / 1024);
+    fprintf(stderr, "METRICA_IO_LIDO_MB: %.2f\n", (double)atomic_load(&g_bytes_lidos) / 1024 / 1024);
+    fprintf(stderr, "METRICA_IO_ESCRITO_MB: %.2f\n", (double)atomic_load(&g_bytes_escritos) / 1024 / 1024);
+    if (atomic_load(&g_bytes_mapeados) > 0) {
+        fprintf(stderr, "METRICA_MMAP_MB: %.2f\n", (double)atomic_load(&g_bytes_mapeados) / 1024 / 1024);
+        fprintf(stderr, "METRICA_MMAP_PICO_MB: %.2f\n", (double)atomic_load(&g_pico_mapeado) / 1024 / 1024);
+    }
+    if (g_direto) {
+        fprintf(stderr, "METRICA_POOL_DIRETO_MB: %.2f\n", (double)direto_bytes_pool() / 1024 / 1024);
+    }
 }
\ No newline at end of file
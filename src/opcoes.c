@@ -0,0 +1,351 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "opcoes.h"
+
+/*
+ * ➔ ler_inteiro_positivo:
+ *     Converte texto em inteiro positivo (base 10), rejeitando sobras.
+ *
+ * return  •  0 em sucesso (valor em *saida)
+ *          • -1 se o texto não for um inteiro positivo válido
+ */
+static int ler_inteiro_positivo(const char *texto, size_t *saida) {
+    char *fim = NULL;
+    errno = 0;
+    long long v = strtoll(texto, &fim, 10);
+    if (errno != 0 || fim == texto || *fim != '\0' || v <= 0) {
+        return -1;
+    }
+    *saida = (size_t) v;
+    return 0;
+}
+
+/*
+ * ➔ ler_intervalo:
+ *     Converte “a” ou “a:b” (inteiros sem sinal, base 10) na faixa
+ *     inclusiva [a, b] (b = a sem “:b”).
+ *
+ * return  •  0 em sucesso
+ *          • -1 se o texto for inválido ou b < a
+ */
+static int ler_intervalo(const char *texto, uint64_t *a, uint64_t *b) {
+    char *fim = NULL;
+    errno = 0;
+    if (*texto < '0' || *texto > '9') return -1;
+    unsigned long long v = strtoull(texto, &fim, 10);
+    if (errno != 0 || fim == texto) return -1;
+    *a = *b = (uint64_t) v;
+    if (*fim == '\0') return 0;
+    if (*fim != ':') return -1;
+
+    const char *resto = fim + 1;
+    if (*resto < '0' || *resto > '9') return -1;
+    v = strtoull(resto, &fim, 10);
+    if (errno != 0 || *fim != '\0' || (uint64_t) v < *a) return -1;
+    *b = (uint64_t) v;
+    return 0;
+}
+
+void imprimir_uso(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s <arquivo_entrada> <max_blocos_em_memoria> [opções]\n"
+            "     %s consultar <grande_sorted.bin> <chave>[:<chave_final>] [--saida ARQUIVO|-]\n"
+            "       (busca pelo índice “.idx” gravado com --manter-ordenado)\n"
+            "  <arquivo_entrada>       : ex.: misturado-grande.vet, ou - (stdin)\n"
+            "  <max_blocos_em_memoria> : quantos registros (264 bytes cada)\n"
+            "                            cabem em RAM simultaneamente, ou auto\n"
+            "                            (pelo limite do cgroup e pelo /proc/meminfo,\n"
+            "                            com folga; reduzido entre as fases se o\n"
+            "                            limite baixar).\n"
+            "Opções:\n"
+            "  --saida ARQUIVO|-             : .tar gerado (padrão: reconstruido.tar);\n"
+            "                                  - grava no stdout, e as mensagens vão\n"
+            "                                  para o stderr\n"
+            "  --tmpdir DIR                  : diretório das runs e dos demais\n"
+            "                                  temporários (padrão: o atual); repetida,\n"
+            "                                  reparte os temporários entre os diretórios\n"
+            "  --tmpdir-politica rodizio|espaco : com vários --tmpdir, rodízio (padrão)\n"
+            "                                  ou proporcional ao espaço livre de cada um\n"
+            "  --ordenacao intro|radix|quick : algoritmo da Fase 1 (padrão: intro)\n"
+            "  --bits-radix 8|11             : bits por passagem do radix (padrão: 8)\n"
+            "  --threads N                   : ordena N blocos da Fase 1 em paralelo,\n"
+            "                                  dividindo max_blocos entre eles (padrão: 1)\n"
+            "  --pipeline                    : sobrepõe leitura, ordenação e escrita da\n"
+            "                                  Fase 1 com N + 2 buffers em rotação\n"
+            "  --geracao blocos|selecao      : runs de max_blocos registros (padrão) ou\n"
+            "                                  seleção por substituição (~2x maiores)\n"
+            "  --leitura-antecipada          : no merge, cada run ganha um segundo bloco\n"
+            "                                  recarregado por uma thread de read-ahead\n"
+            "  --io stdio|posix|uring        : backend de I/O dos arquivos (padrão: stdio);\n"
+            "                                  uring submete leituras e escritas em lote\n"
+            "  --direto                      : O_DIRECT nas runs e no arquivo ordenado,\n"
+            "                                  com um pool de buffers alinhados\n"
+            "  --manter-ordenado             : grava também grande_sorted.bin (o merge\n"
+            "                                  final escreve direto no .tar)\n"
+            "  --somente-chaves              : runs e merge só com (chave, offset), 16\n"
+            "                                  bytes cada; o payload é lido do .vet no fim\n"
+            "  --chaves-densas               : chaves 0..N-1 sem lacunas: cada pacote é\n"
+            "                                  gravado direto na sua posição do .tar, sem\n"
+            "                                  runs (se a verificação falhar, ordena normal)\n"
+            "  --distribuicao                : sample sort: espalha a entrada em baldes por\n"
+            "                                  faixa de chave e ordena cada balde em memória\n"
+            "                                  (--threads baldes em paralelo)\n"
+            "  --compressao nenhuma|delta|lz : formato das runs: registros inteiros (padrão),\n"
+            "                                  chaves em delta/varint e pacotes aparados, ou\n"
+            "                                  isso comprimido por LZ (merges em série)\n"
+            "  --mmap                        : a Fase 1 mapeia a entrada e ordena blocos que\n"
+            "                                  apontam para o mapeamento, sem copiá-los\n"
+            "  --simd auto|avx2|sse4.2|escalar : instruções do torneio vetorial dos merges\n"
+            "                                  com até 16 runs (padrão: o melhor da CPU)\n"
+            "  --intervalo A:B               : só os registros com chave em [A, B] (ou só\n"
+            "                                  A), descartados os outros já na Fase 1\n"
+            "  --limite K                    : grava só os K primeiros registros da ordem\n"
+            "                                  (K pequeno: um heap de K, sem runs)\n",
+            prog, prog
+    );
+}
+
+int analisar_opcoes(int argc, char *argv[], Opcoes *op) {
+    memset(op, 0, sizeof(*op));
+    op->ordenacao  = ORDENACAO_INTROSORT;
+    op->bits_radix = 8;
+    op->threads    = 1;
+    op->geracao    = GERACAO_BLOCOS;
+    op->backend_io = MON_IO_STDIO;
+    op->compressao = COMPRESSAO_NENHUMA;
+    op->simd       = SIMD_AUTO;
+    op->nome_saida = "reconstruido.tar";
+
+    const char *posicionais[2] = { NULL, NULL };
+    int qtd_posicionais = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+
+        if (strncmp(arg, "--", 2) != 0) {
+            if (qtd_posicionais >= 2) {
+                fprintf(stderr, "Erro: argumento inesperado “%s”.\n", arg);
+                return -1;
+            }
+            posicionais[qtd_posicionais++] = arg;
+            continue;
+        }
+
+        // Opções sem valor
+        if (strcmp(arg, "--pipeline") == 0) {
+            op->pipeline = true;
+            continue;
+        }
+        if (strcmp(arg, "--leitura-antecipada") == 0) {
+            op->leitura_antecipada = true;
+            continue;
+        }
+        if (strcmp(arg, "--direto") == 0) {
+            op->io_direto = true;
+            continue;
+        }
+        if (strcmp(arg, "--manter-ordenado") == 0) {
+            op->manter_ordenado = true;
+            continue;
+        }
+        if (strcmp(arg, "--somente-chaves") == 0) {
+            op->somente_chaves = true;
+            continue;
+        }
+        if (strcmp(arg, "--chaves-densas") == 0) {
+            op->chaves_densas = true;
+            continue;
+        }
+        if (strcmp(arg, "--distribuicao") == 0) {
+            op->distribuicao = true;
+            continue;
+        }
+        if (strcmp(arg, "--mmap") == 0) {
+            op->entrada_mmap = true;
+            continue;
+        }
+
+        // As demais opções recebem um valor no argumento seguinte
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Erro: a opção “%s” precisa de um valor.\n", arg);
+            return -1;
+        }
+        const char *valor = argv[++i];
+
+        if (strcmp(arg, "--ordenacao") == 0) {
+            if (strcmp(valor, "intro") == 0) {
+                op->ordenacao = ORDENACAO_INTROSORT;
+            } else if (strcmp(valor, "radix") == 0) {
+                op->ordenacao = ORDENACAO_RADIX;
+            } else if (strcmp(valor, "quick") == 0) {
+                op->ordenacao = ORDENACAO_QUICKSORT;
+            } else {
+                fprintf(stderr, "Erro: --ordenacao deve ser intro, radix ou quick.\n");
+                return -1;
+            }
+        } else if (strcmp(arg, "--bits-radix") == 0) {
+            size_t bits;
+            if (ler_inteiro_positivo(valor, &bits) < 0 || (bits != 8 && bits != 11)) {
+                fprintf(stderr, "Erro: --bits-radix deve ser 8 ou 11.\n");
+                return -1;
+            }
+            op->bits_radix = (unsigned) bits;
+        } else if (strcmp(arg, "--geracao") == 0) {
+            if (strcmp(valor, "blocos") == 0) {
+                op->geracao = GERACAO_BLOCOS;
+            } else if (strcmp(valor, "selecao") == 0) {
+                op->geracao = GERACAO_SELECAO;
+            } else {
+                fprintf(stderr, "Erro: --geracao deve ser blocos ou selecao.\n");
+                return -1;
+            }
+        } else if (strcmp(arg, "--io") == 0) {
+            if (strcmp(valor, "stdio") == 0) {
+                op->backend_io = MON_IO_STDIO;
+            } else if (strcmp(valor, "posix") == 0) {
+                op->backend_io = MON_IO_POSIX;
+            } else if (strcmp(valor, "uring") == 0) {
+                op->backend_io = MON_IO_URING;
+            } else {
+                fprintf(stderr, "Erro: --io deve ser stdio, posix ou uring.\n");
+                return -1;
+            }
+        } else if (strcmp(arg, "--compressao") == 0) {
+            if (strcmp(valor, "nenhuma") == 0) {
+                op->compressao = COMPRESSAO_NENHUMA;
+            } else if (strcmp(valor, "delta") == 0) {
+                op->compressao = COMPRESSAO_DELTA;
+            } else if (strcmp(valor, "lz") == 0) {
+                op->compressao = COMPRESSAO_LZ;
+            } else {
+                fprintf(stderr, "Erro: --compressao deve ser nenhuma, delta ou lz.\n");
+                return -1;
+            }
+        } else if (strcmp(arg, "--simd") == 0) {
+            if (strcmp(valor, "auto") == 0) {
+                op->simd = SIMD_AUTO;
+            } else if (strcmp(valor, "avx2") == 0) {
+                op->simd = SIMD_AVX2;
+            } else if (strcmp(valor, "sse4.2") == 0) {
+                op->simd = SIMD_SSE42;
+            } else if (strcmp(valor, "escalar") == 0) {
+                op->simd = SIMD_ESCALAR;
+            } else {
+                fprintf(stderr, "Erro: --simd deve ser auto, avx2, sse4.2 ou escalar.\n");
+                return -1;
+            }
+        } else if (strcmp(arg, "--saida") == 0) {
+            op->nome_saida = valor;
+        } else if (strcmp(arg, "--tmpdir") == 0) {
+            if (op->n_dirs_temporarios >= MAX_DIRETORIOS_TEMPORARIOS) {
+                fprintf(stderr, "Erro: --tmpdir aceita no máximo %d diretórios.\n",
+                        MAX_DIRETORIOS_TEMPORARIOS);
+                return -1;
+            }
+            op->dirs_temporarios[op->n_dirs_temporarios++] = valor;
+        } else if (strcmp(arg, "--tmpdir-politica") == 0) {
+            if (strcmp(valor, "rodizio") == 0) {
+                op->tmpdir_por_espaco = false;
+            } else if (strcmp(valor, "espaco") == 0) {
+                op->tmpdir_por_espaco = true;
+            } else {
+                fprintf(stderr, "Erro: --tmpdir-politica deve ser rodizio ou espaco.\n");
+                return -1;
+            }
+        } else if (strcmp(arg, "--intervalo") == 0) {
+            if (ler_intervalo(valor, &op->chave_inicial, &op->chave_final) < 0) {
+                fprintf(stderr, "Erro: --intervalo deve ser <chave> ou <chave>:<chave_final>, "
+                                "com chave_final ≥ chave.\n");
+                return -1;
+            }
+            op->filtrar_chaves = true;
+        } else if (strcmp(arg, "--limite") == 0) {
+            if (ler_inteiro_positivo(valor, &op->limite_registros) < 0) {
+                fprintf(stderr, "Erro: --limite deve ser inteiro positivo.\n");
+                return -1;
+            }
+        } else if (strcmp(arg, "--threads") == 0) {
+            if (ler_inteiro_positivo(valor, &op->threads) < 0) {
+                fprintf(stderr, "Erro: --threads deve ser inteiro positivo.\n");
+                return -1;
+            }
+        } else {
+            fprintf(stderr, "Erro: opção desconhecida “%s”.\n", arg);
+            return -1;
+        }
+    }
+
+    if (qtd_posicionais < 2) {
+        imprimir_uso(argv[0]);
+        return -1;
+    }
+
+    op->nome_entrada = posicionais[0];
+    if (strcmp(posicionais[1], "auto") == 0) {
+        // Calculado em main, pela memória do cgroup e do sistema
+        op->max_blocos_auto = true;
+    } else if (ler_inteiro_positivo(posicionais[1], &op->max_blocos) < 0) {
+        fprintf(stderr, "Erro: <max_blocos_em_memoria> deve ser inteiro positivo ou auto.\n");
+        return -1;
+    }
+
+    // O stdin só pode ser lido uma vez, do início ao fim, e o stdout só
+    // aceita gravação sequencial
+    if (strcmp(op->nome_entrada, MON_FLUXO) == 0 &&
+        (op->somente_chaves || op->chaves_densas || op->distribuicao)) {
+        fprintf(stderr, "Erro: --somente-chaves, --chaves-densas e --distribuicao "
+                        "releem a entrada e não aceitam “-” (stdin).\n");
+        return -1;
+    }
+    if (strcmp(op->nome_entrada, MON_FLUXO) == 0 && op->entrada_mmap) {
+        fprintf(stderr, "Erro: --mmap precisa de um arquivo de entrada, não “-” (stdin).\n");
+        return -1;
+    }
+    if (strcmp(op->nome_saida, MON_FLUXO) == 0 && op->chaves_densas) {
+        fprintf(stderr, "Erro: --chaves-densas grava o .tar fora de ordem e não "
+                        "aceita --saida - (stdout).\n");
+        return -1;
+    }
+    return 0;
+}
+
+int analisar_consulta(int argc, char *argv[], OpcoesConsulta *op) {
+    memset(op, 0, sizeof(*op));
+    const char *posicionais[2] = { NULL, NULL };
+    int qtd_posicionais = 0;
+
+    // argv[0] é o próprio “consultar”
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--saida") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Erro: a opção “--saida” precisa de um valor.\n");
+                return -1;
+            }
+            op->nome_saida = argv[++i];
+        } else if (strncmp(arg, "--", 2) == 0) {
+            fprintf(stderr, "Erro: opção desconhecida “%s”.\n", arg);
+            return -1;
+        } else if (qtd_posicionais >= 2) {
+            fprintf(stderr, "Erro: argumento inesperado “%s”.\n", arg);
+            return -1;
+        } else {
+            posicionais[qtd_posicionais++] = arg;
+        }
+    }
+
+    if (qtd_posicionais < 2) {
+        fprintf(stderr, "Uso: consultar <grande_sorted.bin> <chave>[:<chave_final>] "
+                        "[--saida ARQUIVO|-]\n");
+        return -1;
+    }
+    op->nome_ordenado = posicionais[0];
+    if (ler_intervalo(posicionais[1], &op->chave_inicial, &op->chave_final) < 0) {
+        fprintf(stderr, "Erro: a faixa deve ser <chave> ou <chave>:<chave_final>, "
+                        "com chave_final ≥ chave.\n");
+        return -1;
+    }
+    return 0;
+}
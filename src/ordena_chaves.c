@@ -0,0 +1,307 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ordena_chaves.h"
+#include "quicksort.h"
+#include "monitor.h"
+
+// ► Trechos com até este número de pares vão direto para o insertion sort
+#define LIMIAR_INSERCAO 16
+// ► A partir deste tamanho o pivô é escolhido pelo ninther (mediana de 9)
+#define LIMIAR_NINTHER 128
+// ► Registros juntados em memória antes de cada gravação na run
+#define REGISTROS_POR_GRAVACAO 256
+
+/*
+ * ➔ par_menor:
+ *     Compara dois pares por (chave, indice). Como os índices são únicos,
+ *     nunca existem dois pares iguais.
+ */
+static inline int par_menor(const ParChave *a, const ParChave *b) {
+    if (a->chave != b->chave) return a->chave < b->chave;
+    return a->indice < b->indice;
+}
+
+/*
+ * ➔ troca_pares:
+ *     Troca dois pares (16 bytes cada) no vetor.
+ */
+static inline void troca_pares(ParChave *v, size_t i, size_t j) {
+    ParChave tmp = v[i];
+    v[i] = v[j];
+    v[j] = tmp;
+}
+
+/*
+ * ➔ ordena_tres:
+ *     Deixa v[a] ≤ v[b] ≤ v[c] (rede de ordenação de 3 elementos).
+ */
+static void ordena_tres(ParChave *v, size_t a, size_t b, size_t c) {
+    if (par_menor(&v[b], &v[a])) troca_pares(v, a, b);
+    if (par_menor(&v[c], &v[b])) troca_pares(v, b, c);
+    if (par_menor(&v[b], &v[a])) troca_pares(v, a, b);
+}
+
+/*
+ * ➔ insercao:
+ *     Insertion sort em v[esq..dir) — usado nos trechos pequenos.
+ */
+static void insercao(ParChave *v, size_t esq, size_t dir) {
+    for (size_t i = esq + 1; i < dir; i++) {
+        ParChave x = v[i];
+        size_t j = i;
+        while (j > esq && par_menor(&x, &v[j - 1])) {
+            v[j] = v[j - 1];
+            j--;
+        }
+        v[j] = x;
+    }
+}
+
+/*
+ * ➔ descer_pares / heapsort_pares:
+ *     Heapsort (max-heap) em v[esq..dir), usado quando o introsort atinge
+ *     o limite de profundidade. Garante O(n log n) no pior caso.
+ */
+static void descer_pares(ParChave *v, size_t n, size_t i) {
+    ParChave x = v[i];
+    while (1) {
+        size_t filho = 2 * i + 1;
+        if (filho >= n) break;
+        if (filho + 1 < n && par_menor(&v[filho], &v[filho + 1])) filho++;
+        if (!par_menor(&x, &v[filho])) break;
+        v[i] = v[filho];
+        i = filho;
+    }
+    v[i] = x;
+}
+
+static void heapsort_pares(ParChave *v, size_t esq, size_t dir) {
+    ParChave *base = v + esq;
+    size_t n = dir - esq;
+    for (size_t i = n / 2; i-- > 0; ) {
+        descer_pares(base, n, i);
+    }
+    for (size_t fim = n - 1; fim > 0; fim--) {
+        troca_pares(base, 0, fim);
+        descer_pares(base, fim, 0);
+    }
+}
+
+/*
+ * ➔ escolhe_pivo:
+ *     Coloca em v[esq] a mediana de três (início, meio, fim) ou, em trechos
+ *     grandes, o ninther de Tukey. Entradas já ordenadas ou invertidas
+ *     deixam de ser o pior caso do quicksort.
+ */
+static void escolhe_pivo(ParChave *v, size_t esq, size_t dir) {
+    size_t n = dir - esq;
+    size_t meio = esq + n / 2;
+    if (n >= LIMIAR_NINTHER) {
+        size_t passo = n / 8;
+        ordena_tres(v, esq, esq + passo, esq + 2 * passo);
+        ordena_tres(v, meio - passo, meio, meio + passo);
+        ordena_tres(v, dir - 1 - 2 * passo, dir - 1 - passo, dir - 1);
+        ordena_tres(v, esq + passo, meio, dir - 1 - passo);
+    } else {
+        ordena_tres(v, esq, meio, dir - 1);
+    }
+    troca_pares(v, esq, meio);
+}
+
+/*
+ * ➔ particao_hoare:
+ *     Particiona v[esq..dir) em torno do pivô v[esq] e devolve a posição
+ *     final do pivô. Todos os pares são distintos (desempate por índice),
+ *     então não há tratamento especial para chaves repetidas.
+ */
+static size_t particao_hoare(ParChave *v, size_t esq, size_t dir) {
+    ParChave pivo = v[esq];
+    size_t i = esq;
+    size_t j = dir;
+    while (1) {
+        do { i++; } while (i < dir && par_menor(&v[i], &pivo));
+        do { j--; } while (par_menor(&pivo, &v[j]));
+        if (i >= j) break;
+        troca_pares(v, i, j);
+    }
+    troca_pares(v, esq, j);
+    return j;
+}
+
+/*
+ * ➔ introsort_rec:
+ *     Recursão apenas no lado menor e laço no lado maior: a pilha fica em
+ *     O(log n) mesmo antes do limite de profundidade ser atingido.
+ */
+static void introsort_rec(ParChave *v, size_t esq, size_t dir, unsigned profundidade) {
+    while (dir - esq > LIMIAR_INSERCAO) {
+        if (profundidade == 0) {
+            heapsort_pares(v, esq, dir);
+            return;
+        }
+        profundidade--;
+
+        escolhe_pivo(v, esq, dir);
+        size_t p = particao_hoare(v, esq, dir);
+
+        if (p - esq < dir - (p + 1)) {
+            introsort_rec(v, esq, p, profundidade);
+            esq = p + 1;
+        } else {
+            introsort_rec(v, p + 1, dir, profundidade);
+            dir = p;
+        }
+    }
+    insercao(v, esq, dir);
+}
+
+void extrair_pares(const RegistroDisco *vetor, size_t n, ParChave *pares) {
+    for (size_t i = 0; i < n; i++) {
+        pares[i].chave  = vetor[i].chave;
+        pares[i].indice = i;
+    }
+}
+
+void introsort_pares(ParChave *pares, size_t n) {
+    if (pares == NULL || n < 2) return;
+    unsigned log2n = 0;
+    for (size_t m = n; m > 1; m >>= 1) log2n++;
+    introsort_rec(pares, 0, n, 2 * log2n);
+}
+
+void radix_pares(ParChave *pares, ParChave *aux, size_t n, unsigned bits_digito) {
+    if (pares == NULL || aux == NULL || n < 2) return;
+    if (bits_digito == 0 || bits_digito > 16) bits_digito = 8;
+
+    const size_t   baldes    = (size_t) 1 << bits_digito;
+    const uint64_t mascara   = baldes - 1;
+    const unsigned passagens = (64 + bits_digito - 1) / bits_digito;
+
+    size_t *hist = calloc(passagens * baldes, sizeof(size_t));
+    if (!hist) {
+        // Sem memória para os histogramas: recorre ao introsort
+        introsort_pares(pares, n);
+        return;
+    }
+
+    // 1) Histogramas de todos os dígitos numa única leitura
+    for (size_t i = 0; i < n; i++) {
+        uint64_t c = pares[i].chave;
+        for (unsigned d = 0; d < passagens; d++) {
+            hist[d * baldes + ((c >> (d * bits_digito)) & mascara)]++;
+        }
+    }
+
+    // 2) Uma passagem de distribuição estável por dígito não trivial
+    ParChave *origem = pares;
+    ParChave *destino = aux;
+    for (unsigned d = 0; d < passagens; d++) {
+        size_t *h = &hist[d * baldes];
+        unsigned desloc = d * bits_digito;
+
+        // Todos os pares têm o mesmo dígito: a passagem não mudaria nada
+        if (h[(origem[0].chave >> desloc) & mascara] == n) continue;
+
+        // Contagens → posições iniciais (soma de prefixos exclusiva)
+        size_t soma = 0;
+        for (size_t b = 0; b < baldes; b++) {
+            size_t c = h[b];
+            h[b] = soma;
+            soma += c;
+        }
+        for (size_t i = 0; i < n; i++) {
+            destino[h[(origem[i].chave >> desloc) & mascara]++] = origem[i];
+        }
+
+        ParChave *tmp = origem;
+        origem = destino;
+        destino = tmp;
+    }
+
+    // O resultado final precisa estar em “pares”
+    if (origem != pares) {
+        memcpy(pares, origem, n * sizeof(ParChave));
+    }
+    free(hist);
+}
+
+void ordenar_pares_bloco(const RegistroDisco *vetor, size_t n, ParChave *pares, ParChave *aux,
+                         MetodoOrdenacao metodo, unsigned bits_digito) {
+    if (n == 0) return;
+    extrair_pares(vetor, n, pares);
+    if (metodo == ORDENACAO_RADIX) {
+        radix_pares(pares, aux, n, bits_digito);
+    } else {
+        introsort_pares(pares, n);
+    }
+}
+
+void ordenar_bloco(RegistroDisco *vetor, size_t n, ParChave *pares, ParChave *aux,
+                   MetodoOrdenacao metodo, unsigned bits_digito) {
+    if (n == 0) return;
+    if (metodo == ORDENACAO_QUICKSORT) {
+        quicksort_registros(vetor, 0, n - 1);
+        extrair_pares(vetor, n, pares);
+        return;
+    }
+    ordenar_pares_bloco(vetor, n, pares, aux, metodo, bits_digito);
+}
+
+void permutar_registros(RegistroDisco *vetor, ParChave *pares, size_t n) {
+    RegistroDisco temp;
+    for (size_t i = 0; i < n; i++) {
+        if (pares[i].indice == i) continue;
+        // Percorre o ciclo que começa em i; cada posição preenchida é
+        // marcada com indice == posição
+        memcpy(&temp, &vetor[i], sizeof(RegistroDisco));
+        size_t j = i;
+        while (pares[j].indice != i) {
+            size_t k = pares[j].indice;
+            memcpy(&vetor[j], &vetor[k], sizeof(RegistroDisco));
+            pares[j].indice = j;
+            j = k;
+        }
+        memcpy(&vetor[j], &temp, sizeof(RegistroDisco));
+        pares[j].indice = j;
+    }
+}
+
+size_t gravar_registros_ordenados(const RegistroDisco *vetor, const ParChave *pares,
+                                  size_t n, EscritorRun *saida) {
+    RegistroDisco *bloco = malloc(REGISTROS_POR_GRAVACAO * sizeof(RegistroDisco));
+    if (!bloco) return 0;
+
+    size_t gravados = 0;
+    while (gravados < n) {
+        size_t qtd = n - gravados;
+        if (qtd > REGISTROS_POR_GRAVACAO) qtd = REGISTROS_POR_GRAVACAO;
+
+        // Junta os registros na ordem final (única cópia do payload)
+        for (size_t i = 0; i < qtd; i++) {
+            memcpy(&bloco[i], &vetor[pares[gravados + i].indice], sizeof(RegistroDisco));
+        }
+        if (escritor_run_gravar(saida, bloco, qtd) < 0) break;
+        gravados += qtd;
+    }
+
+    free(bloco);
+    return gravados;
+}
+
+size_t gravar_chaves_ordenadas(const ParChave *pares, size_t n, EscritorRun *saida) {
+    EntradaChave bloco[REGISTROS_POR_GRAVACAO];
+
+    size_t gravados = 0;
+    while (gravados < n) {
+        size_t qtd = n - gravados;
+        if (qtd > REGISTROS_POR_GRAVACAO) qtd = REGISTROS_POR_GRAVACAO;
+
+        for (size_t i = 0; i < qtd; i++) {
+            bloco[i].chave  = pares[gravados + i].chave;
+            bloco[i].offset = (uint64_t) pares[gravados + i].indice * sizeof(RegistroDisco);
+        }
+        if (escritor_run_gravar(saida, bloco, qtd) < 0) break;
+        gravados += qtd;
+    }
+    return gravados;
+}
@@ -0,0 +1,244 @@
+// Para expor getrlimit e stat
+#define _XOPEN_SOURCE 700
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include "planejador.h"
+#include "monitor.h"
+#include "temporarios.h"
+#include "formato_run.h"
+#include "merge_vetorial.h"
+
+// ► Tamanho mínimo, em bytes, de cada bloco de leitura/saída do merge (uma página)
+#define BYTES_MINIMOS_POR_BLOCO 4096
+// ► Descritores reservados: stdin/stdout/stderr, saída, .tar e folga
+#define DESCRITORES_RESERVADOS 16
+// ► Merges intermediários listados por imprimir_plano
+#define PASSOS_IMPRESSOS 10
+
+size_t registros_de_buffers_io(size_t escritores, size_t leitores, size_t tam_registro) {
+    size_t bytes = escritores * (mon_buffer_por_arquivo(true, true) + bytes_codec_por_run(true)) +
+                   leitores * (mon_buffer_por_arquivo(false, true) + bytes_codec_por_run(false));
+    return (bytes + tam_registro - 1) / tam_registro;
+}
+
+size_t calcular_fan_in(size_t memoria_registros, size_t tam_registro,
+                       bool leitura_antecipada, bool *por_memoria) {
+    // Memória: k leitores × (blocos_por_leitor + buffers do backend) + o
+    // bloco de saída e os buffers do backend no arquivo de saída
+    size_t minimo = BYTES_MINIMOS_POR_BLOCO / tam_registro;
+    size_t blocos_por_leitor = leitura_antecipada ? 2 : 1;
+    size_t extra_leitor = registros_de_buffers_io(0, 1, tam_registro);
+    size_t extra_saida  = registros_de_buffers_io(1, 0, tam_registro);
+    size_t util = memoria_registros > extra_saida + minimo
+                  ? memoria_registros - extra_saida - minimo : 0;
+    size_t k_memoria = util / (blocos_por_leitor * minimo + extra_leitor);
+
+    // Descritores: limite atual do processo menos a reserva
+    size_t k_descritores = 1024 - DESCRITORES_RESERVADOS;
+    struct rlimit lim;
+    if (getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur != RLIM_INFINITY) {
+        k_descritores = lim.rlim_cur > DESCRITORES_RESERVADOS
+                        ? (size_t) lim.rlim_cur - DESCRITORES_RESERVADOS : 2;
+    }
+
+    size_t k = k_memoria < k_descritores ? k_memoria : k_descritores;
+    if (por_memoria) *por_memoria = (k_memoria < k_descritores);
+    return k < 2 ? 2 : k;
+}
+
+// ─────────────────────── Min-heap de (tamanho, id) ───────────────────────
+
+typedef struct {
+    uint64_t tamanho;
+    size_t   id;
+} ItemPlano;
+
+static inline bool item_menor(const ItemPlano *a, const ItemPlano *b) {
+    if (a->tamanho != b->tamanho) return a->tamanho < b->tamanho;
+    return a->id < b->id;
+}
+
+static void subir_item(ItemPlano *h, size_t i) {
+    ItemPlano x = h[i];
+    while (i > 0 && item_menor(&x, &h[(i - 1) / 2])) {
+        h[i] = h[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    h[i] = x;
+}
+
+static void descer_item(ItemPlano *h, size_t n, size_t i) {
+    ItemPlano x = h[i];
+    while (1) {
+        size_t filho = 2 * i + 1;
+        if (filho >= n) break;
+        if (filho + 1 < n && item_menor(&h[filho + 1], &h[filho])) filho++;
+        if (!item_menor(&h[filho], &x)) break;
+        h[i] = h[filho];
+        i = filho;
+    }
+    h[i] = x;
+}
+
+static ItemPlano remover_menor(ItemPlano *h, size_t *n) {
+    ItemPlano menor = h[0];
+    h[0] = h[--(*n)];
+    if (*n > 0) descer_item(h, *n, 0);
+    return menor;
+}
+
+/*
+ * ➔ ordenar_por_origem:
+ *     Ordena ids (insertion sort; k é pequeno) pela menor run original
+ *     que cada um contém.
+ */
+static void ordenar_por_origem(size_t *ids, size_t n, const size_t *origem) {
+    for (size_t i = 1; i < n; i++) {
+        size_t x = ids[i];
+        size_t j = i;
+        while (j > 0 && origem[ids[j - 1]] > origem[x]) {
+            ids[j] = ids[j - 1];
+            j--;
+        }
+        ids[j] = x;
+    }
+}
+
+int planejar_merge(const uint64_t *tamanhos, size_t n_runs, size_t fan_in, PlanoMerge *plano) {
+    memset(plano, 0, sizeof(*plano));
+    plano->n_iniciais = n_runs;
+    plano->fan_in = fan_in < 2 ? 2 : fan_in;
+    size_t k = plano->fan_in;
+
+    // Cada passo junta ≥ 2 runs e reduz a contagem em ≥ 1: no máximo n−1 passos
+    size_t max_ids = 2 * n_runs;
+    ItemPlano *heap = malloc(n_runs * sizeof(ItemPlano));
+    size_t *origem  = malloc(max_ids * sizeof(size_t));
+    plano->passos   = malloc((n_runs > 1 ? n_runs - 1 : 1) * sizeof(PassoMerge));
+    plano->entradas = malloc(max_ids * sizeof(size_t));
+    plano->final    = malloc((k < n_runs ? k : n_runs) * sizeof(size_t));
+    if (!heap || !origem || !plano->passos || !plano->entradas || !plano->final) {
+        free(heap);
+        free(origem);
+        liberar_plano(plano);
+        return -1;
+    }
+
+    size_t n_heap = 0;
+    for (size_t i = 0; i < n_runs; i++) {
+        heap[n_heap] = (ItemPlano) { tamanhos[i], i };
+        subir_item(heap, n_heap++);
+        origem[i] = i;
+        plano->registros_totais += tamanhos[i];
+    }
+
+    // O primeiro merge junta só o necessário para o final ter k runs
+    size_t grupo = k;
+    if (n_runs > k && (n_runs - 1) % (k - 1) != 0) {
+        grupo = (n_runs - 1) % (k - 1) + 1;
+    }
+
+    size_t proximo_id = n_runs;
+    size_t n_entradas = 0;
+    while (n_heap > k) {
+        PassoMerge *p = &plano->passos[plano->n_passos++];
+        p->primeira  = n_entradas;
+        p->qtd       = grupo;
+        p->saida     = proximo_id++;
+        p->registros = 0;
+        origem[p->saida] = (size_t) -1;
+        for (size_t j = 0; j < grupo; j++) {
+            ItemPlano it = remover_menor(heap, &n_heap);
+            plano->entradas[n_entradas++] = it.id;
+            p->registros += it.tamanho;
+            if (origem[it.id] < origem[p->saida]) origem[p->saida] = origem[it.id];
+        }
+        ordenar_por_origem(&plano->entradas[p->primeira], grupo, origem);
+        plano->registros_regravados += p->registros;
+
+        heap[n_heap] = (ItemPlano) { p->registros, p->saida };
+        subir_item(heap, n_heap++);
+        grupo = k;
+    }
+
+    for (size_t i = 0; i < n_heap; i++) plano->final[i] = heap[i].id;
+    plano->n_final = n_heap;
+    ordenar_por_origem(plano->final, plano->n_final, origem);
+
+    free(heap);
+    free(origem);
+    return 0;
+}
+
+void nome_run_plano(const PlanoMerge *plano, size_t id, char *buf, size_t tam) {
+    if (id < plano->n_iniciais) {
+        nome_temporario(buf, tam, "run", id);
+    } else {
+        nome_temporario(buf, tam, "runInter", id - plano->n_iniciais);
+    }
+}
+
+void imprimir_plano(const PlanoMerge *plano) {
+    double regravado = plano->registros_totais
+                       ? 100.0 * (double) plano->registros_regravados / (double) plano->registros_totais
+                       : 0.0;
+    printf("✔ Plano da Fase 2: %zu runs, fan-in %zu (limite: %s), "
+           "%zu merges intermediários + merge final de %zu runs; "
+           "%.1f%% dos registros regravados antes do merge final.\n",
+           plano->n_iniciais, plano->fan_in,
+           plano->limitado_por_memoria ? "memória" : "descritores",
+           plano->n_passos, plano->n_final, regravado);
+
+    char nome[TAM_NOME_TEMPORARIO];
+    for (size_t i = 0; i < plano->n_passos && i < PASSOS_IMPRESSOS; i++) {
+        const PassoMerge *p = &plano->passos[i];
+        nome_run_plano(plano, p->saida, nome, sizeof(nome));
+        printf("   • %s ← %zu runs (%llu registros)\n",
+               nome, p->qtd, (unsigned long long) p->registros);
+    }
+    if (plano->n_passos > PASSOS_IMPRESSOS) {
+        printf("   • … mais %zu merges intermediários\n", plano->n_passos - PASSOS_IMPRESSOS);
+    }
+    if (plano->n_final <= FANIN_VETORIAL) {
+        printf("   • merge final com o torneio vetorial (%s)\n", merge_vetorial_nome());
+    }
+}
+
+int planejar_runs_em_disco(size_t n_runs, size_t memoria_registros, size_t tam_registro,
+                           bool leitura_antecipada, size_t threads, PlanoMerge *plano) {
+    uint64_t *tamanhos = malloc(n_runs * sizeof(uint64_t));
+    if (!tamanhos) return -1;
+    char nome_run[TAM_NOME_TEMPORARIO];
+    for (size_t i = 0; i < n_runs; i++) {
+        nome_temporario(nome_run, sizeof(nome_run), "run", i);
+        tamanhos[i] = registros_na_run(nome_run, tam_registro);
+    }
+
+    bool por_memoria = false;
+    size_t fan_in = calcular_fan_in(memoria_registros, tam_registro, leitura_antecipada,
+                                    &por_memoria);
+    if (threads > 1) fan_in = fan_in / threads >= 2 ? fan_in / threads : 2;
+    int ret = planejar_merge(tamanhos, n_runs, fan_in, plano);
+    free(tamanhos);
+    if (ret == 0) plano->limitado_por_memoria = por_memoria;
+    return ret;
+}
+
+void liberar_plano(PlanoMerge *plano) {
+    free(plano->passos);
+    free(plano->entradas);
+    free(plano->final);
+    plano->passos = NULL;
+    plano->entradas = NULL;
+    plano->final = NULL;
+}
+
+uint64_t registros_no_arquivo(const char *nome, size_t tam_registro) {
+    struct stat st;
+    if (stat(nome, &st) != 0 || st.st_size < 0) return 0;
+    return (uint64_t) st.st_size / tam_registro;
+}
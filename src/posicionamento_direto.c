@@ -0,0 +1,216 @@
+// Para expor stat (POSIX)
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "posicionamento_direto.h"
+#include "registro.h"
+
+// ► Registros lidos do .vet por mon_fread, nas duas passagens
+#define REGISTROS_POR_LOTE 256
+// ► Chaves por grupo das somas parciais (potência de 2)
+#define CHAVES_POR_GRUPO 64
+// ► Bytes consecutivos acumulados antes de cada mon_pwrite
+#define TAM_BUFFER_POSICIONAL (256 * 1024)
+// ► Marca de chave ainda não vista (tamanho válido vai até 250)
+#define TAMANHO_AUSENTE 255
+
+/*
+ * ▪ EscritaPosicional:
+ *   Acumula gravações de um arquivo enquanto elas caem em posições
+ *   consecutivas; uma gravação fora da sequência descarrega o buffer com
+ *   um único mon_pwrite. Entrada já quase ordenada vira poucas escritas
+ *   grandes; entrada aleatória, uma escrita por registro.
+ */
+typedef struct {
+    ArquivoMon    *arquivo;
+    unsigned char *buffer;
+    size_t         qtd;     // ➔ bytes acumulados
+    uint64_t       inicio;  // ➔ posição do 1º byte acumulado
+    bool           erro;
+} EscritaPosicional;
+
+static int descarregar(EscritaPosicional *e) {
+    if (e->qtd > 0 && mon_pwrite(e->buffer, e->qtd, e->inicio, e->arquivo) != e->qtd) {
+        e->erro = true;
+    }
+    e->qtd = 0;
+    return e->erro ? -1 : 0;
+}
+
+static void gravar_em(EscritaPosicional *e, const void *dados, size_t bytes, uint64_t posicao) {
+    if (bytes == 0 || e->erro) return;
+    if (e->qtd > 0 &&
+        (posicao != e->inicio + e->qtd || e->qtd + bytes > TAM_BUFFER_POSICIONAL)) {
+        descarregar(e);
+    }
+    if (e->qtd == 0) e->inicio = posicao;
+    memcpy(e->buffer + e->qtd, dados, bytes);
+    e->qtd += bytes;
+}
+
+/*
+ * ➔ posicao_no_tar:
+ *     Offset do pacote da chave no .tar: soma parcial do grupo mais os
+ *     tamanhos das chaves anteriores dentro dele.
+ */
+static uint64_t posicao_no_tar(const MapaDenso *mapa, uint64_t chave) {
+    if (!mapa->prefixo) return chave * 250;
+    uint64_t posicao = mapa->prefixo[chave / CHAVES_POR_GRUPO];
+    for (uint64_t k = chave & ~(uint64_t) (CHAVES_POR_GRUPO - 1); k < chave; k++) {
+        posicao += mapa->tamanhos[k];
+    }
+    return posicao;
+}
+
+void liberar_mapa_denso(MapaDenso *mapa) {
+    free(mapa->tamanhos);
+    free(mapa->prefixo);
+    mapa->tamanhos = NULL;
+    mapa->prefixo  = NULL;
+}
+
+int verificar_chaves_densas(const char *nome_entrada, size_t max_blocos, MapaDenso *mapa) {
+    memset(mapa, 0, sizeof(*mapa));
+
+    struct stat st;
+    if (stat(nome_entrada, &st) != 0) {
+        perror("❌ Erro ao consultar o arquivo de entrada");
+        return -1;
+    }
+    size_t n = (size_t) st.st_size / sizeof(RegistroDisco);
+    if (n == 0) return 1;  // as fases normais reportam a entrada vazia
+
+    size_t grupos = (n + CHAVES_POR_GRUPO - 1) / CHAVES_POR_GRUPO;
+    size_t bytes_mapa = n + grupos * sizeof(uint64_t);
+    if (bytes_mapa > max_blocos * sizeof(RegistroDisco)) {
+        fprintf(stderr, "⚠️ Mapa de chaves densas (%zu bytes) excede o orçamento de "
+                "%zu registros; usando a ordenação externa normal.\n", bytes_mapa, max_blocos);
+        return 1;
+    }
+
+    mapa->n = n;
+    mapa->tamanhos = malloc(n);
+    RegistroDisco *lote = malloc(REGISTROS_POR_LOTE * sizeof(RegistroDisco));
+    ArquivoMon *entrada = mon_fopen(nome_entrada, "rb");
+    if (!mapa->tamanhos || !lote || !entrada) {
+        perror("❌ Erro ao preparar a verificação das chaves densas");
+        if (entrada) mon_fclose(entrada);
+        free(lote);
+        liberar_mapa_denso(mapa);
+        return -1;
+    }
+    memset(mapa->tamanhos, TAMANHO_AUSENTE, n);
+
+    // 1) Cada chave deve estar em [0, N) e aparecer uma única vez; com N
+    //    registros, isso basta para não haver lacunas
+    int ret = 0;
+    bool todos_cheios = true;
+    size_t lidos_total = 0;
+    size_t lidos;
+    while (ret == 0 && lidos_total < n &&
+           (lidos = mon_fread(lote, sizeof(RegistroDisco), REGISTROS_POR_LOTE, entrada)) > 0) {
+        for (size_t i = 0; i < lidos; i++) {
+            uint64_t chave = lote[i].chave;
+            if (chave >= n) {
+                fprintf(stderr, "⚠️ Chave %llu fora de 0..%zu: chaves não densas; "
+                        "usando a ordenação externa normal.\n",
+                        (unsigned long long) chave, n - 1);
+                ret = 1;
+                break;
+            }
+            if (mapa->tamanhos[chave] != TAMANHO_AUSENTE) {
+                fprintf(stderr, "⚠️ Chave %llu repetida: chaves não densas; "
+                        "usando a ordenação externa normal.\n", (unsigned long long) chave);
+                ret = 1;
+                break;
+            }
+            uint32_t tamanho = lote[i].tamanho;
+            if (tamanho > 250) tamanho = 250;  // mesmo limite do gravador do .tar
+            if (tamanho != 250) todos_cheios = false;
+            mapa->tamanhos[chave] = (uint8_t) tamanho;
+        }
+        lidos_total += lidos;
+    }
+    mon_fclose(entrada);
+    free(lote);
+    if (ret == 0 && lidos_total < n) {
+        fprintf(stderr, "❌ Leitura incompleta de '%s' na verificação\n", nome_entrada);
+        ret = -1;
+    }
+    if (ret != 0) {
+        liberar_mapa_denso(mapa);
+        return ret;
+    }
+
+    // 2) Posições no .tar: pacotes cheios dispensam as somas parciais
+    if (todos_cheios) {
+        mapa->total_bytes = (uint64_t) n * 250;
+        return 0;
+    }
+    mapa->prefixo = malloc(grupos * sizeof(uint64_t));
+    if (!mapa->prefixo) {
+        perror("❌ Falha no malloc das somas parciais");
+        liberar_mapa_denso(mapa);
+        return -1;
+    }
+    uint64_t soma = 0;
+    for (size_t k = 0; k < n; k++) {
+        if (k % CHAVES_POR_GRUPO == 0) mapa->prefixo[k / CHAVES_POR_GRUPO] = soma;
+        soma += mapa->tamanhos[k];
+    }
+    mapa->total_bytes = soma;
+    return 0;
+}
+
+int posicionar_registros(const MapaDenso *mapa, const char *nome_entrada,
+                         ArquivoMon *tar, ArquivoMon *ordenado, IndiceEsparso *indice) {
+    EscritaPosicional saida_tar = { .arquivo = tar };
+    EscritaPosicional saida_ord = { .arquivo = ordenado };
+    RegistroDisco *lote = malloc(REGISTROS_POR_LOTE * sizeof(RegistroDisco));
+    saida_tar.buffer = malloc(TAM_BUFFER_POSICIONAL);
+    if (ordenado) saida_ord.buffer = malloc(TAM_BUFFER_POSICIONAL);
+    ArquivoMon *entrada = mon_fopen(nome_entrada, "rb");
+    if (!lote || !saida_tar.buffer || (ordenado && !saida_ord.buffer) || !entrada) {
+        perror("❌ Erro ao preparar o posicionamento direto");
+        if (entrada) mon_fclose(entrada);
+        free(lote);
+        free(saida_tar.buffer);
+        free(saida_ord.buffer);
+        return -1;
+    }
+
+    size_t restantes = mapa->n;
+    size_t lidos;
+    bool alterado = false;
+    while (restantes > 0 && !alterado && !saida_tar.erro && !saida_ord.erro &&
+           (lidos = mon_fread(lote, sizeof(RegistroDisco), REGISTROS_POR_LOTE, entrada)) > 0) {
+        if (lidos > restantes) lidos = restantes;
+        for (size_t i = 0; i < lidos; i++) {
+            uint64_t chave = lote[i].chave;
+            if (chave >= mapa->n) {  // o .vet mudou desde a verificação
+                alterado = true;
+                break;
+            }
+            gravar_em(&saida_tar, lote[i].pacote, mapa->tamanhos[chave],
+                      posicao_no_tar(mapa, chave));
+            if (ordenado) {
+                gravar_em(&saida_ord, &lote[i], sizeof(RegistroDisco),
+                          chave * sizeof(RegistroDisco));
+                if (indice) indice_registrar(indice, &lote[i], 1, chave);
+            }
+        }
+        restantes -= lidos;
+    }
+    descarregar(&saida_tar);
+    if (ordenado) descarregar(&saida_ord);
+    mon_fclose(entrada);
+
+    int ret = (restantes == 0 && !alterado && !saida_tar.erro && !saida_ord.erro) ? 0 : -1;
+    free(lote);
+    free(saida_tar.buffer);
+    free(saida_ord.buffer);
+    return ret;
+}
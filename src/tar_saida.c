@@ -0,0 +1,258 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include "tar_saida.h"
+#include "planejador.h"
+
+// ► Bytes de payload acumulados antes de cada mon_fwrite do .tar
+#define TAM_BUFFER_TAR (256 * 1024)
+// ► Tamanho do bloco do formato tar
+#define BLOCO_TAR 512
+// ► Registros lidos por mon_fread em tar_gravar_arquivo
+#define REGISTROS_POR_LEITURA 1024
+// ► Menor pedaço da reconstrução paralela (abaixo disso, abrir e gravar
+//   cada pedaço custaria mais que compactá-lo); com orçamento curto, o
+//   número de threads cai para que todas tenham ao menos esse pedaço
+#define REGISTROS_MINIMOS_POR_PEDACO 1024
+// ► Memória de cada registro do pedaço: o lido (RegistroDisco) e o
+//   pacote compactado
+#define BYTES_POR_REGISTRO_PEDACO (sizeof(RegistroDisco) + 250)
+
+/*
+ * ➔ descarregar:
+ *     Grava o buffer acumulado no arquivo.
+ */
+static int descarregar(SaidaTar *t) {
+    if (t->qtd > 0 && mon_fwrite(t->buffer, 1, t->qtd, t->arquivo) != t->qtd) {
+        t->erro = true;
+    }
+    t->qtd = 0;
+    return t->erro ? -1 : 0;
+}
+
+int tar_abrir(SaidaTar *t, const char *nome) {
+    memset(t, 0, sizeof(*t));
+    t->buffer = malloc(TAM_BUFFER_TAR);
+    if (!t->buffer) return -1;
+    t->arquivo = mon_fopen(nome, "wb");
+    if (!t->arquivo) {
+        free(t->buffer);
+        t->buffer = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+int tar_gravar_registros(void *contexto, const void *dados, size_t n) {
+    SaidaTar *t = contexto;
+    const RegistroDisco *registros = dados;
+    for (size_t i = 0; i < n && !t->erro; i++) {
+        size_t tamanho = registros[i].tamanho;
+        if (tamanho > 250) {
+            tamanho = 250;  // segurança extra
+        }
+        if (t->qtd + tamanho > TAM_BUFFER_TAR) descarregar(t);
+        memcpy(t->buffer + t->qtd, registros[i].pacote, tamanho);
+        t->qtd += tamanho;
+        t->total_bytes += tamanho;
+    }
+    return t->erro ? -1 : 0;
+}
+
+/*
+ * ➔ gravar_sequencial:
+ *     Lê o arquivo ordenado do início ao fim e repassa os registros a
+ *     tar_gravar_registros.
+ */
+static int gravar_sequencial(SaidaTar *t, const char *nome) {
+    RegistroDisco *lote = malloc(REGISTROS_POR_LEITURA * sizeof(RegistroDisco));
+    ArquivoMon *entrada = lote ? mon_fopen_temporario(nome, "rb") : NULL;
+    if (!entrada) {
+        free(lote);
+        return -1;
+    }
+    size_t lidos;
+    int ret = 0;
+    while (ret == 0 &&
+           (lidos = mon_fread(lote, sizeof(RegistroDisco), REGISTROS_POR_LEITURA, entrada)) > 0) {
+        ret = tar_gravar_registros(t, lote, lidos);
+    }
+    if (ret == 0 && mon_erro_leitura(entrada) != 0) {
+        errno = mon_erro_leitura(entrada);
+        ret = -1;
+    }
+    mon_fclose(entrada);
+    free(lote);
+    return ret;
+}
+
+/*
+ * ▪ ReconstrucaoTar:
+ *   Estado compartilhado da reconstrução paralela. Os pedaços são
+ *   distribuídos em ordem (proximo) e publicam sua posição também em
+ *   ordem: o pedaço “publicados” começa em “offset”.
+ */
+typedef struct {
+    const char     *nome;
+    ArquivoMon     *tar;
+    uint64_t        n_registros;
+    size_t          por_pedaco;   // ➔ registros por pedaço
+    size_t          n_pedacos;
+    pthread_mutex_t trava;
+    pthread_cond_t  publicou;     // ➔ “publicados” avançou (ou houve erro)
+    size_t          proximo;      // ➔ próximo pedaço a distribuir
+    size_t          publicados;   // ➔ pedaços com posição conhecida
+    uint64_t        offset;       // ➔ posição do pedaço “publicados”
+    bool            erro;
+} ReconstrucaoTar;
+
+/*
+ * ➔ reconstruir_pedacos:
+ *     Laço de cada thread: pega o próximo pedaço, lê e compacta os
+ *     pacotes, espera a posição dele, publica a do seguinte e grava.
+ */
+static void *reconstruir_pedacos(void *arg) {
+    ReconstrucaoTar *r = arg;
+    RegistroDisco *lote = malloc(r->por_pedaco * sizeof(RegistroDisco));
+    unsigned char *compacto = malloc(r->por_pedaco * 250);
+    bool falhou = !lote || !compacto;
+
+    for (;;) {
+        pthread_mutex_lock(&r->trava);
+        if (falhou && !r->erro) {
+            r->erro = true;
+            pthread_cond_broadcast(&r->publicou);
+        }
+        size_t i = r->proximo;
+        bool acabou = r->erro || i >= r->n_pedacos;
+        if (!acabou) r->proximo++;
+        pthread_mutex_unlock(&r->trava);
+        if (acabou) break;
+
+        // 1) Lê o pedaço i e junta os pacotes
+        uint64_t primeiro = (uint64_t) i * r->por_pedaco;
+        size_t qtd = r->por_pedaco;
+        if (primeiro + qtd > r->n_registros) qtd = (size_t) (r->n_registros - primeiro);
+        ArquivoMon *entrada = mon_fopen_temporario_em(r->nome, "rb",
+                                                      primeiro * sizeof(RegistroDisco));
+        size_t lidos = entrada ? mon_fread(lote, sizeof(RegistroDisco), qtd, entrada) : 0;
+        if (entrada) mon_fclose(entrada);
+        size_t bytes = 0;
+        for (size_t j = 0; j < lidos; j++) {
+            size_t tamanho = lote[j].tamanho;
+            if (tamanho > 250) tamanho = 250;  // mesmo limite de tar_gravar_registros
+            memcpy(compacto + bytes, lote[j].pacote, tamanho);
+            bytes += tamanho;
+        }
+
+        // 2) Soma em cadeia: espera a posição do pedaço i e publica a do i + 1
+        pthread_mutex_lock(&r->trava);
+        while (r->publicados != i && !r->erro) {
+            pthread_cond_wait(&r->publicou, &r->trava);
+        }
+        uint64_t posicao = r->offset;
+        if (lidos != qtd) {
+            r->erro = true;
+        } else if (!r->erro) {
+            r->offset += bytes;
+            r->publicados++;
+        }
+        pthread_cond_broadcast(&r->publicou);
+        bool abortar = r->erro;
+        pthread_mutex_unlock(&r->trava);
+        if (abortar) break;
+
+        // 3) Grava o pedaço na sua região do .tar
+        if (bytes > 0 && mon_pwrite(compacto, bytes, posicao, r->tar) != bytes) {
+            falhou = true;
+        }
+    }
+    if (falhou) {
+        pthread_mutex_lock(&r->trava);
+        r->erro = true;
+        pthread_cond_broadcast(&r->publicou);
+        pthread_mutex_unlock(&r->trava);
+    }
+    free(lote);
+    free(compacto);
+    return NULL;
+}
+
+int tar_gravar_arquivo(SaidaTar *t, const char *nome, size_t threads,
+                       size_t memoria_registros) {
+    if (threads <= 1 || t->total_bytes > 0 || t->qtd > 0 || !mon_suporta_pwrite(t->arquivo)) {
+        return gravar_sequencial(t, nome);
+    }
+
+    // threads × por_pedaco × BYTES_POR_REGISTRO_PEDACO cabe no orçamento:
+    // se nem o pedaço mínimo couber em cada thread, usa menos threads
+    size_t por_registro = BYTES_POR_REGISTRO_PEDACO;
+    size_t orcamento = memoria_registros * sizeof(RegistroDisco);
+    size_t max_threads = orcamento / (REGISTROS_MINIMOS_POR_PEDACO * por_registro);
+    if (threads > max_threads) threads = max_threads;
+    if (threads <= 1) return gravar_sequencial(t, nome);
+
+    ReconstrucaoTar r = {
+        .nome        = nome,
+        .tar         = t->arquivo,
+        .n_registros = registros_no_arquivo(nome, sizeof(RegistroDisco)),
+        .por_pedaco  = orcamento / (threads * por_registro),
+    };
+    r.n_pedacos = (size_t) ((r.n_registros + r.por_pedaco - 1) / r.por_pedaco);
+    if (threads > r.n_pedacos) threads = r.n_pedacos;
+    if (threads <= 1) return gravar_sequencial(t, nome);
+
+    pthread_t *ids = malloc(threads * sizeof(pthread_t));
+    if (!ids) return gravar_sequencial(t, nome);
+    pthread_mutex_init(&r.trava, NULL);
+    pthread_cond_init(&r.publicou, NULL);
+
+    size_t iniciadas = 0;
+    for (; iniciadas < threads; iniciadas++) {
+        if (pthread_create(&ids[iniciadas], NULL, reconstruir_pedacos, &r) != 0) break;
+    }
+    if (iniciadas == 0) r.erro = true;
+    for (size_t i = 0; i < iniciadas; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    pthread_mutex_destroy(&r.trava);
+    pthread_cond_destroy(&r.publicou);
+    free(ids);
+
+    // O final (padding e fim-de-tar) é gravado por tar_fechar logo depois do conteúdo
+    t->posicional = true;
+    t->total_bytes = (size_t) r.offset;
+    if (r.erro || r.publicados != r.n_pedacos) t->erro = true;
+    return t->erro ? -1 : 0;
+}
+
+int tar_fechar(SaidaTar *t) {
+    // 1) Padding para fechar o último bloco de 512 bytes
+    size_t resto = t->total_bytes % BLOCO_TAR;
+    size_t pad = (resto == 0) ? 0 : (BLOCO_TAR - resto);
+
+    // 2) Dois blocos de 512 bytes de zeros (fim-de-tar)
+    t->padding = pad + 2 * BLOCO_TAR;
+
+    if (t->posicional) {
+        memset(t->buffer, 0, t->padding);
+        if (!t->erro &&
+            mon_pwrite(t->buffer, t->padding, t->total_bytes, t->arquivo) != t->padding) {
+            t->erro = true;
+        }
+    } else {
+        // O buffer sempre comporta os zeros do final junto com o que restou
+        if (t->qtd + t->padding > TAM_BUFFER_TAR) descarregar(t);
+        memset(t->buffer + t->qtd, 0, t->padding);
+        t->qtd += t->padding;
+        descarregar(t);
+    }
+
+    int ret = t->erro ? -1 : 0;
+    if (mon_fclose(t->arquivo) != 0) ret = -1;
+    free(t->buffer);
+    t->arquivo = NULL;
+    t->buffer = NULL;
+    return ret;
+}
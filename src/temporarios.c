@@ -0,0 +1,223 @@
+// Para expor access e statvfs
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include "temporarios.h"
+
+// ► Maior nome de temporário acrescentado ao diretório (“runInter_xxxxx.bin”
+//   e “grande_sorted.bin” com folga, mais a barra)
+#define TAM_MAXIMO_NOME 32
+// ► Famílias de temporários registradas (run, runInter, balde e os de
+//   nome fixo)
+#define MAX_FAMILIAS 8
+
+/*
+ * ▪ FamiliaTemporarios:
+ *   Temporários de um mesmo prefixo (ou um de nome fixo, id 0) e o
+ *   diretório escolhido para cada id: dir_de[id] = índice + 1 em
+ *   g_diretorios, 0 se o id ainda não recebeu nome.
+ */
+typedef struct {
+    const char    *prefixo;     // ➔ prefixo ou nome fixo (não copiado)
+    bool           numerado;    // ➔ “<prefixo>_xxxxx.bin” ou o nome puro
+    unsigned char *dir_de;      // ➔ diretório de cada id (0 = nenhum)
+    size_t         capacidade;  // ➔ ids alocados em dir_de
+} FamiliaTemporarios;
+
+// Diretórios, pesos do rodízio e crédito de cada um (rodízio ponderado
+// suave: a cada escolha, todos ganham o peso e o escolhido perde a soma)
+static const char *g_diretorios[MAX_DIRETORIOS_TEMPORARIOS] = { "." };
+static double      g_pesos[MAX_DIRETORIOS_TEMPORARIOS]      = { 1.0 };
+static double      g_creditos[MAX_DIRETORIOS_TEMPORARIOS];
+static size_t      g_n_diretorios = 1;
+
+static FamiliaTemporarios g_familias[MAX_FAMILIAS];
+static size_t             g_n_familias = 0;
+static pthread_mutex_t    g_trava = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * ➔ conferir_diretorio:
+ *     0 se “dir” é um diretório com permissão de escrita e cabe no nome
+ *     de um temporário; -1 com errno caso contrário.
+ */
+static int conferir_diretorio(const char *dir) {
+    if (strlen(dir) + TAM_MAXIMO_NOME >= TAM_NOME_TEMPORARIO) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    struct stat st;
+    if (stat(dir, &st) != 0) return -1;
+    if (!S_ISDIR(st.st_mode)) {
+        errno = ENOTDIR;
+        return -1;
+    }
+    return access(dir, W_OK | X_OK);
+}
+
+int configurar_temporarios(const char *const *dirs, size_t n, bool por_espaco) {
+    if (n == 0) return 0;
+    if (n > MAX_DIRETORIOS_TEMPORARIOS) {
+        fprintf(stderr, "❌ --tmpdir: no máximo %d diretórios.\n", MAX_DIRETORIOS_TEMPORARIOS);
+        return -1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (conferir_diretorio(dirs[i]) < 0) {
+            fprintf(stderr, "❌ --tmpdir “%s”: %s\n", dirs[i], strerror(errno));
+            return -1;
+        }
+        for (size_t j = 0; j < i; j++) {
+            if (strcmp(dirs[i], dirs[j]) == 0) {
+                fprintf(stderr, "❌ --tmpdir “%s” repetido.\n", dirs[i]);
+                return -1;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        g_diretorios[i] = dirs[i];
+        g_creditos[i]   = 0.0;
+        g_pesos[i]      = 1.0;
+        struct statvfs sv;
+        if (por_espaco && statvfs(dirs[i], &sv) == 0) {
+            // Em MB, com mínimo de 1: um disco cheio ainda recebe algum arquivo
+            double livre = (double) sv.f_bavail * (double) sv.f_frsize / (1 << 20);
+            g_pesos[i] = livre > 1.0 ? livre : 1.0;
+        }
+    }
+    g_n_diretorios = n;
+
+    if (n > 1) {
+        double soma = 0.0;
+        for (size_t i = 0; i < n; i++) soma += g_pesos[i];
+        printf("➔ Temporários repartidos entre %zu diretórios (%s):", n,
+               por_espaco ? "pelo espaço livre" : "rodízio");
+        for (size_t i = 0; i < n; i++) {
+            printf(" %s %.0f%%%s", dirs[i], 100.0 * g_pesos[i] / soma, i + 1 < n ? "," : "\n");
+        }
+    }
+    return 0;
+}
+
+size_t tam_maximo_temporario(void) {
+    size_t maior = 0;
+    for (size_t i = 0; i < g_n_diretorios; i++) {
+        size_t n = strlen(g_diretorios[i]);
+        if (n > maior) maior = n;
+    }
+    return maior + 1 + TAM_MAXIMO_NOME;
+}
+
+/*
+ * ➔ escolher_diretorio:
+ *     Próximo diretório do rodízio ponderado suave (com pesos iguais, é o
+ *     rodízio simples). Chamada com g_trava.
+ */
+static size_t escolher_diretorio(void) {
+    if (g_n_diretorios == 1) return 0;
+    double soma = 0.0;
+    size_t melhor = 0;
+    for (size_t i = 0; i < g_n_diretorios; i++) {
+        g_creditos[i] += g_pesos[i];
+        soma += g_pesos[i];
+        if (g_creditos[i] > g_creditos[melhor]) melhor = i;
+    }
+    g_creditos[melhor] -= soma;
+    return melhor;
+}
+
+/*
+ * ➔ diretorio_de:
+ *     Diretório registrado para (prefixo, id), escolhendo e registrando um
+ *     na primeira vez. Sem memória para o registro, escolhe sem registrar
+ *     (o arquivo só não será apagado por remover_temporarios).
+ */
+static size_t diretorio_de(const char *prefixo, bool numerado, size_t id) {
+    pthread_mutex_lock(&g_trava);
+    FamiliaTemporarios *f = NULL;
+    for (size_t i = 0; i < g_n_familias && !f; i++) {
+        if (g_familias[i].numerado == numerado && strcmp(g_familias[i].prefixo, prefixo) == 0) {
+            f = &g_familias[i];
+        }
+    }
+    if (!f && g_n_familias < MAX_FAMILIAS) {
+        f = &g_familias[g_n_familias++];
+        *f = (FamiliaTemporarios) { prefixo, numerado, NULL, 0 };
+    }
+    if (f && id >= f->capacidade) {
+        size_t nova = f->capacidade ? f->capacidade : 64;
+        while (nova <= id) nova *= 2;
+        unsigned char *v = realloc(f->dir_de, nova);
+        if (v) {
+            memset(v + f->capacidade, 0, nova - f->capacidade);
+            f->dir_de = v;
+            f->capacidade = nova;
+        }
+    }
+
+    size_t dir;
+    if (f && id < f->capacidade && f->dir_de[id] != 0) {
+        dir = f->dir_de[id] - 1u;
+    } else {
+        dir = escolher_diretorio();
+        if (f && id < f->capacidade) f->dir_de[id] = (unsigned char) (dir + 1);
+    }
+    pthread_mutex_unlock(&g_trava);
+    return dir;
+}
+
+/*
+ * ➔ montar_caminho:
+ *     “<diretório>/<nome>”, ou só o nome se o diretório for o atual.
+ */
+static void montar_caminho(char *buf, size_t tam, size_t dir, const char *nome) {
+    const char *d = g_diretorios[dir];
+    if (strcmp(d, ".") == 0) {
+        snprintf(buf, tam, "%s", nome);
+        return;
+    }
+    size_t n = strlen(d);
+    bool barra = n > 0 && d[n - 1] == '/';
+    snprintf(buf, tam, "%s%s%s", d, barra ? "" : "/", nome);
+}
+
+void nome_temporario(char *buf, size_t tam, const char *prefixo, size_t id) {
+    char nome[TAM_MAXIMO_NOME];
+    snprintf(nome, sizeof(nome), "%s_%05zu.bin", prefixo, id);
+    montar_caminho(buf, tam, diretorio_de(prefixo, true, id), nome);
+}
+
+void caminho_temporario(char *buf, size_t tam, const char *nome) {
+    montar_caminho(buf, tam, diretorio_de(nome, false, 0), nome);
+}
+
+void remover_temporarios(void) {
+    char caminho[TAM_NOME_TEMPORARIO];
+    char nome[TAM_MAXIMO_NOME];
+    pthread_mutex_lock(&g_trava);
+    for (size_t i = 0; i < g_n_familias; i++) {
+        FamiliaTemporarios *f = &g_familias[i];
+        for (size_t id = 0; id < f->capacidade; id++) {
+            if (f->dir_de[id] == 0) continue;
+            if (f->numerado) {
+                snprintf(nome, sizeof(nome), "%s_%05zu.bin", f->prefixo, id);
+            } else {
+                snprintf(nome, sizeof(nome), "%s", f->prefixo);
+            }
+            montar_caminho(caminho, sizeof(caminho), f->dir_de[id] - 1u, nome);
+            if (remove(caminho) != 0 && errno != ENOENT) {
+                fprintf(stderr, "⚠️ Aviso: falha ao apagar temporário “%s”\n", caminho);
+            }
+        }
+        free(f->dir_de);
+    }
+    g_n_familias = 0;
+    pthread_mutex_unlock(&g_trava);
+}